@@ -0,0 +1,25 @@
+import numpy as np
+from pearl.agent import RLAgent
+from pearl.native.export import load_model
+
+
+class NativePolicyAgent(RLAgent):
+    """
+    Policy agent running a network exported with pearl.native.export, without importing torch.
+
+    Inside the lab the model runs on pearl_infer (and the lab calls it directly through
+    native_model_path), outside it falls back to the numpy reference implementation.
+    """
+
+    def __init__(self, native_path: str, observation_space=None, action_space=None):
+        super().__init__(observation_space, action_space)
+        self.native_model_path = native_path
+        self.model = load_model(native_path)
+
+    def predict(self, observation) -> np.ndarray:
+        # same shape contract as TorchPolicyAgent: size 1 dims are dropped
+        return np.asarray(self.model.forward(np.asarray(observation, dtype=np.float32))).squeeze()
+
+    def get_q_net(self):
+        # no torch module to hand out, methods needing gradients won't work with this agent
+        return self.model
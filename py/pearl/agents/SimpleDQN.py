@@ -1,17 +1,37 @@
+from typing import Optional
+
 import torch
 import numpy as np
 from pearl.agent import RLAgent
+from pearl.native.export import ensure_export, load_model
 from stable_baselines3 import DQN
+from stable_baselines3.common.preprocessing import is_image_space
 
 class DQNAgent(RLAgent):
     """
     Simple DQN agent.
+
+    With native_path the SB3 q network (features extractor + head) is exported there and predict
+    runs on the native conv engine. SB3's uint8 image scaling is folded into the export.
     """
-    def __init__(self, model_path: str):
+    def __init__(self, model_path: str, native_path: Optional[str] = None):
         self.m_agent = DQN.load(model_path)
         self.q_net = self.m_agent.q_net
 
+        self.native_model_path = None
+        self.native_model = None
+        if native_path is not None:
+            space = self.m_agent.observation_space
+            scale = 1.0 / 255.0 if getattr(self.m_agent.policy, "normalize_images", False) and is_image_space(space) else 1.0
+            self.native_model_path = ensure_export(self.q_net, native_path, model_path, space.shape,
+                                                   output_activation="softmax", input_scale=scale)
+            if self.native_model_path is not None:
+                self.native_model = load_model(self.native_model_path)
+
     def predict(self, observation):
+        if self.native_model is not None and isinstance(observation, np.ndarray):
+            return self.native_model.forward(observation)
+
         self.q_net.eval()
         with torch.no_grad():
             if isinstance(observation, np.ndarray):
@@ -25,4 +45,4 @@ class DQNAgent(RLAgent):
         return self.q_net
 
     def close(self):
-        del self.m_agent
\ No newline at end of file
+        del self.m_agent
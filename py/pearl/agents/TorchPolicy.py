@@ -1,18 +1,39 @@
+from typing import Optional
+
 import torch
 from pearl.agent import RLAgent
+from pearl.native.export import ensure_export, load_model
 
 class TorchPolicyAgent(RLAgent):
     """
     A generic policy-gradient agent using PyTorch (e.g., REINFORCE).
+
+    If native_path is given the network is exported there (once) and predict runs the native
+    engine instead of torch. The lab picks native_model_path up and skips python entirely.
+    An export that doesn't reproduce the torch policy is dropped with a warning, torch stays.
     """
 
-    def __init__(self, model_path: str, model_module, device):
+    def __init__(self, model_path: str, model_module, device, native_path: Optional[str] = None,
+                 input_dim: Optional[int] = None):
         self.policy_net = model_module.to(device)
         self.policy_net.load_state_dict(torch.load(model_path, map_location=device))
         self.policy_net.eval()
         self.device = device
 
+        self.native_model_path = None
+        self.native_model = None
+        if native_path is not None:
+            if input_dim is None:
+                input_dim = next(m for m in self.policy_net.modules() if isinstance(m, torch.nn.Linear)).in_features
+            self.native_model_path = ensure_export(self.policy_net, native_path, model_path, (input_dim,),
+                                                   output_activation="softmax")
+            if self.native_model_path is not None:
+                self.native_model = load_model(self.native_model_path)
+
     def predict(self, observation):
+        if self.native_model is not None and not isinstance(observation, torch.Tensor):
+            return self.native_model.forward(observation).squeeze()
+
         self.policy_net.eval()
         with torch.no_grad():
             if not isinstance(observation, torch.Tensor):
@@ -28,4 +49,3 @@ class TorchPolicyAgent(RLAgent):
 
     def get_q_net(self):
         return self.policy_net
-        
\ No newline at end of file
@@ -1,20 +1,43 @@
+from typing import Optional, Sequence
+
 import numpy as np
 
 from pearl.agent import RLAgent
+from pearl.native.export import ensure_export, load_model
 import torch
 
 class TorchDQN(RLAgent):
     """
     Simple DQN agent using PyTorch.
+
+    With native_path the q network is exported there and predict runs on the native conv engine
+    (no torch on the hot path). input_shape is what q_net sees for one observation, Nature-CNN
+    frames by default. When the module's forward() permutes (H, W, C) frames and/or divides by 255
+    before q_net, pass input_layout="hwc" and input_scale=1/255 so the export does the same. The
+    export is checked against the whole module, on a mismatch predict stays on torch.
     """
-    def __init__(self, model_path: str, module, device):
+    def __init__(self, model_path: str, module, device, native_path: Optional[str] = None,
+                 input_shape: Sequence[int] = (4, 84, 84), input_scale: float = 1.0, input_layout: str = "chw"):
         self.m_agent = module.to(device)
         self.m_agent.load_state_dict(torch.load(model_path, map_location=device))
         self.m_agent.eval()
         self.q_net = self.m_agent.net
         self.device = device
 
+        self.native_model_path = None
+        self.native_model = None
+        if native_path is not None:
+            self.native_model_path = ensure_export(self.q_net, native_path, model_path, tuple(input_shape),
+                                                   reference=self.m_agent, output_fn=lambda q: q, atol=1e-3,
+                                                   output_activation=None, input_scale=input_scale,
+                                                   input_layout=input_layout)
+            if self.native_model_path is not None:
+                self.native_model = load_model(self.native_model_path)
+
     def predict(self, observation):
+        if self.native_model is not None and not isinstance(observation, torch.Tensor):
+            return np.asarray(self.native_model.forward(observation)).reshape(-1)
+
         self.q_net.eval()
         observation = torch.as_tensor(observation, dtype=torch.float, device=self.device)
         with torch.no_grad():
@@ -23,4 +46,4 @@ class TorchDQN(RLAgent):
             return q_vals.reshape(-1)
 
     def get_q_net(self):
-        return self.q_net
\ No newline at end of file
+        return self.q_net
@@ -1,6 +1,7 @@
 import numpy as np
-from sklearn.linear_model import Ridge
-from typing import Callable
+from typing import Callable, Optional
+
+from pearl import native
 
 
 class CustomExplanation:
@@ -8,24 +9,48 @@ class CustomExplanation:
         self.local_exp = local_exp
 
 
+def _weighted_ridge(x: np.ndarray, y: np.ndarray, weights: np.ndarray, alpha: float) -> tuple[np.ndarray, np.ndarray]:
+    """
+    Closed form of sklearn's Ridge(alpha, fit_intercept=True).fit(x, y, sample_weight=weights)
+    for every column of y at once. Returns coef (outputs, d) and intercept (outputs,).
+    """
+    w = weights / weights.sum()
+    x_mean, y_mean = w @ x, w @ y
+    xc, yc = x - x_mean, y - y_mean
+    gram = (xc * weights[:, None]).T @ xc + alpha * np.eye(x.shape[1])
+    coef = np.linalg.solve(gram, (xc * weights[:, None]).T @ yc).T
+    return coef, y_mean - coef @ x_mean
+
+
 class CustomLimeTabularExplainer:
     def __init__(
         self,
         feature_names: list[str],
-        noise_scale: float = 0.1
+        noise_scale: float = 0.1,
+        alpha: float = 1.0,
+        seed: Optional[int] = None
     ):
         """
         A minimal LIME-like explainer without a background dataset.
         Perturbs each instance with Gaussian noise of given scale.
         :param feature_names: list of feature names (for bookkeeping, not used internally)
         :param noise_scale: relative scale of Gaussian noise for perturbations
+        :param alpha: ridge penalty of the local linear model
+        :param seed: seed of the perturbation streams (random if None)
+
+        Inside the lab perturbation, kernel weights and the ridge fit run in pearl_lime, the
+        model is queried once per explanation.
         """
         self.feature_names = feature_names
         self.noise_scale = noise_scale
+        self.alpha = alpha
+        self.seed = int(np.random.randint(0, 2 ** 31)) if seed is None else seed
+        self.rng = np.random.default_rng(self.seed)
+        self._native = {}
 
     def _generate_perturbations(self, instance: np.ndarray, num_samples: int) -> np.ndarray:
         # Gaussian noise around the instance
-        noise = np.random.normal(0, 1, size=(num_samples, instance.shape[0]))
+        noise = self.rng.normal(0, 1, size=(num_samples, instance.shape[0]))
         perturbed = instance + noise * self.noise_scale
         return perturbed
 
@@ -35,6 +60,40 @@ class CustomLimeTabularExplainer:
         weights = np.exp(-(distances ** 2) / (kernel_width ** 2))
         return weights
 
+    def _native_explainer(self, features: int, num_samples: int):
+        lime_native = native.load("pearl_lime")
+        if lime_native is None:
+            return None
+        key = (features, num_samples)
+        if key not in self._native:
+            self._native[key] = lime_native.TabularExplainer(features, num_samples, self.noise_scale, 0.0,
+                                                            self.alpha, self.seed)
+        return self._native[key]
+
+    def perturb(self, data_row: np.ndarray, num_samples: int = 5000) -> tuple[np.ndarray, np.ndarray]:
+        """
+        Samples (num_samples, d) around data_row from this explainer's next perturbation stream
+        and their kernel weights (num_samples,), what explain_instance feeds predict_fn.
+        """
+        data_row = np.asarray(data_row, dtype=np.float32)
+        explainer = self._native_explainer(data_row.shape[0], num_samples)
+        if explainer is not None:
+            result = explainer.perturb(data_row)
+            return result["samples"], result["weights"]
+        samples = self._generate_perturbations(data_row, num_samples=num_samples)
+        return samples, self._compute_distances(data_row, samples)
+
+    def fit(self, samples: np.ndarray, weights: np.ndarray, preds: np.ndarray, num_features: int = 10,
+            top_labels: int = 1) -> CustomExplanation:
+        """The local model of perturb()'s samples, preds (num_samples, num_classes) from predict_fn."""
+        num_samples, d = samples.shape
+        explainer = self._native_explainer(d, num_samples)
+        if explainer is not None:
+            coef = explainer.fit(samples, weights, preds)["coef"]
+        else:
+            coef, _ = _weighted_ridge(samples, np.asarray(preds).reshape(num_samples, -1), weights, self.alpha)
+        return _explanation(coef, num_features, top_labels)
+
     def explain_instance(
         self,
         data_row: np.ndarray,
@@ -47,21 +106,46 @@ class CustomLimeTabularExplainer:
         data_row: 1D array shape (d,)
         predict_fn: function mapping array (N, d) -> probabilities array (N, num_classes)
         """
-        # Generate perturbations
-        perturbed = self._generate_perturbations(data_row, num_samples=num_samples)
-        preds = predict_fn(perturbed)  # shape (num_samples, num_classes)
-        weights = self._compute_distances(data_row, perturbed)
-
-        explanations: dict[int, list[tuple[int, float]]] = {}
-        num_classes = preds.shape[1]
-
-        # For stability, only fit linear model for labels < top_labels
-        for label in range(min(top_labels, num_classes)):
-            y = preds[:, label]
-            model = Ridge(alpha=1.0, fit_intercept=True)
-            model.fit(perturbed, y, sample_weight=weights)
-            importances = list(enumerate(model.coef_))
-            importances.sort(key=lambda x: abs(x[1]), reverse=True)
-            explanations[label] = importances[:num_features]
-
-        return CustomExplanation(local_exp=explanations)
+        data_row = np.asarray(data_row, dtype=np.float32)
+        explainer = self._native_explainer(data_row.shape[0], num_samples)
+        if explainer is not None:
+            # perturb() and fit() in one native call
+            return _explanation(explainer.explain(data_row, predict_fn)["coef"], num_features, top_labels)
+
+        samples, weights = self.perturb(data_row, num_samples)
+        return self.fit(samples, weights, predict_fn(samples), num_features, top_labels)
+
+
+def _explanation(coef: np.ndarray, num_features: int, top_labels: int) -> CustomExplanation:
+    # For stability, only report labels < top_labels
+    explanations: dict[int, list[tuple[int, float]]] = {}
+    for label in range(min(top_labels, len(coef))):
+        importances = [(i, float(c)) for i, c in enumerate(coef[label])]
+        importances.sort(key=lambda x: abs(x[1]), reverse=True)
+        explanations[label] = importances[:num_features]
+    return CustomExplanation(local_exp=explanations)
+
+
+def explain_instances(
+    explainers: list[CustomLimeTabularExplainer],
+    data_rows: np.ndarray,
+    predict_fn: Callable[[np.ndarray], np.ndarray],
+    num_features: list[int],
+    top_labels: list[int],
+    num_samples: int = 5000
+) -> list[CustomExplanation]:
+    """
+    explain_instance for several (explainer, row) pairs at once (e.g. one per agent) with a single
+    predict_fn call. Every row is perturbed from its own explainer's stream and fitted with its
+    settings, so each result and explainer ends up as explain_instance would leave them.
+    data_rows: array shape (k, d)
+    predict_fn: function mapping array (k, N, d) -> probabilities array (k, N, num_classes)
+    num_features, top_labels: one per row
+    """
+    data_rows = np.asarray(data_rows, dtype=np.float32)
+    perturbed = [explainer.perturb(row, num_samples) for explainer, row in zip(explainers, data_rows)]
+    preds = np.asarray(predict_fn(np.stack([samples for samples, _ in perturbed])))
+    preds = preds.reshape(len(explainers), num_samples, -1)
+    return [explainer.fit(samples, weights, y, features, labels)
+            for explainer, (samples, weights), y, features, labels
+            in zip(explainers, perturbed, preds, num_features, top_labels)]
@@ -3,13 +3,18 @@ from skimage.segmentation import slic
 from sklearn.linear_model import Ridge
 from sklearn.metrics.pairwise import cosine_distances
 from skimage.color import gray2rgb
-from typing import Callable
+from typing import Callable, Optional
+
+from pearl import native
 
 
 class CustomImageExplanation:
-    def __init__(self, local_exp, segments):
+    def __init__(self, local_exp, segments, coef: Optional[np.ndarray] = None, predictions: Optional[np.ndarray] = None):
         self.local_exp = local_exp
         self.segments = segments
+        # full (labels, segments) coefficients and the prediction of the unperturbed input (row 0)
+        self.coef = coef
+        self.predictions = predictions
 
     def get_image_and_mask(self, label, positive_only=True, num_features=5, hide_rest=False):
         mask = np.zeros(self.segments.shape, dtype=bool)
@@ -24,42 +29,79 @@ class CustomImageExplanation:
 
 
 class CustomLimeImageExplainer:
-    def __init__(self, num_samples: int = 1000, num_segments: int = 50):
+    def __init__(self, num_samples: int = 1000, num_segments: int = 50, compactness: float = 10.0,
+                 sigma: float = 1.0, seed: Optional[int] = None, cache_size: int = 8):
+        """
+        :param cache_size: segmentations kept per frame content (native path only)
+
+        Inside the lab segmentation (SLIC), the masked batch and the ridge fits run in pearl_segment,
+        segmentations are cached by frame hash so re-explaining a frame skips SLIC.
+        """
         self.num_samples = num_samples
         self.num_segments = num_segments
+        self.compactness = compactness
+        self.sigma = sigma
+        self.seed = int(np.random.randint(0, 2 ** 31)) if seed is None else seed
+
+        segment = native.load("pearl_segment")
+        self._native = None if segment is None else segment.ImageExplainer(
+            num_samples=num_samples, n_segments=num_segments, compactness=compactness, sigma=sigma,
+            alpha=1.0, seed=self.seed, cache_size=cache_size)
 
     def explain_instance(self, image: np.ndarray, classifier_fn: Callable[[np.ndarray], np.ndarray],
-                         top_labels: int = 1, hide_color=0, num_features: int = 10, num_samples: int = 100):
+                         top_labels: int = 1, hide_color=0, num_features: int = 10, num_samples: int = 100,
+                         observation: Optional[np.ndarray] = None):
+        """
+        :param image: HxWx3 or HxWx1 image that is segmented
+        :param observation: optional planar (..., H, W) input that is perturbed instead of the image,
+            classifier_fn then receives (N, ...) batches in that layout (e.g. a frame stack)
+        """
 
         if image.ndim != 3 or image.shape[2] not in [1, 3]:
             raise ValueError("Input image must be HxWx3 or HxWx1")
 
-        image = gray2rgb(image) if image.shape[2] == 1 else image
-        segments = slic(image, n_segments=self.num_segments, compactness=10, sigma=1)
+        if self._native is not None:
+            if observation is None:
+                target = np.moveaxis(image, 2, 0)
+                predict = lambda batch: classifier_fn(np.moveaxis(batch, 1, 3))
+            else:
+                target, predict = observation, classifier_fn
+
+            result = self._native.explain(image, np.asarray(target, dtype=np.float32), predict, float(hide_color))
+            segments, coef = result["segments"], result["coef"]
+            predictions = result["predictions"]
+        else:
+            segments, coef, predictions = self._explain_python(image, classifier_fn, hide_color, observation)
+
+        local_exp = {}
+        for class_idx in range(min(top_labels, coef.shape[0])):
+            order = np.argsort(-np.abs(coef[class_idx]), kind="stable")[:num_features]
+            local_exp[class_idx] = [(int(s), float(coef[class_idx, s])) for s in order]
+
+        return CustomImageExplanation(local_exp, segments, coef, predictions)
+
+    def _explain_python(self, image, classifier_fn, hide_color, observation):
+        image = gray2rgb(image[:, :, 0]) if image.shape[2] == 1 else image
+        segments = slic(image, n_segments=self.num_segments, compactness=self.compactness, sigma=self.sigma)
+        segments = np.unique(segments, return_inverse=True)[1].reshape(segments.shape)
 
         N = self.num_samples
         K = np.max(segments) + 1
         samples = np.random.randint(0, 2, size=(N, K))
         samples[0, :] = 1  # original image
 
-        perturbed_images = np.zeros((N, *image.shape), dtype=np.float32)
-        for i, sample in enumerate(samples):
-            mask = np.isin(segments, np.where(sample == 1)[0])
-            perturbed = image.copy()
-            perturbed[~mask] = hide_color
-            perturbed_images[i] = perturbed
+        keep = samples[:, segments].astype(bool)  # (N, H, W)
+        if observation is None:
+            perturbed = np.where(keep[..., None], image[None], hide_color).astype(np.float32)
+        else:
+            keep = keep.reshape(N, *([1] * (observation.ndim - 2)), *segments.shape)
+            perturbed = np.where(keep, observation[None], hide_color).astype(np.float32)
 
-        predictions = classifier_fn(perturbed_images)
+        predictions = np.asarray(classifier_fn(perturbed)).reshape(N, -1)
         distances = cosine_distances(samples, samples[:1]).ravel()
         weights = np.exp(-(distances ** 2) / 0.25)
 
-        local_exp = {}
-        for class_idx in range(top_labels):
-            y = predictions[:, class_idx]
-            model = Ridge(alpha=1.0, fit_intercept=True)
-            model.fit(samples, y, sample_weight=weights)
-            explanation = list(enumerate(model.coef_))
-            explanation.sort(key=lambda x: abs(x[1]), reverse=True)
-            local_exp[class_idx] = explanation[:num_features]
-
-        return CustomImageExplanation(local_exp, segments)
+        model = Ridge(alpha=1.0, fit_intercept=True)
+        model.fit(samples, predictions, sample_weight=weights)
+        coef = np.atleast_2d(model.coef_)
+        return segments, coef, predictions
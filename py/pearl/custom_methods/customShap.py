@@ -1,7 +1,44 @@
 import numpy as np
 import torch
-from sklearn.linear_model import Ridge, Lasso
-from typing import Callable
+from math import comb
+from typing import Callable, Optional
+
+from pearl import native
+
+
+def _kernel_coalitions(num_features: int, num_samples: int, rng: np.random.Generator) -> tuple[np.ndarray, np.ndarray]:
+    """
+    Numpy twin of Native::KernelShap::sample(): every coalition with its Shapley kernel weight when
+    they all fit the budget, otherwise paired draws from the kernel size distribution.
+    """
+    m = num_features
+    if m < 31 and 2 ** m - 2 <= num_samples:
+        bits = np.arange(1, 2 ** m - 1)[:, None]
+        masks = ((bits >> np.arange(m)) & 1).astype(np.float64)
+        sizes = masks.sum(axis=1).astype(int)
+        weights = np.array([(m - 1) / (comb(m, s) * s * (m - s)) for s in sizes])
+        return masks, weights
+
+    sizes = np.arange(1, m)
+    p = 1.0 / (sizes * (m - sizes))
+    drawn = rng.choice(sizes, size=(num_samples + 1) // 2, p=p / p.sum())
+    masks = np.zeros((len(drawn), m))
+    for i, s in enumerate(drawn):
+        masks[i, rng.choice(m, size=s, replace=False)] = 1.0
+    masks = np.concatenate([masks, 1.0 - masks])
+    masks, counts = np.unique(masks, axis=0, return_counts=True)
+    return masks, counts.astype(np.float64)
+
+
+def _kernel_solve(masks: np.ndarray, weights: np.ndarray, y: np.ndarray, delta: np.ndarray) -> np.ndarray:
+    """Weighted least squares with sum(phi) = delta, for all actions at once. y is (S, A) minus base."""
+    last = masks[:, -1:]
+    x = masks[:, :-1] - last
+    y = y - last * delta[None, :]
+    gram = (x * weights[:, None]).T @ x
+    gram += 1e-8 * max(np.trace(gram) / max(len(gram), 1), 1.0) * np.eye(len(gram))
+    phi = np.linalg.solve(gram, (x * weights[:, None]).T @ y)  # (M - 1, A)
+    return np.vstack([phi, delta[None, :] - phi.sum(axis=0, keepdims=True)]).T
 
 
 class CustomShapTabularExplainer:
@@ -12,15 +49,22 @@ class CustomShapTabularExplainer:
         num_samples: int = 100,
         use_lasso: bool = False,
         normalize_inputs: bool = False,
-        mask_k: int = None
+        mask_k: int = None,
+        background: Optional[np.ndarray] = None,
+        seed: int = 0
     ):
         """
         :param model: PyTorch model returning Q-values from tabular features, shape (N, d) -> (N, A)
         :param feature_dim: number of features d
-        :param num_samples: number of perturbation samples
-        :param use_lasso: if True, use Lasso for regression; else Ridge
+        :param num_samples: number of coalitions (all 2^d - 2 are used when they fit)
+        :param use_lasso: legacy regression explainer with Lasso instead of KernelSHAP
         :param normalize_inputs: whether to normalize inputs using trivial baseline stats (no real data) — not recommended
-        :param mask_k: if set, use masks with exactly k features on
+        :param mask_k: legacy regression explainer with masks of exactly k features on
+        :param background: (rows, d) reference inputs, zeros by default
+        :param seed: seed of the coalition sampling
+
+        Runs KernelSHAP on pearl_shap inside the lab (numpy otherwise). The model is evaluated once
+        per explanation on the whole batch of coalitions.
         """
         self.model = model.eval()
         self.device = next(model.parameters()).device
@@ -32,7 +76,8 @@ class CustomShapTabularExplainer:
 
         # Trivial "background": zeros
         # If normalize_inputs=True, mean=0, std=1 so normalized input = input itself
-        self.background = torch.zeros((1, feature_dim), dtype=torch.float32, device=self.device)
+        self.background = np.zeros((1, feature_dim), dtype=np.float32) if background is None \
+            else np.asarray(background, dtype=np.float32).reshape(-1, feature_dim)
         if normalize_inputs:
             # No real statistics, so mean=0, std=1: no change effectively
             self.mean = torch.zeros((1, feature_dim), device=self.device)
@@ -41,6 +86,19 @@ class CustomShapTabularExplainer:
             self.mean = None
             self.std = None
 
+        self.rng = np.random.default_rng(seed)
+        shap_native = native.load("pearl_shap")
+        self.native = shap_native.KernelExplainer(feature_dim, num_samples, True, seed) if shap_native else None
+
+        # model outputs at the explained input / expected over the background, from the last call
+        self.last_fx = None
+        self.expected_value = None
+
+    def _evaluate(self, batch: np.ndarray) -> np.ndarray:
+        with torch.no_grad():
+            out = self.model(torch.from_numpy(np.ascontiguousarray(batch, dtype=np.float32)).to(self.device))
+        return out.reshape(len(batch), -1).float().cpu().numpy()
+
     def _sample_masks(self, num_features: int) -> np.ndarray:
         if self.mask_k is not None:
             masks = np.zeros((self.num_samples, num_features), dtype=float)
@@ -51,6 +109,38 @@ class CustomShapTabularExplainer:
             masks = np.random.randint(0, 2, size=(self.num_samples, num_features)).astype(float)
         return masks
 
+    def _regression_values(self, input_np: np.ndarray) -> np.ndarray:
+        """The previous unconstrained Ridge / Lasso fit, kept for use_lasso / mask_k."""
+        from sklearn.linear_model import Ridge, Lasso
+
+        masks = self._sample_masks(self.feature_dim)
+        q_values_batch = self._evaluate(masks * input_np[None, :])
+        shap_vals = np.zeros((self.feature_dim, q_values_batch.shape[1]), dtype=float)
+        for action in range(q_values_batch.shape[1]):
+            reg = Lasso(alpha=0.01) if self.use_lasso else Ridge(alpha=1.0)
+            reg.fit(masks, q_values_batch[:, action])
+            shap_vals[:, action] = reg.coef_
+        self.last_fx = self._evaluate(input_np[None, :])[0]
+        self.expected_value = self._evaluate(self.background).mean(axis=0)
+        return shap_vals.T
+
+    def _kernel_values(self, input_np: np.ndarray) -> np.ndarray:
+        if self.native is not None:
+            result = self.native.explain(input_np.astype(np.float32), self._evaluate, self.background)
+            self.last_fx, self.expected_value = result["fx"], result["base"]
+            return result["phi"]
+
+        masks, weights = _kernel_coalitions(self.feature_dim, self.num_samples, self.rng)
+        bg = self.background
+        rows = masks[:, None, :] * input_np[None, None, :] + (1.0 - masks[:, None, :]) * bg[None, :, :]
+        batch = np.concatenate([input_np[None, :], bg, rows.reshape(-1, self.feature_dim)])
+        out = self._evaluate(batch)
+
+        fx, base = out[0], out[1:1 + len(bg)].mean(axis=0)
+        y = out[1 + len(bg):].reshape(len(masks), len(bg), -1).mean(axis=1) - base[None, :]
+        self.last_fx, self.expected_value = fx, base
+        return _kernel_solve(masks, weights, y, fx - base)
+
     def shap_values(self, input_tensor: torch.Tensor) -> list[np.ndarray]:
         """
         input_tensor: shape (1, d)
@@ -64,31 +154,11 @@ class CustomShapTabularExplainer:
             input_norm = (input_tensor - self.mean) / self.std
             input_np = input_norm.squeeze(0).cpu().numpy()
 
-        num_features = self.feature_dim
-
-        # Backgrounds: zeros
-        background_np = np.zeros((self.num_samples, num_features), dtype=float)
-
-        # Sample masks
-        masks = self._sample_masks(num_features)  # shape (num_samples, d)
-
-        # Create masked inputs: mask * input + (1-mask) * background(=0) = mask * input
-        masked_inputs = masks * input_np[None, :]
-
-        # Evaluate model in batch
-        batch_tensor = torch.tensor(masked_inputs, dtype=torch.float32).to(self.device)
-        with torch.no_grad():
-            q_values_batch = self.model(batch_tensor).cpu().numpy()  # shape (num_samples, A)
-
-        num_actions = q_values_batch.shape[1]
-        shap_vals = np.zeros((num_features, num_actions), dtype=float)
-
-        for action in range(num_actions):
-            y = q_values_batch[:, action]
-            reg = Lasso(alpha=0.01) if self.use_lasso else Ridge(alpha=1.0)
-            reg.fit(masks, y)
-            shap_vals[:, action] = reg.coef_
+        if self.use_lasso or self.mask_k is not None:
+            phi = self._regression_values(input_np)
+        else:
+            phi = self._kernel_values(input_np)
 
         # Return list of arrays, one per action
         # shape choices: here return 1D arrays of length d for each action
-        return [shap_vals[:, a] for a in range(num_actions)]
+        return [np.asarray(phi[a], dtype=float) for a in range(len(phi))]
@@ -16,6 +16,12 @@ class RLEnvironment(Visualizable):
     (e.g., frame stacking, reward processing) in their own
     constructors and not in this abstract base.
     """
+
+    # True if step() spends its time with the GIL released (native emulation / physics) and
+    # instances share no state, so the lab can step several of them at once on worker threads.
+    # Opt in, none of the bundled envs sets it.
+    releases_gil: bool = False
+
     @abstractmethod
     def __init__(self):
         """
@@ -108,6 +114,15 @@ class RLEnvironment(Visualizable):
             "unwrapped() is not implemented for this environment type."
         )
 
+    def worker_spec(self) -> Optional[Tuple[Any, tuple, Dict[str, Any]]]:
+        """
+        (factory, args, kwargs), picklable, that rebuild this environment in another process.
+
+        Used by pearl.serving to run copies of the environment in worker processes, None if
+        the environment can't be rebuilt that way.
+        """
+        return getattr(self, "_worker_spec", None)
+
     def get_available_actions(self) -> List[Any]:
         """
         Get the list of available actions in the current state.
@@ -0,0 +1,181 @@
+from typing import Optional, Tuple, Dict, Any, Union
+
+import numpy as np
+import gymnasium as gym
+from ale_py import ALEInterface, LoggerMode, roms
+
+from pearl.env import RLEnvironment
+from pearl import native
+from pearl.preprocess import area_weights
+from visual import VisualizationMethod
+
+
+class _NumpyAtariCore:
+    """
+    Pure numpy stand-in for pearl_ale.AtariEnvCore, used when running outside the lab.
+    Same preprocessing, just slower.
+    """
+
+    def __init__(self, ale: ALEInterface, frame_skip: int, stack: int, height: int, width: int,
+                 grayscale: bool, max_pool: bool):
+        self.ale = ale
+        self.frame_skip = frame_skip
+        self.stack = stack
+        self.grayscale = grayscale
+        self.max_pool = max_pool
+        self.actions = list(ale.getMinimalActionSet())
+
+        h, w = ale.getScreenDims()
+        self.screens = [np.zeros((h, w, 3), dtype=np.uint8) for _ in range(2)]
+        self.wy = area_weights(h, height)
+        self.wx = area_weights(w, width)
+        shape = (stack, height, width) if grayscale else (stack, height, width, 3)
+        self.frames = np.zeros(shape, dtype=np.uint8)
+
+    def _process(self, pooled: bool) -> np.ndarray:
+        rgb = np.maximum(self.screens[0], self.screens[1]) if pooled and self.max_pool else self.screens[1]
+        if self.grayscale:
+            img = (rgb.astype(np.uint32) @ np.array([4899, 9617, 1868], dtype=np.uint32) + (1 << 13)) >> 14
+            out = self.wy @ img.astype(np.float32) @ self.wx.T
+        else:
+            out = np.einsum("yh,hwc,xw->yxc", self.wy, rgb.astype(np.float32), self.wx)
+        return np.clip(out + 0.5, 0, 255).astype(np.uint8)
+
+    def reset(self):
+        self.ale.reset_game()
+        self.ale.getScreenRGB(self.screens[1])
+        self.frames[:] = self._process(False)
+
+    def step(self, action: int) -> Tuple[float, bool, bool]:
+        reward, terminated, captured = 0.0, False, 0
+        for i in range(self.frame_skip):
+            reward += self.ale.act(self.actions[action])
+            if i >= self.frame_skip - 2:
+                self.ale.getScreenRGB(self.screens[1 if self.frame_skip == 1 else i - (self.frame_skip - 2)])
+                captured += 1
+            if self.ale.game_over():
+                terminated = True
+                break
+        if captured == 0 or (terminated and captured < 2 and self.frame_skip > 1):
+            self.ale.getScreenRGB(self.screens[1])
+            captured = 1
+        truncated = self.ale.game_truncated()
+        if truncated:
+            terminated = False
+        self.frames[:-1] = self.frames[1:]
+        self.frames[-1] = self._process(captured == 2)
+        return reward, terminated, truncated
+
+    def action_count(self) -> int:
+        return len(self.actions)
+
+    def observation(self) -> np.ndarray:
+        return self.frames
+
+    def observation_float(self) -> np.ndarray:
+        return self.frames.astype(np.float32) / 255.0
+
+    def screen(self) -> np.ndarray:
+        return self.screens[1]
+
+
+class AleAtariEnv(RLEnvironment):
+    """
+    Atari environment driving the ALE emulator shipped with ale_py directly, without gym.make,
+    wrappers or a Python frame stack.
+
+    Frame skip, max-pooling, grayscale, area resize and stacking run in C++ (pearl_ale) when
+    inside the lab. Observations are (1, stack, H, W) (channels first, what the DQN agents expect),
+    uint8, or float32 in [0, 1] when normalize_observations is set. Each one is a copy the caller
+    owns, the native buffers are rewritten by the next step.
+    """
+
+    # AtariEnvCore.step calls ALEInterface.act / getScreenRGB through Python with the GIL held,
+    # only the frame pipeline runs without it. Off until emulation goes through ALE's C++
+    # interface and stepping envs on workers measurably beats stepping them in turn
+    releases_gil = False
+
+    def __init__(
+        self,
+        game: str,
+        frame_skip: int = 4,
+        stack_size: int = 4,
+        height: int = 84,
+        width: int = 84,
+        grayscale: bool = True,
+        max_pool: bool = True,
+        normalize_observations: bool = True,
+        repeat_action_probability: float = 0.25,
+        max_episode_steps: Optional[int] = None,
+        seed: Optional[int] = None,
+        reward_clipping: Optional[Tuple[float, float]] = None,
+    ):
+        super().__init__()
+        self._worker_spec = (AleAtariEnv, (), dict(
+            game=game, frame_skip=frame_skip, stack_size=stack_size, height=height, width=width,
+            grayscale=grayscale, max_pool=max_pool, normalize_observations=normalize_observations,
+            repeat_action_probability=repeat_action_probability, max_episode_steps=max_episode_steps,
+            seed=seed, reward_clipping=reward_clipping))
+        self.ale = ALEInterface()
+        ALEInterface.setLoggerMode(LoggerMode.Error)
+        self.ale.setFloat("repeat_action_probability", float(repeat_action_probability))
+        if seed is not None:
+            self.ale.setInt("random_seed", int(seed))
+        if max_episode_steps:
+            # ALE counts emulator frames
+            self.ale.setInt("max_num_frames_per_episode", int(max_episode_steps) * int(frame_skip))
+        self.ale.loadROM(roms.get_rom_path(game.lower()))
+
+        core_args = (self.ale, int(frame_skip), int(stack_size), int(height), int(width), bool(grayscale), bool(max_pool))
+        ale_native = native.load("pearl_ale")
+        self.core = ale_native.AtariEnvCore(*core_args) if ale_native is not None else _NumpyAtariCore(*core_args)
+
+        self.game = game
+        self.stack_size = stack_size
+        self.normalize_observations = normalize_observations
+        self.reward_clipping = reward_clipping
+
+        shape = (1, stack_size, height, width) if grayscale else (1, stack_size, height, width, 3)
+        if normalize_observations:
+            self.observation_space = gym.spaces.Box(low=0.0, high=1.0, shape=shape, dtype=np.float32)
+        else:
+            self.observation_space = gym.spaces.Box(low=0, high=255, shape=shape, dtype=np.uint8)
+        self.action_space = gym.spaces.Discrete(self.core.action_count())
+        self.metadata = {"render_modes": ["rgb_array"]}
+
+    def reset(self, seed: Optional[int] = None, options: Optional[Dict[str, Any]] = None) -> Tuple[np.ndarray, Dict[str, Any]]:
+        if seed is not None:
+            self.ale.setInt("random_seed", int(seed))
+            self.ale.loadROM(roms.get_rom_path(self.game.lower()))
+        self.core.reset()
+        return self.get_observations(), {"lives": self.ale.lives()}
+
+    def step(self, action: Union[int, np.ndarray]) -> Tuple[np.ndarray, Dict[str, np.ndarray], bool, bool, Dict[str, Any]]:
+        reward, terminated, truncated = self.core.step(int(action))
+        if self.reward_clipping:
+            reward = float(np.clip(reward, *self.reward_clipping))
+        reward_out = {"reward": np.array(reward, np.float32)}
+        return self.get_observations(), reward_out, terminated, truncated, {"lives": self.ale.lives()}
+
+    def render(self, mode: str = "human") -> Optional[np.ndarray]:
+        return self.core.screen()
+
+    def get_observations(self) -> np.ndarray:
+        obs = self.core.observation_float() if self.normalize_observations else self.core.observation()
+        # the core hands out views over its own buffers, replay buffers and methods keep what we return
+        return np.array(obs[None], copy=True)
+
+    def supports(self, m: VisualizationMethod) -> bool:
+        if not isinstance(m, VisualizationMethod):
+            m = VisualizationMethod(m)
+        return m == VisualizationMethod.RGB_ARRAY
+
+    def getVisualization(self, m: VisualizationMethod, params: Any = None) -> np.ndarray | dict | None:
+        if not isinstance(m, VisualizationMethod):
+            m = VisualizationMethod(m)
+        if m == VisualizationMethod.RGB_ARRAY:
+            return self.core.screen()  # uint8 (H, W, 3), the preview takes it as is
+        return None
+
+    def getVisualizationParamsType(self, m: VisualizationMethod) -> type | None:
+        return None
@@ -25,9 +25,15 @@ class GymRLEnv(RLEnvironment):
         video_path: Optional[str] = None,
         normalize_observations: bool = False,
         num_envs: int = 1,
-        tabular: bool = False
+        tabular: bool = False,
+        releases_gil: bool = False
     ):
+        init_args = {k: v for k, v in locals().items() if k not in ("self", "__class__")}
         super().__init__()
+        self._worker_spec = (GymRLEnv, (), init_args)
+        # opt in only for a backend whose step really runs with the GIL released. No bundled env
+        # sets it, ALE through ale_py's python bindings holds the GIL while emulating
+        self.releases_gil = releases_gil
         # Create vectorized or single env
         if num_envs > 1:
             if tabular:
@@ -145,8 +151,9 @@ class GymRLEnv(RLEnvironment):
             m = VisualizationMethod(m)
         if m == VisualizationMethod.RGB_ARRAY:
             rgb_image = self.render("rgb_array")
-            if rgb_image.max() > 1.0:
-                rgb_image = rgb_image.astype(np.float32) / 255.0
+            # uint8 goes to the preview untouched, only other 0-255 data needs a cast
+            if rgb_image.dtype != np.uint8 and rgb_image.max() > 1.0:
+                rgb_image = np.clip(rgb_image, 0, 255).astype(np.uint8)
             return rgb_image
         return None
 
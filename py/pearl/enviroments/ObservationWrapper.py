@@ -26,6 +26,10 @@ class ObservationWrapper(RLEnvironment):
     def step(self, action: Any):
         pass
 
+    @property
+    def releases_gil(self) -> bool:
+        return getattr(self.env, "releases_gil", False)
+
     def render(self, mode: str = "human"):  # type: ignore
         return self.env.render(mode=mode)
 
@@ -49,4 +53,7 @@ class ObservationWrapper(RLEnvironment):
         return self.env.getVisualization(m, params)
 
     def getVisualizationParamsType(self, m: VisualizationMethod) -> type | None:
-        return self.env.getVisualizationParamsType(m)
\ No newline at end of file
+        return self.env.getVisualizationParamsType(m)
+
+    def getVisualizationNames(self, m: VisualizationMethod) -> list[str] | None:
+        return self.env.getVisualizationNames(m)
\ No newline at end of file
@@ -0,0 +1,67 @@
+from typing import Optional, Dict, Any
+
+import numpy as np
+import gymnasium as gym
+
+from pearl.enviroments.ObservationWrapper import ObservationWrapper
+from pearl.preprocess import PreprocessChain
+
+
+def _rebuild(inner_spec, spec: str) -> "PreprocessedEnv":
+    factory, args, kwargs = inner_spec
+    return PreprocessedEnv(factory(*args, **kwargs), spec)
+
+
+class PreprocessedEnv(ObservationWrapper):
+    """
+    Runs an env's frames through a preprocessing chain (see pearl.preprocess) once per step.
+    Agents, methods and the preview all get the chain's output, (1, stack, H, W[, C]) or
+    (1, H, W[, C]) without stacking, instead of each redoing grayscale / resize / stacking.
+
+    The wrapped env should return single raw frames (e.g. GymRLEnv with stack_size=1 and no
+    observation_preprocessing). Size 1 axes are dropped and float frames in [0, 1] are
+    brought back to uint8 before the chain. Each observation is a copy the caller owns.
+    Visualizations still come from the wrapped env.
+    """
+
+    def __init__(self, env, spec: str):
+        super().__init__(env)
+        self.spec = spec
+        self.chain = PreprocessChain(spec)
+        self._space_known = False  # the output shape is only known after the first frame
+
+    def _frame(self, obs) -> np.ndarray:
+        frame = np.squeeze(np.asarray(obs))
+        if frame.dtype != np.uint8:
+            if frame.size and frame.max() <= 1.0:
+                frame = frame * 255.0
+            frame = np.clip(frame + 0.5, 0, 255).astype(np.uint8)
+        return frame
+
+    def _observation(self) -> np.ndarray:
+        # the chain hands out a view over its frame ring, later pushes rewrite it in place
+        obs = np.array(self.chain.observation()[None, ...], copy=True)
+        if not self._space_known:
+            self._space_known = True
+            if obs.dtype == np.uint8:
+                self.observation_space = gym.spaces.Box(low=0, high=255, shape=obs.shape, dtype=np.uint8)
+            else:
+                self.observation_space = gym.spaces.Box(low=-np.inf, high=np.inf, shape=obs.shape, dtype=np.float32)
+        return obs
+
+    def reset(self, seed: Optional[int] = None, options: Optional[Dict[str, Any]] = None):
+        obs, info = self.env.reset(seed=seed, options=options)
+        self.chain.reset(self._frame(obs))
+        return self._observation(), info
+
+    def step(self, action: Any):
+        obs, reward, terminated, truncated, info = self.env.step(action)
+        self.chain.push(self._frame(obs))
+        return self._observation(), reward, terminated, truncated, info
+
+    def get_observations(self):
+        return self._observation()
+
+    def worker_spec(self):
+        inner = self.env.worker_spec() if hasattr(self.env, "worker_spec") else None
+        return None if inner is None else (_rebuild, (inner, self.spec), {})
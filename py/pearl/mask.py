@@ -3,6 +3,8 @@ from typing import Any
 
 import numpy as np
 
+from pearl import reduce
+
 
 class Mask(ABC):
     """
@@ -42,4 +44,28 @@ class Mask(ABC):
         Returns:
             mask: tensor of shape [actions]
         """
-        pass
\ No newline at end of file
+        pass
+
+    def reduction_weights(self) -> np.ndarray | None:
+        """
+        Optional: the weights if compute(values) is a plain weighted sum, sum(weights * values)
+        over the observation axes per action. Broadcastable to values, (..., Action).
+        Masks returning them get fused native reductions in compute_attribution().
+        """
+        return None
+
+    def compute_attribution(self, values: np.ndarray, absolute: bool = False, normalize: bool = False) -> np.ndarray:
+        """
+        compute() for a raw attribution (may be an np.broadcast_to view), optionally made absolute
+        and normalized per action over the observation axes first.
+        Avoids materializing the broadcast and its abs / normalized temporaries where possible.
+
+        Returns:
+            mask: tensor of shape [actions]
+        """
+        weights = self.reduction_weights()
+        if weights is not None:
+            return reduce.masked_sum(values, weights, absolute=absolute, normalize=normalize)
+        if absolute or normalize:
+            values = reduce.normalize(values, absolute) if normalize else np.abs(values)
+        return self.compute(values)
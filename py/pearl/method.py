@@ -1,7 +1,7 @@
 from abc import ABC, abstractmethod
 
 import numpy as np
-from typing import Any, Dict
+from typing import Any, Dict, List
 
 from pearl.agent import RLAgent
 from pearl.env import RLEnvironment
@@ -61,3 +61,13 @@ class ExplainabilityMethod(Visualizable):
         """
         pass
 
+    @classmethod
+    def explain_batch(cls, methods: List["ExplainabilityMethod"], observations: List[Any]) -> List[float]:
+        """
+        Optional: value() for every (method instance, observation) pair of one tick.
+        When several agents run the same method, the pipeline calls this once with all of their
+        instances (each prepared with its own agent) instead of value() per agent, so overriding
+        it lets a method fuse perturbation generation and model queries across agents.
+        Must return one value per pair and leave every instance as value() would.
+        """
+        return [method.value(obs) for method, obs in zip(methods, observations)]
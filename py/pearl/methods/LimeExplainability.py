@@ -1,7 +1,6 @@
 from typing import Any
 import numpy as np
 import torch
-from skimage.color import gray2rgb
 from skimage.transform import resize
 from pearl.agent import RLAgent
 from pearl.env import RLEnvironment
@@ -23,7 +22,7 @@ class LimeExplainability(ExplainabilityMethod):
         super().__init__()
         self.device = device
         self.mask = mask
-        self.explainer = CustomLimeImageExplainer(num_samples=500, num_segments=500)
+        self.explainer = CustomLimeImageExplainer(num_samples=500, num_segments=500, cache_size=8)
         self.agent: RLAgent = None
         self.last_explain = None
         self.obs = None
@@ -45,22 +44,25 @@ class LimeExplainability(ExplainabilityMethod):
         frame = obs.squeeze()  # (C, H, W)
         img = np.transpose(frame, (1, 2, 0))
         if img.shape[2] != 3:
-            img = img[:, :, :3] if img.shape[2] > 3 else gray2rgb(img[:, :, 0])
-
-        def batch_predict(images: np.ndarray) -> np.ndarray:
-            gr = np.mean(images, axis=3, keepdims=True).astype(np.float32) / 255.0
-            stacked = np.repeat(gr, frame.shape[0], axis=3)
-            tensor = torch.tensor(np.transpose(stacked, (0, 3, 1, 2)), dtype=torch.float32).to(self.device)
+            img = img[:, :, :3] if img.shape[2] > 3 else img[:, :, :1]
+        if img.max() > 1.0:
+            img = img / 255.0
+
+        # perturbations are built on the observation itself, so the net sees exactly what it
+        # would see from the env (no gray/rgb round trip, no second 1/255 scaling)
+        def batch_predict(batch: np.ndarray) -> np.ndarray:
+            tensor = torch.as_tensor(batch, dtype=torch.float32, device=self.device)
             with torch.no_grad():
                 out = self.agent.get_q_net()(tensor)
             return out.cpu().numpy()
 
         exp = self.explainer.explain_instance(
-            image=img.astype(np.double),
+            image=img.astype(np.float32),
             classifier_fn=batch_predict,
             top_labels=self.mask.action_space,
             hide_color=0,
             num_samples=100,
+            observation=np.asarray(obs, dtype=np.float32).reshape(frame.shape),
         )
 
         self.last_explain = exp
@@ -69,29 +71,27 @@ class LimeExplainability(ExplainabilityMethod):
     def value(self, obs: np.ndarray) -> float:
         exp = self.explain(obs)
         self.mask.update(obs)
-        obs_t = torch.as_tensor(obs, dtype=torch.float32, device=self.device)
-        with torch.no_grad():
-            q = self.agent.get_q_net()(obs_t)
-        action = int(torch.argmax(q))
+        # row 0 of the perturbed batch is the unmodified observation
+        action = int(np.argmax(exp.predictions[0]))
 
         segs = exp.segments
         A = self.mask.action_space
         C, H, W = obs.shape[1:]
 
-        maps = np.zeros((A, H, W), dtype=float)
+        dense = np.zeros((A, int(segs.max()) + 1), dtype=np.float32)
         for lbl, pairs in exp.local_exp.items():
             for seg_id, wt in pairs:
-                maps[lbl, segs == seg_id] = wt
+                dense[lbl, seg_id] = wt
+        maps = dense[:, segs]
 
         if segs.shape != (H, W):
             maps = np.stack([resize(m, (H, W), preserve_range=True, anti_aliasing=True) for m in maps], axis=0)
 
+        # (1, C, H, W, A) view of the maps, abs and normalization happen inside the reduction
         maps_hw_a = np.transpose(maps, (1, 2, 0))
-        attributions = np.broadcast_to(maps_hw_a[None, None, :, :, :], (1, C, H, W, A)).astype(np.float32)
-        attributions = np.abs(attributions)
-        attributions = attributions / np.sum(attributions, axis=(1, 2, 3), keepdims=True)
+        attributions = np.broadcast_to(maps_hw_a[None, None, :, :, :], (1, C, H, W, A))
 
-        return float(self.mask.compute(attributions)[action])
+        return float(self.mask.compute_attribution(attributions, absolute=True, normalize=True)[action])
 
     def supports(self, m: VisualizationMethod) -> bool:
         if not isinstance(m, VisualizationMethod):
@@ -119,10 +119,11 @@ class LimeExplainability(ExplainabilityMethod):
             
 
             segs = self.last_explain.segments
-            heatmap = np.zeros(segs.shape, dtype=np.float32)
+            values = np.zeros(int(segs.max()) + 1, dtype=np.float32)
             for segment, importance in self.last_explain.local_exp[idx]:
-                heatmap[segs == segment] = importance
-                
+                values[segment] = importance
+            heatmap = values[segs]
+
             resized_heatmap = resize(heatmap, (336, 336), preserve_range=True, anti_aliasing=True)
             return resized_heatmap
         return None
\ No newline at end of file
@@ -5,6 +5,7 @@ import numpy as np
 import torch
 import matplotlib.pyplot as plt
 
+from pearl import native
 from pearl.agent import RLAgent
 from pearl.env import RLEnvironment
 from pearl.method import ExplainabilityMethod
@@ -15,7 +16,7 @@ class StabilityVisualizationParams:
     action: Param(int) = 0
 
 class NoiseGenerator:
-    """Handles different types of noise generation for tensors."""
+    """Handles different types of noise generation for tensors (fallback of pearl_noise)."""
 
     @staticmethod
     def add_gaussian_noise(tensor: torch.Tensor, std: float = 0.01) -> torch.Tensor:
@@ -25,38 +26,26 @@ class NoiseGenerator:
 
     @staticmethod
     def add_salt_pepper_noise(tensor: torch.Tensor, amount: float = 0.01) -> torch.Tensor:
-        """Add salt and pepper noise to tensor."""
-        noisy = tensor.clone()
-        has_batch = tensor.dim() == 4
-
-        if has_batch:
-            batch_size = tensor.shape[0]
-            elements_per_item = tensor.numel() // batch_size
-
-            for b in range(batch_size):
-                NoiseGenerator._apply_salt_pepper_to_item(
-                    noisy[b], elements_per_item, amount
-                )
-        else:
-            NoiseGenerator._apply_salt_pepper_to_item(
-                noisy, tensor.numel(), amount
-            )
-
-        return noisy
+        """Set every element to 0 or 1 with probability amount (whole batch at once)."""
+        hit = torch.rand(tensor.shape, device=tensor.device) < amount
+        values = torch.randint(0, 2, tensor.shape, device=tensor.device).to(tensor.dtype)
+        return torch.where(hit, values, tensor)
 
     @staticmethod
-    def _apply_salt_pepper_to_item(tensor: torch.Tensor, total_elements: int, amount: float):
-        """Apply salt and pepper noise to a single tensor item."""
-        num_pixels = int(amount * total_elements)
-        if num_pixels == 0:
-            return
-
-        indices = torch.randperm(total_elements, device=tensor.device)[:num_pixels]
-        flat_tensor = tensor.view(-1)
-
-        # Randomly set to 0 or 1
-        values = torch.randint(0, 2, (num_pixels,), dtype=tensor.dtype, device=tensor.device)
-        flat_tensor[indices] = values
+    def add_occlusion(tensor: torch.Tensor, size: float = 0.1) -> torch.Tensor:
+        """Zero one square of side size * min(H, W) per item, on every channel."""
+        noisy = tensor.clone()
+        items = noisy.view(-1, *noisy.shape[-3:]) if noisy.dim() >= 3 else noisy.view(1, 1, *noisy.shape[-2:])
+        h, w = items.shape[-2:]
+        side = min(h, w, int(round(size * min(h, w))))
+        if side == 0:
+            return noisy
+
+        ys = torch.randint(0, h - side + 1, (items.shape[0],)).tolist()
+        xs = torch.randint(0, w - side + 1, (items.shape[0],)).tolist()
+        for item, y, x in zip(items, ys, xs):
+            item[..., y:y + side, x:x + side] = 0.0
+        return noisy
 
 
 class Visualizer:
@@ -111,7 +100,7 @@ class StabilityExplainability(ExplainabilityMethod):
     Higher consistency scores indicate more robust/stable agents.
     """
 
-    SUPPORTED_NOISE_TYPES = {'gaussian', 'salt_pepper'}
+    SUPPORTED_NOISE_TYPES = {'gaussian', 'salt_pepper', 'occlusion'}
 
     def __init__(self,
                  device: torch.device,
@@ -126,11 +115,15 @@ class StabilityExplainability(ExplainabilityMethod):
 
         Args:
             device: PyTorch device for computations
-            noise_type: Type of noise ('gaussian' or 'salt_pepper')
-            noise_strength: Strength of noise (std for gaussian, amount for salt_pepper)
+            noise_type: Type of noise ('gaussian', 'salt_pepper' or 'occlusion')
+            noise_strength: Strength of noise (std for gaussian, amount for salt_pepper,
+                            square side as a fraction of the frame for occlusion)
             num_samples: Number of noisy samples to test per observation
             visualize: Whether to save visualization of first observation
             save_dir: Directory to save visualizations
+
+        All noisy samples of a step are built as one batch (by pearl_noise inside the lab)
+        and the agent is queried once for the whole batch.
         """
         super().__init__()
 
@@ -153,6 +146,11 @@ class StabilityExplainability(ExplainabilityMethod):
         self.last_reward: Optional[Dict[str, np.ndarray]] = None
         self.reward_weight = reward_weight
 
+        noise = native.load("pearl_noise")
+        self._engine = None if noise is None else noise.NoiseEngine(
+            noise_type, noise_strength, seed=int(np.random.randint(0, 2 ** 31)))
+        self._batch: Optional[np.ndarray] = None
+
     def set(self, env: RLEnvironment) -> None:
         """Set the environment."""
         super().set(env)
@@ -177,26 +175,37 @@ class StabilityExplainability(ExplainabilityMethod):
             return NoiseGenerator.add_gaussian_noise(tensor, self.noise_strength)
         elif self.noise_type == 'salt_pepper':
             return NoiseGenerator.add_salt_pepper_noise(tensor, self.noise_strength)
+        elif self.noise_type == 'occlusion':
+            return NoiseGenerator.add_occlusion(tensor, self.noise_strength)
         else:
             raise ValueError(f"Unsupported noise type: {self.noise_type}")
 
-    def _tensor_to_numpy_uint8(self, tensor: torch.Tensor) -> np.ndarray:
-        """Convert tensor to numpy array in uint8 format for visualization."""
-        return (tensor.squeeze(0).cpu().numpy() * 255).astype(np.uint8)
-
-    def _measure_agent_stability(self, agent: RLAgent, obs_tensor: torch.Tensor) -> int:
-        """Measure how many times an agent gives consistent actions under noise."""
-        base_action = np.argmax(agent.predict(obs_tensor))
-        consistent_count = 0
-
-        for _ in range(self.num_samples):
-            noisy_obs = self._apply_noise(obs_tensor)
-            noisy_action = np.argmax(agent.predict(noisy_obs))
-
-            if noisy_action == base_action:
-                consistent_count += 1
-
-        return consistent_count
+    def _noisy_batch(self, obs: np.ndarray) -> np.ndarray:
+        """num_samples noisy copies of obs stacked as (num_samples, ...), a leading batch dim of 1 is dropped."""
+        item = obs.shape[1:] if obs.ndim > 1 and obs.shape[0] == 1 else obs.shape
+        shape = (self.num_samples, *item)
+
+        if self._engine is not None:
+            # filled in place, the buffer is reused every step
+            if self._batch is None or self._batch.shape != shape:
+                self._batch = np.empty(shape, dtype=np.float32)
+            return self._engine.perturb(obs, self.num_samples, out=self._batch)
+
+        base = torch.as_tensor(obs.reshape(item), dtype=torch.float, device=self.device)
+        with torch.no_grad():
+            batch = self._apply_noise(base.unsqueeze(0).expand(shape).contiguous())
+        return batch.cpu().numpy()
+
+    def _to_uint8(self, array: np.ndarray) -> np.ndarray:
+        """Convert an observation to uint8 for visualization."""
+        return (np.asarray(array).reshape(-1, *array.shape[-2:]) * 255).astype(np.uint8)
+
+    def _measure_agent_stability(self, agent: RLAgent, obs: np.ndarray, batch: np.ndarray) -> int:
+        """Measure how many times an agent gives consistent actions under noise, one query for all samples."""
+        base_action = np.argmax(agent.predict(obs))
+        # agents flatten or squeeze their output differently, the row count is fixed though
+        actions = np.argmax(np.asarray(agent.predict(batch)).reshape(len(batch), -1), axis=1)
+        return int(np.count_nonzero(actions == base_action))
 
     def explain(self, obs: np.ndarray) -> np.ndarray:
         """
@@ -211,21 +220,16 @@ class StabilityExplainability(ExplainabilityMethod):
         if self.agent is None:
             raise RuntimeError("Must call prepare() with agents before explain()")
 
-        obs_tensor = torch.as_tensor(obs, dtype=torch.float, device=self.device)
+        obs = np.ascontiguousarray(obs, dtype=np.float32)
+        batch = self._noisy_batch(obs)
 
         # Visualize first observation if enabled
         if self.visualizer and self._first_observation:
-            with torch.no_grad():
-                noisy_tensor = self._apply_noise(obs_tensor)
-
-                obs_np = self._tensor_to_numpy_uint8(obs_tensor)
-                noisy_np = self._tensor_to_numpy_uint8(noisy_tensor)
-
-                self.visualizer.save_comparison(obs_np, noisy_np, "Original vs Noisy")
-                self._first_observation = False
+            self.visualizer.save_comparison(self._to_uint8(obs), self._to_uint8(batch[0]), "Original vs Noisy")
+            self._first_observation = False
 
         # Measure stability for each agent
-        score = self._measure_agent_stability(self.agent, obs_tensor)
+        score = self._measure_agent_stability(self.agent, obs, batch)
         return score
 
     def value(self, obs) -> float:
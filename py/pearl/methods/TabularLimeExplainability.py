@@ -5,7 +5,7 @@ from pearl.agent import RLAgent
 from pearl.env import RLEnvironment
 from pearl.mask import Mask
 from pearl.method import ExplainabilityMethod
-from pearl.custom_methods.customLime import CustomLimeTabularExplainer
+from pearl.custom_methods.customLime import CustomLimeTabularExplainer, explain_instances
 from visual import VisualizationMethod
 from annotations import Param
 
@@ -34,6 +34,7 @@ class TabularLimeExplainability(ExplainabilityMethod):
             feature_names=self.feature_names,
         )
         self.last_explain = None
+        self.last_q_vals = None
 
     def set(self, env: RLEnvironment):
         super().set(env)
@@ -44,20 +45,26 @@ class TabularLimeExplainability(ExplainabilityMethod):
     def onStep(self, action: Any): pass
     def onStepAfter(self, action: Any, reward: dict, done: bool, info: dict): pass
 
-    def explain(self, obs: np.ndarray) -> Any:
-        if self.agent is None:
-            raise ValueError("Call prepare() before explain().")
-
+    def _obs_vec(self, obs: np.ndarray) -> np.ndarray:
         obs_vec = obs.squeeze()
         if obs_vec.ndim == 2:
             obs_vec = obs_vec[0]
+        return obs_vec
 
-        model = self.agent.get_q_net().to(self.device).eval()
+    def _model(self):
+        return self.agent.get_q_net().to(self.device).eval()
+
+    def explain(self, obs: np.ndarray) -> Any:
+        if self.agent is None:
+            raise ValueError("Call prepare() before explain().")
+
+        obs_vec = self._obs_vec(obs)
+        model = self._model()
 
         # Predict function for LIME: mirror model preprocessing exactly
         def predict_fn(x: np.ndarray) -> np.ndarray:
             with torch.no_grad():
-                x_tensor = torch.tensor(x, dtype=torch.float32).to(self.device)
+                x_tensor = torch.as_tensor(x, dtype=torch.float32, device=self.device)
                 logits = model(x_tensor)
                 probs = torch.softmax(logits, dim=1).cpu().numpy()
             return probs
@@ -65,8 +72,9 @@ class TabularLimeExplainability(ExplainabilityMethod):
         # Get predicted action for focusing LIME
         obs_tensor = torch.tensor(obs_vec.reshape(1, -1), dtype=torch.float32).to(self.device)
         with torch.no_grad():
-            q_vals = model(obs_tensor)
+            q_vals = model(obs_tensor).squeeze(0)
         action = int(torch.argmax(q_vals))
+        self.last_q_vals = q_vals
 
         # Explain only the predicted action for stability
         exp = self.explainer.explain_instance(
@@ -81,12 +89,13 @@ class TabularLimeExplainability(ExplainabilityMethod):
 
     def value(self, obs: np.ndarray) -> float:
         exp = self.explain(obs)
+        return self._score(obs, exp)
+
+    def _score(self, obs: np.ndarray, exp: Any) -> float:
         self.mask.update(obs)
 
-        obs_tensor = torch.tensor(obs, dtype=torch.float32, device=self.device).squeeze()
-        with torch.no_grad():
-            q_vals = self.agent.get_q_net()(obs_tensor)
-            
+        # explain() already ran the model on obs
+        q_vals = self.last_q_vals
         action = int(torch.argmax(q_vals))
 
         # Build weights array for this action
@@ -94,24 +103,85 @@ class TabularLimeExplainability(ExplainabilityMethod):
         for fid, weight in exp.local_exp.get(action, []):
             weights[fid] = weight
 
-        # Attribution tensor shape (1, features, 1,1, action_space)
-        attribution = np.abs(weights).reshape(1, len(self.feature_names), 1, 1, 1)
+        # Attribution tensor shape (1, features, 1,1, action_space), a view:
+        # abs and normalization happen inside the reduction
         attribution = np.broadcast_to(
-            attribution,
+            weights.reshape(1, len(self.feature_names), 1, 1, 1),
             (1, len(self.feature_names), 1, 1, self.mask.action_space)
-        ).astype(np.float32)
-        # Normalize
-        total = np.sum(attribution, axis=1, keepdims=True)
-        if total.any():
-            attribution /= total
+        )
 
-        score = float(self.mask.compute(attribution)[action])
+        score = float(self.mask.compute_attribution(attribution, absolute=True, normalize=True)[action])
         action_q = q_vals[action].item()
         max_q = torch.max(q_vals).item()
         confidence = action_q / max_q if max_q != 0 else 1.0
 
         return score * confidence
 
+    @classmethod
+    def explain_batch(cls, methods: List["TabularLimeExplainability"], observations: List[np.ndarray]) -> List[float]:
+        """
+        All agents of a tick in one go: one forward per distinct network (agents sharing a network
+        on the same device share the forward) and the fits natively. Every instance still perturbs
+        from its own explainer, so results and rng streams are what value() per agent gives.
+        """
+        for method in methods:
+            if method.agent is None:
+                raise ValueError("Call prepare() before explain().")
+
+        vecs = [m._obs_vec(obs).astype(np.float32) for m, obs in zip(methods, observations)]
+        models = [m._model() for m in methods]
+
+        # one predict_fn call per feature count, rows of different lengths don't stack
+        by_features: dict[int, list[int]] = {}
+        for i, vec in enumerate(vecs):
+            by_features.setdefault(vec.shape[0], []).append(i)
+
+        values = [0.0] * len(methods)
+        for members in by_features.values():
+            networks: dict[tuple, list[int]] = {}  # positions in members per (network, device)
+            for j, i in enumerate(members):
+                networks.setdefault((id(models[i]), str(methods[i].device)), []).append(j)
+
+            rows = np.stack([vecs[i] for i in members])
+            q_vals = [None] * len(members)
+            with torch.no_grad():
+                for positions in networks.values():
+                    first = members[positions[0]]
+                    out = models[first](torch.as_tensor(rows[positions], device=methods[first].device))
+                    for k, j in enumerate(positions):
+                        q_vals[j] = out[k]
+
+            def predict_fn(batch: np.ndarray) -> np.ndarray:
+                # batch (agents, samples, features), each agent's rows go through its own network
+                k, n, d = batch.shape
+                probs = None
+                with torch.no_grad():
+                    for positions in networks.values():
+                        first = members[positions[0]]
+                        x = torch.as_tensor(batch[positions].reshape(-1, d), dtype=torch.float32,
+                                            device=methods[first].device)
+                        p = torch.softmax(models[first](x), dim=1).cpu().numpy()
+                        if probs is None:
+                            probs = np.empty((k, n, p.shape[1]), dtype=np.float32)
+                        probs[positions] = p.reshape(len(positions), n, -1)
+                return probs
+
+            group = [methods[i] for i in members]
+            actions = [int(torch.argmax(q)) for q in q_vals]
+            explanations = explain_instances(
+                [m.explainer for m in group],
+                data_rows=rows,
+                predict_fn=predict_fn,
+                num_features=[len(m.feature_names) for m in group],
+                top_labels=[action + 1 for action in actions]
+            )
+
+            for i, exp, q, action in zip(members, explanations, q_vals, actions):
+                methods[i].last_q_vals = q
+                methods[i].last_explain = (exp, action)
+                values[i] = methods[i]._score(observations[i], exp)
+        return values
+
     def supports(self, m: VisualizationMethod) -> bool:
         if not isinstance(m, VisualizationMethod):
             m = VisualizationMethod(m)
@@ -124,18 +194,27 @@ class TabularLimeExplainability(ExplainabilityMethod):
             return TabularLimeVisualizationParams
         return None
 
-    def getVisualization(self, m: VisualizationMethod, params: Any = None) -> dict | None:
+    def getVisualizationNames(self, m: VisualizationMethod) -> list[str] | None:
+        if not isinstance(m, VisualizationMethod):
+            m = VisualizationMethod(m)
+        if m == VisualizationMethod.BAR_CHART:
+            return list(self.feature_names)
+        return None
+
+    def getVisualization(self, m: VisualizationMethod, params: Any = None) -> np.ndarray | None:
         if not isinstance(m, VisualizationMethod):
             m = VisualizationMethod(m)
         if m == VisualizationMethod.BAR_CHART:
-            # Return empty dict if no explanation exists
+            # importance per feature, in feature_names order (zeros if no explanation exists)
+            weights = np.zeros(len(self.feature_names), dtype=np.float32)
             if self.last_explain is None:
-                return {name: 0.0 for name in self.feature_names}
+                return weights
             exp, action = self.last_explain
             idx = 0
             if params is not None and isinstance(params, TabularLimeVisualizationParams):
                 idx = params.action
             idx = max(0, idx) % self.mask.action_space
-            # Return a dict of feature name: importance
-            return {self.feature_names[fid]: weight for fid, weight in exp.local_exp.get(action, [])}
+            for fid, weight in exp.local_exp.get(action, []):
+                weights[fid] = weight
+            return weights
         return None
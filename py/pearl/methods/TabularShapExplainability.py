@@ -35,10 +35,11 @@ class TabularShapExplainability(ExplainabilityMethod):
         self.agent = agent
         model = agent.get_q_net().to(self.device).eval()
         feature_dim = len(self.feature_names)
+        # KernelSHAP enumerates every coalition exactly when they fit (feature_dim <= 11)
         self.explainer = CustomShapTabularExplainer(
             model,
             feature_dim,
-            num_samples=100,
+            num_samples=2048,
             use_lasso=False,
             normalize_inputs=False,
             mask_k=None
@@ -70,25 +71,21 @@ class TabularShapExplainability(ExplainabilityMethod):
         exp = self.explain(obs)
         self.mask.update(obs)
 
-        obs_tensor = torch.tensor(obs, dtype=torch.float32, device=self.device).squeeze()
-        with torch.no_grad():
-            q_vals = self.agent.get_q_net()(obs_tensor)
+        # the explainer already evaluated the model at obs
+        q_vals = torch.as_tensor(self.explainer.last_fx, dtype=torch.float32)
 
         action = int(torch.argmax(q_vals))
         shap_values = exp['shap_values']
         action_shap = shap_values[action]
 
-        weights = np.abs(action_shap).reshape(1, len(self.feature_names), 1, 1, 1)
+        # (1, features, 1, 1, actions) view, abs and normalization happen inside the reduction
+        weights = np.asarray(action_shap).reshape(1, len(self.feature_names), 1, 1, 1)
         attribution = np.broadcast_to(
             weights,
             (1, len(self.feature_names), 1, 1, self.mask.action_space)
-        ).astype(np.float32)
-
-        total = np.sum(attribution, axis=1, keepdims=True)
-        if total.any():
-            attribution /= total
+        )
 
-        score = float(self.mask.compute(attribution)[action])
+        score = float(self.mask.compute_attribution(attribution, absolute=True, normalize=True)[action])
         action_q = q_vals[action].item()
         max_q = torch.max(q_vals).item()
         confidence = action_q / max_q if max_q != 0 else 1.0
@@ -107,17 +104,25 @@ class TabularShapExplainability(ExplainabilityMethod):
             return TabularShapVisualizationParams
         return None
 
-    def getVisualization(self, m: VisualizationMethod, params: Any = None) -> dict | None:
+    def getVisualizationNames(self, m: VisualizationMethod) -> list[str] | None:
+        if not isinstance(m, VisualizationMethod):
+            m = VisualizationMethod(m)
+        if m == VisualizationMethod.BAR_CHART:
+            return list(self.feature_names)
+        return None
+
+    def getVisualization(self, m: VisualizationMethod, params: Any = None) -> np.ndarray | None:
         if not isinstance(m, VisualizationMethod):
             m = VisualizationMethod(m)
         if m == VisualizationMethod.BAR_CHART:
+            # shap value per feature, in feature_names order
             if self.last_explain is None:
-                return {name: 0.0 for name in self.feature_names}
+                return np.zeros(len(self.feature_names), dtype=np.float32)
             idx = 0
             if params is not None and isinstance(params, TabularShapVisualizationParams):
                 idx = params.action
             idx = max(0, idx) % self.mask.action_space
 
             shap_vals = self.last_explain['shap_values'][idx]
-            return {self.feature_names[i]: float(shap_vals[i]) for i in range(len(self.feature_names))}
+            return np.asarray(shap_vals, dtype=np.float32).reshape(-1)[:len(self.feature_names)]
         return None
@@ -0,0 +1,24 @@
+import importlib
+from types import ModuleType
+from typing import Optional
+
+_cache: dict[str, Optional[ModuleType]] = {}
+
+
+def load(name: str) -> Optional[ModuleType]:
+    """
+    Returns one of the lab's embedded native modules (pearl_ale, ...) or None.
+
+    These modules are compiled into the lab executable (PYBIND11_EMBEDDED_MODULE), so they only
+    exist when running inside the lab. Everything using them keeps a pure Python fallback.
+    """
+    if name not in _cache:
+        try:
+            _cache[name] = importlib.import_module(name)
+        except ImportError:
+            _cache[name] = None
+    return _cache[name]
+
+
+def available(name: str) -> bool:
+    return load(name) is not None
@@ -0,0 +1,303 @@
+import os
+import struct
+import warnings
+from typing import Callable, Optional, Sequence
+
+import numpy as np
+
+from pearl.native import load
+
+MAGIC = b"PRLM"
+VERSION = 2
+
+LAYER_LINEAR = 1
+LAYER_CONV2D = 2
+LAYER_FLATTEN = 3
+
+ACTIVATIONS = {"none": 0, "relu": 1, "tanh": 2, "sigmoid": 3, "softmax": 4}
+LAYOUTS = {"chw": 0, "hwc": 1}
+
+
+def _activation_id(name: Optional[str]) -> int:
+    key = "none" if name is None else name.lower()
+    if key not in ACTIVATIONS:
+        raise ValueError(f"Unsupported activation '{name}', expected one of {list(ACTIVATIONS)}")
+    return ACTIVATIONS[key]
+
+
+def _single(value, what: str) -> int:
+    """torch allows per axis conv parameters, the native engine only square ones."""
+    if isinstance(value, (tuple, list)):
+        if len(set(value)) != 1:
+            raise ValueError(f"Non uniform conv {what} {value} is not supported for native export")
+        value = value[0]
+    return int(value)
+
+
+def _collect_layers(model, hidden_activation: Optional[str]) -> list[dict]:
+    """
+    Walks the leaf modules in registration order, fusing every activation module into the
+    Linear / Conv2d before it. Models that apply their activations functionally in forward()
+    (e.g. torch.relu(self.fc1(x))) have no activation modules, for those hidden_activation
+    is applied to every layer but the last.
+    """
+    import torch.nn as nn
+
+    layers, saw_activation = [], False
+    fused = {nn.ReLU: "relu", nn.Tanh: "tanh", nn.Sigmoid: "sigmoid"}
+
+    for module in model.modules():
+        if any(True for _ in module.children()):
+            continue
+        if isinstance(module, nn.Linear):
+            layers.append({
+                "type": LAYER_LINEAR,
+                "weight": module.weight.detach().cpu().numpy().astype(np.float32),
+                "bias": (module.bias.detach().cpu().numpy() if module.bias is not None
+                         else np.zeros(module.out_features)).astype(np.float32),
+                "activation": "none",
+            })
+        elif isinstance(module, nn.Conv2d):
+            if module.groups != 1 or _single(module.dilation, "dilation") != 1 or isinstance(module.padding, str) \
+                    or module.padding_mode != "zeros":
+                raise ValueError("Only plain Conv2d (no groups, dilation or padding modes) can be exported")
+            layers.append({
+                "type": LAYER_CONV2D,
+                "weight": module.weight.detach().cpu().numpy().astype(np.float32),
+                "bias": (module.bias.detach().cpu().numpy() if module.bias is not None
+                         else np.zeros(module.out_channels)).astype(np.float32),
+                "stride": _single(module.stride, "stride"),
+                "pad": _single(module.padding, "padding"),
+                "activation": "none",
+            })
+        elif type(module) in fused:
+            if not layers or layers[-1]["type"] == LAYER_FLATTEN or layers[-1]["activation"] != "none":
+                raise ValueError(f"Cannot fuse {type(module).__name__}, it does not follow a Linear / Conv2d layer")
+            layers[-1]["activation"] = fused[type(module)]
+            saw_activation = True
+        elif isinstance(module, nn.Flatten):
+            layers.append({"type": LAYER_FLATTEN, "activation": "none"})
+        elif isinstance(module, (nn.Identity, nn.Dropout)):
+            continue
+        else:
+            raise ValueError(f"Unsupported module {type(module).__name__} for native export")
+
+    if not any(layer["type"] != LAYER_FLATTEN for layer in layers):
+        raise ValueError("Model has no Linear / Conv2d layers")
+
+    if not saw_activation and not isinstance(model, nn.Sequential):
+        weighted = [layer for layer in layers if layer["type"] != LAYER_FLATTEN]
+        for layer in weighted[:-1]:
+            layer["activation"] = hidden_activation or "none"
+
+    return layers
+
+
+def export_model(model, path: str, input_shape: Sequence[int], output_activation: Optional[str] = "softmax",
+                 hidden_activation: Optional[str] = "relu", input_scale: float = 1.0, input_layout: str = "chw") -> str:
+    """
+    Dumps a Conv2d / Linear + activation network to the flat binary format read by Native::Model
+    (src/backend/native/model.hpp).
+
+    Args:
+        model: torch module, nn.Sequential or a module whose leaves are Conv2d / Linear / Flatten / activations
+        path: output file
+        input_shape: shape of a single observation (no batch dim), (C, H, W) for conv nets
+        output_activation: applied to the last layer ("softmax" matches TorchPolicyAgent.predict)
+        hidden_activation: used for models applying activations functionally, see _collect_layers
+        input_scale: inputs are multiplied by this before the first layer (1 / 255 for raw uint8 frames)
+        input_layout: "hwc" when observations come channels last (env frames) and the model permutes
+            them itself, input_shape stays the network's (C, H, W)
+    """
+    if input_layout not in LAYOUTS:
+        raise ValueError(f"Unsupported input layout '{input_layout}', expected one of {list(LAYOUTS)}")
+    if input_layout == "hwc" and len(input_shape) != 3:
+        raise ValueError("A channels last input needs a (C, H, W) input_shape")
+    layers = _collect_layers(model, hidden_activation)
+
+    with open(path, "wb") as f:
+        f.write(MAGIC)
+        f.write(struct.pack("<III", VERSION, len(layers), len(input_shape)))
+        f.write(struct.pack(f"<{len(input_shape)}I", *input_shape))
+        f.write(struct.pack("<fII", float(input_scale), _activation_id(output_activation), LAYOUTS[input_layout]))
+
+        for layer in layers:
+            if layer["type"] == LAYER_FLATTEN:
+                f.write(struct.pack("<I", LAYER_FLATTEN))
+                continue
+            if layer["type"] == LAYER_CONV2D:
+                out_c, in_c, kh, kw = layer["weight"].shape
+                f.write(struct.pack("<8I", LAYER_CONV2D, in_c, out_c, kh, kw, layer["stride"], layer["pad"],
+                                    _activation_id(layer["activation"])))
+            else:
+                out_dim, in_dim = layer["weight"].shape
+                f.write(struct.pack("<IIII", LAYER_LINEAR, in_dim, out_dim, _activation_id(layer["activation"])))
+            f.write(np.ascontiguousarray(layer["weight"], dtype="<f4").tobytes())
+            f.write(np.ascontiguousarray(layer["bias"], dtype="<f4").tobytes())
+
+    return path
+
+
+def ensure_export(model, path: str, source_path: Optional[str], input_shape: Sequence[int],
+                  reference: Optional[Callable] = None, output_fn: Optional[Callable] = None,
+                  atol: float = 1e-4, **kwargs) -> Optional[str]:
+    """
+    export_model, skipped when path already exists and is newer than the checkpoint it came from.
+    The file is then checked with verify_export against reference, which has to be what predict()
+    runs in torch (model by default) with output_fn mapping its output to the export's.
+
+    Returns None, with a warning, when the export fails or doesn't reproduce the reference (say a
+    guessed hidden_activation was wrong): callers leave native_model_path unset and keep torch.
+    """
+    reference = model if reference is None else reference
+    cached = os.path.exists(path) and (source_path is None or os.path.getmtime(path) >= os.path.getmtime(source_path))
+    if cached:
+        try:
+            verify_export(reference, path, atol=atol, output_fn=output_fn)
+            return path
+        except (AssertionError, ValueError, RuntimeError):
+            pass  # older format or layout, exported again below
+
+    try:
+        export_model(model, path, input_shape, **kwargs)
+        verify_export(reference, path, atol=atol, output_fn=output_fn)
+        return path
+    except (AssertionError, ValueError, RuntimeError) as error:
+        warnings.warn(f"Native export {path} not used, staying on torch: {error}")
+        return None
+
+
+class ReferenceModel:
+    """
+    Numpy implementation of Native::Model, used outside the lab and to check exported files.
+    """
+
+    def __init__(self, path: str):
+        self.path = path
+        with open(path, "rb") as f:
+            data = f.read()
+
+        if data[:4] != MAGIC:
+            raise ValueError(f"{path} is not a pearl model file")
+        version, count, rank = struct.unpack_from("<III", data, 4)
+        if version not in (1, VERSION):
+            raise ValueError(f"Unsupported model version {version}")
+        offset = 16
+        self.network_shape = tuple(struct.unpack_from(f"<{rank}I", data, offset))
+        offset += 4 * rank
+        self.input_scale, self.output_activation = struct.unpack_from("<fI", data, offset)
+        offset += 8
+        self.channels_last = False
+        if version >= 2:
+            (layout,) = struct.unpack_from("<I", data, offset)
+            offset += 4
+            self.channels_last = layout == LAYOUTS["hwc"]
+        # one observation as callers pass it
+        c = self.network_shape
+        self.input_shape = (c[1], c[2], c[0]) if self.channels_last else c
+
+        self.layers = []
+        shape = self.network_shape
+        for _ in range(count):
+            (kind,) = struct.unpack_from("<I", data, offset)
+            offset += 4
+            if kind == LAYER_FLATTEN:
+                shape = (int(np.prod(shape)),)
+                self.layers.append((kind, None, None, 0, {}))
+                continue
+            if kind == LAYER_CONV2D:
+                in_c, out_c, kh, kw, stride, pad, act = struct.unpack_from("<7I", data, offset)
+                offset += 28
+                w_shape, conv = (out_c, in_c, kh, kw), {"stride": stride, "pad": pad}
+                shape = (out_c, (shape[1] + 2 * pad - kh) // stride + 1, (shape[2] + 2 * pad - kw) // stride + 1)
+            elif kind == LAYER_LINEAR:
+                in_dim, out_dim, act = struct.unpack_from("<III", data, offset)
+                offset += 12
+                w_shape, conv = (out_dim, in_dim), {}
+                shape = (out_dim,)
+            else:
+                raise ValueError(f"Unknown layer type {kind}")
+            w = np.frombuffer(data, "<f4", int(np.prod(w_shape)), offset).reshape(w_shape)
+            offset += 4 * w.size
+            b = np.frombuffer(data, "<f4", w_shape[0], offset)
+            offset += 4 * b.size
+            self.layers.append((kind, w, b, act, conv))
+
+        self.input_size = int(np.prod(self.input_shape))
+        self.output_size = int(np.prod(shape))
+
+    @staticmethod
+    def _conv(x: np.ndarray, w: np.ndarray, b: np.ndarray, stride: int, pad: int) -> np.ndarray:
+        if pad:
+            x = np.pad(x, ((0, 0), (0, 0), (pad, pad), (pad, pad)))
+        kh, kw = w.shape[2:]
+        windows = np.lib.stride_tricks.sliding_window_view(x, (kh, kw), axis=(2, 3))[:, :, ::stride, ::stride]
+        return np.einsum("bchwij,ocij->bohw", windows, w, optimize=True) + b[None, :, None, None]
+
+    @staticmethod
+    def _apply(x: np.ndarray, act: int) -> np.ndarray:
+        if act == ACTIVATIONS["relu"]:
+            return np.maximum(x, 0)
+        if act == ACTIVATIONS["tanh"]:
+            return np.tanh(x)
+        if act == ACTIVATIONS["sigmoid"]:
+            return 1.0 / (1.0 + np.exp(-x))
+        if act == ACTIVATIONS["softmax"]:
+            e = np.exp(x - x.max(axis=-1, keepdims=True))
+            return e / e.sum(axis=-1, keepdims=True)
+        return x
+
+    def forward(self, x: np.ndarray) -> np.ndarray:
+        x = np.asarray(x, dtype=np.float32)
+        batched = x.ndim > len(self.input_shape)
+        x = x.reshape(-1, *self.input_shape) * np.float32(self.input_scale)
+        if self.channels_last:
+            x = x.transpose(0, 3, 1, 2)
+        for kind, w, b, act, conv in self.layers:
+            if kind == LAYER_FLATTEN:
+                x = x.reshape(x.shape[0], -1)
+            elif kind == LAYER_CONV2D:
+                x = self._apply(self._conv(x, w, b, conv["stride"], conv["pad"]), act)
+            else:
+                x = self._apply(x.reshape(x.shape[0], -1) @ w.T + b, act)
+        x = self._apply(x.reshape(x.shape[0], -1), self.output_activation).astype(np.float32)
+        return x if batched else x[0]
+
+    __call__ = forward
+
+
+def load_model(path: str):
+    """Native model when running inside the lab (pearl_infer), numpy reference otherwise."""
+    infer = load("pearl_infer")
+    return infer.NativeModel(path) if infer is not None else ReferenceModel(path)
+
+
+def verify_export(model, path: str, samples: int = 64, atol: float = 1e-4,
+                  output_fn: Optional[Callable] = None, seed: int = 0) -> float:
+    """
+    Runs random observations through the torch model and the exported file and returns the
+    max abs difference. Raises if it is above atol.
+
+    output_fn maps the torch output to what the export should produce, softmax by default.
+    Observations are drawn in [0, 1 / input_scale) so conv nets fed raw frames get realistic inputs.
+    """
+    import torch
+
+    exported = load_model(path)
+    shape = tuple(exported.input_shape)
+    rng = np.random.default_rng(seed)
+    if len(shape) == 3:
+        x = (rng.random((samples, *shape)) / exported.input_scale).astype(np.float32)
+    else:
+        x = rng.standard_normal((samples, *shape)).astype(np.float32)
+
+    with torch.no_grad():
+        ref = model(torch.from_numpy(x).to(next(model.parameters()).device))
+        ref = output_fn(ref) if output_fn is not None else torch.softmax(ref, dim=-1)
+        ref = ref.cpu().numpy().reshape(samples, -1)
+
+    got = np.asarray(exported.forward(x)).reshape(samples, -1)
+    err = float(np.abs(got - ref).max())
+    if err > atol:
+        raise AssertionError(f"Exported model {path} differs from torch by {err:.3g} (atol {atol})")
+    return err
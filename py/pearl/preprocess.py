@@ -0,0 +1,152 @@
+"""
+Per step observation preprocessing from a spec string, e.g.
+
+    "maxpool,gray,crop=34:0:160:160,resize=84x84,normalize,stack=4"
+
+Geometric ops (maxpool, gray, crop=top:left:height:width, resize=HxW) run in the given order on
+uint8 frames, normalize[=mean:std] and stack=N come last. Inside the lab the chain is
+pearl_preprocess.PreprocessChain, one native pass per op over preallocated buffers, and
+observation() is a view over the native frame stack.
+"""
+
+from typing import List, Tuple
+
+import numpy as np
+
+from pearl import native
+
+
+def area_weights(src: int, dst: int) -> np.ndarray:
+    """(dst, src) box filter matrix, same taps as the native AreaResizer."""
+    scale = src / dst
+    w = np.zeros((dst, src), dtype=np.float32)
+    for i in range(dst):
+        begin, end = i * scale, min((i + 1) * scale, src)
+        for j in range(int(np.floor(begin)), int(np.ceil(end))):
+            overlap = min(end, j + 1) - max(begin, j)
+            if overlap > 1e-9:
+                w[i, min(j, src - 1)] = overlap / (end - begin)
+    return w
+
+
+def parse_spec(spec: str) -> Tuple[List[Tuple[str, Tuple[int, ...]]], bool, float, float, int]:
+    """-> (ops, normalize, mean, std, stack), same rules and errors as the native parser."""
+    ops, normalize, mean, std, stack = [], False, 0.0, 1.0, 1
+    terminal = False
+
+    def numbers(token: str, value: str, count: int) -> List[float]:
+        try:
+            out = [float(v) for v in value.split("x" if "x" in value else ":")] if value else []
+        except ValueError:
+            raise ValueError(f"preprocess: bad number in '{token}'")
+        if len(out) != count:
+            raise ValueError(f"preprocess: '{token}' expects {count} values")
+        return out
+
+    def positive(token: str, v: float) -> int:
+        if v <= 0 or v != int(v):
+            raise ValueError(f"preprocess: '{token}' needs positive integers")
+        return int(v)
+
+    for token in (t.strip() for t in spec.split(",")):
+        if not token:
+            continue
+        name, _, value = token.partition("=")
+
+        if name == "normalize":
+            normalize, terminal = True, True
+            if value:
+                mean, std = numbers(token, value, 2)
+                if std == 0:
+                    raise ValueError("preprocess: normalize std can not be 0")
+            continue
+        if name == "stack":
+            stack, terminal = positive(token, numbers(token, value, 1)[0]), True
+            continue
+        if terminal:
+            raise ValueError(f"preprocess: '{token}' must come before normalize / stack")
+
+        if name == "maxpool":
+            ops.append(("maxpool", ()))
+        elif name in ("gray", "grayscale"):
+            ops.append(("gray", ()))
+        elif name == "crop":
+            top, left, h, w = numbers(token, value, 4)
+            if top < 0 or left < 0:
+                raise ValueError("preprocess: crop offsets can not be negative")
+            ops.append(("crop", (int(top), int(left), positive(token, h), positive(token, w))))
+        elif name == "resize":
+            h, w = numbers(token, value, 2)
+            ops.append(("resize", (positive(token, h), positive(token, w))))
+        else:
+            raise ValueError(f"preprocess: unknown op '{name}'")
+    return ops, normalize, mean, std, stack
+
+
+class _NumpyPreprocessChain:
+    """
+    Pure numpy stand-in for pearl_preprocess.PreprocessChain, used when running outside the lab.
+    """
+
+    def __init__(self, spec: str):
+        self.ops, self.normalize, self.mean, self.std, self.stack = parse_spec(spec)
+        self.previous = {}
+        self.weights = {}
+        self.frames = None
+
+    def _run(self, frame: np.ndarray, first: bool) -> np.ndarray:
+        x = frame if frame.ndim == 3 else frame[..., None]
+        for i, (name, args) in enumerate(self.ops):
+            if name == "maxpool":
+                pooled = x if first or i not in self.previous else np.maximum(x, self.previous[i])
+                self.previous[i] = x.copy()
+                x = pooled
+            elif name == "gray":
+                if x.shape[-1] not in (1, 3, 4):
+                    raise ValueError(f"preprocess: gray needs 1, 3 or 4 channels, got {x.shape[-1]}")
+                if x.shape[-1] > 1:
+                    luma = x[..., :3].astype(np.uint32) @ np.array([4899, 9617, 1868], dtype=np.uint32)
+                    x = ((luma + (1 << 13)) >> 14).astype(np.uint8)[..., None]
+            elif name == "crop":
+                top, left, h, w = args
+                if top + h > x.shape[0] or left + w > x.shape[1]:
+                    raise ValueError(f"preprocess: crop {h}x{w} at {top}:{left} outside of a "
+                                     f"{x.shape[0]}x{x.shape[1]} frame")
+                x = x[top:top + h, left:left + w]
+            elif name == "resize":
+                h, w = args
+                key = (x.shape[0], x.shape[1], h, w)
+                if key not in self.weights:
+                    self.weights[key] = (area_weights(x.shape[0], h), area_weights(x.shape[1], w))
+                wy, wx = self.weights[key]
+                out = np.einsum("yh,hwc,xw->yxc", wy, x.astype(np.float32), wx)
+                x = np.clip(out + 0.5, 0, 255).astype(np.uint8)
+
+        if x.shape[-1] == 1:
+            x = x[..., 0]
+        if self.normalize:
+            return (x.astype(np.float32) / 255.0 - self.mean) / self.std
+        return np.ascontiguousarray(x)
+
+    def reset(self, frame: np.ndarray):
+        self.previous.clear()
+        self.frames = np.repeat(self._run(frame, True)[None], self.stack, axis=0)
+
+    def push(self, frame: np.ndarray):
+        if self.frames is None:
+            return self.reset(frame)
+        # a new array every step, observations handed out earlier stay as they were
+        self.frames = np.concatenate([self.frames[1:], self._run(frame, False)[None]])
+
+    def observation(self) -> np.ndarray:
+        if self.frames is None:
+            raise RuntimeError("PreprocessChain: reset() before observation()")
+        return self.frames if self.stack > 1 else self.frames[0]
+
+
+def PreprocessChain(spec: str):
+    """Native chain inside the lab, numpy otherwise. Both take uint8 (H, W) / (H, W, C) frames."""
+    module = native.load("pearl_preprocess")
+    if module is not None:
+        return module.PreprocessChain(spec)
+    return _NumpyPreprocessChain(spec)
@@ -2,6 +2,7 @@ from typing import Any
 
 import numpy as np
 
+from pearl import reduce
 from pearl.mask import Mask
 
 def split_vertical_lines(img: np.ndarray):
@@ -163,6 +164,7 @@ class AssaultEnvShapMask(Mask):
         self.ui_lives = []
         self.bullets = []
         self.ui_cannon = []
+        self.masks = None
 
     def update(self, frame: np.ndarray):
         self.moth = []
@@ -185,73 +187,41 @@ class AssaultEnvShapMask(Mask):
             self.ui_all.append(ui_all)
             self.ui_lives.append(ui_lives)
 
-    def _noop_score(self, x, y, img, moth, bullets, enemies, player, ui_all, ui_lives, ui_canon):
-        """
-        When the agent is taking a noop, the noop should be affected positively by the location of
-        enemies, player, and bullets
-        """
-        mask = np.zeros_like(img)
-        mask += enemies
-        mask += player
-        mask += moth
-        mask = mask
-        return np.sum(mask * img) / (np.sum(np.maximum(mask, img)) + 1) # +1 to prevent errors
-
-    def _fire_score(self, x, y, img, moth, bullets, enemies, player, ui_all, ui_lives, ui_canon):
+        # (N, H, W, 7), only depends on the frame so it is built once per update
+        self.masks = np.stack([self._action_masks(i) for i in range(N)])
+
+    def _action_masks(self, i: int) -> np.ndarray:
         """
-        Agent decision to fire should be affectedly positivly by the location of enemies above the player
+        Region masks (H, W, 7) of frame i, one per action. compute() scores each action by the
+        soft overlap sum(mask * attribution) / (sum(max(mask, attribution)) + 1).
         """
-        h, w = img.shape
-        mask = np.zeros_like(img)
-        _start = int(max(0, x - 10))
-        _end   = int(min(w, x + 10))
-        mask[:, _start:_end] = enemies[:, _start:_end] + moth[:, _start:_end]
-        mask = mask
-        return np.sum(mask * img) / (np.sum(np.maximum(mask, img)) + 1)
+        moth = self.moth[i].astype(np.float32)
+        enemies = self.enemies[i].astype(np.float32)
+        bullets = self.bullets[i].astype(np.float32)
+        player = self.player[i].astype(np.float32)
+        h, w = moth.shape
+        x, y = weighted_centroid(self.player[i])
 
+        masks = np.zeros((h, w, 7), dtype=np.float32)
 
-    def _right_score(self, x, y, img, moth, bullets, enemies, player, ui_all, ui_lives, ui_canon):
-        """
-        Agent decision to move right, should try to follow enemies, but avoid bullets
-        """
-        h, w = img.shape
-        mask = np.zeros_like(img)
-        x = int(x)
-        mask[:, x:w] += enemies[:, x:w] + moth[:, x:w] - bullets[:, x:w]
-        mask[:, 0:x] -= enemies[:, 0:x] + moth[:, 0:x] - bullets[:, 0:x]
-        mask = mask
-        return np.sum(mask * img) / (np.sum(np.maximum(mask, img)) + 1)
+        # noop: should be affected positively by the location of enemies, player, and bullets
+        masks[:, :, 0] = enemies + player + moth
 
-    def _left_score(self, x, y, img, moth, bullets, enemies, player, ui_all, ui_lives, ui_canon):
-        """
-        Agent decision to move right, should try to follow enemies, but avoid bullets
-        """
-        h, w = img.shape
-        mask = np.zeros_like(img)
-        x = int(x)
-        mask[:, x:w] -= enemies[:, x:w] + moth[:, x:w] - bullets[:, x:w]
-        mask[:, 0:x] += enemies[:, 0:x] + moth[:, 0:x] - bullets[:, 0:x]
-        mask = mask
-        return np.sum(mask * img) / (np.sum(np.maximum(mask, img)) + 1)
+        # fire: should be affected positively by the location of enemies above the player
+        _start = int(max(0, x - 10))
+        _end   = int(min(w, x + 10))
+        masks[:, _start:_end, 1] = enemies[:, _start:_end] + moth[:, _start:_end]
 
+        # right: should try to follow enemies, but avoid bullets (left is the mirror image)
+        x = int(x)
+        follow = enemies + moth - bullets
+        masks[:, x:w, 3] = follow[:, x:w]
+        masks[:, 0:x, 3] = -follow[:, 0:x]
+        masks[:, :, 4] = -masks[:, :, 3]
 
+        # up, fire-left, fire-right: unhandled
+        return masks
 
     def compute(self, values: Any) -> np.ndarray:
-        N = values.shape[1]
-        result = np.zeros(7)
-        for i in range(N):
-            img = values[0, i, :, :]
-            x, y = weighted_centroid(self.player[i])
-            result[0] += self._noop_score(x, y, img[:,:, 0], self.moth[i], self.bullets[i], self.enemies[i], self.player[i], self.ui_all[i], self.ui_lives[i], self.ui_cannon[i])
-            result[1] += self._fire_score(x, y, img[:,:, 1], self.moth[i], self.bullets[i], self.enemies[i], self.player[i],
-                                      self.ui_all[i], self.ui_lives[i], self.ui_cannon[i])
-            result[2] += 0 # up / unhandled
-            result[3] += self._right_score(x, y, img[:,:, 3], self.moth[i], self.bullets[i], self.enemies[i], self.player[i],
-                                    self.ui_all[i], self.ui_lives[i], self.ui_cannon[i])
-            result[4] += self._left_score(x, y, img[:,:, 4], self.moth[i], self.bullets[i], self.enemies[i], self.player[i],
-                                    self.ui_all[i], self.ui_lives[i], self.ui_cannon[i])
-
-            result[5] += 0 # fire-left / unhandled
-            result[6] += 0 # fire-right / unhandled
-
-        return result
\ No newline at end of file
+        # values (1, N, H, W, 7), one overlap score per frame and action, summed over the frames
+        return reduce.overlap(values, self.masks, group_axis=1).sum(axis=0)
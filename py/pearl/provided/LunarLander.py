@@ -1,4 +1,5 @@
 import numpy as np
+from pearl import reduce
 from pearl.mask import Mask
 
 class LunarLanderTabularMask(Mask):
@@ -35,26 +36,25 @@ class LunarLanderTabularMask(Mask):
         # obs shape: (1,8)
         self.last_obs = obs.reshape(-1)
 
-    def compute(self, attr: np.ndarray) -> np.ndarray:
-        # attr: (1, features, 1, 1, actions)
-        _, C, _, _, A = attr.shape
+    def reduction_weights(self) -> np.ndarray:
+        # (1, features, 1, 1, actions) to match the attribution layout
         if self.last_obs is None:
             # fallback to static weighting if no state
-            return np.sum(self.weights * np.sum(attr, axis=(0,2,3)), axis=0)
+            return self.weights[None, :, None, None, :]
 
         # normalize obs
         scaled = np.abs(self.last_obs) / self._feature_scales
         # clip to [0,1] 
         scaled = np.clip(scaled, 0.0, 1.0)
 
-        scores = np.zeros(A, dtype=np.float32)
         # dynamic weight = static weight * scaled state magnitude
-        for a in range(A):
-            for c in range(C):
-                feature_attr = attr[0, c, 0, 0, a]
-                dyn_w = self.weights[c, a] * (1.0 + scaled[c])  # amplify weight by state
-                scores[a] += dyn_w * feature_attr
-                
+        dyn_w = self.weights * (1.0 + scaled[:, None])  # amplify weight by state
+        return dyn_w[None, :, None, None, :]
+
+    def compute(self, attr: np.ndarray) -> np.ndarray:
+        # attr: (1, features, 1, 1, actions)
+        scores = reduce.masked_sum(attr, self.reduction_weights()).astype(np.float32)
+
         # normalize scores to [0, 1]
         # scores = np.clip(scores, 0.0, None)
         # scores /= np.sum(scores) if np.sum(scores) > 0 else 1.0
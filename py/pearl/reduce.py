@@ -0,0 +1,70 @@
+"""
+Attribution reductions used by masks: per action weighted sums over the observation axes.
+
+values are (..., A) with the action axis last, weights / masks broadcast to values with numpy
+rules (use a size 1 action axis to share them across actions). Inside the lab these run in
+pearl_reduce directly on strided views, so np.broadcast_to results and transposes are never
+materialized and abs / normalization are fused into the same pass.
+"""
+
+from typing import Optional
+
+import numpy as np
+
+from pearl import native
+
+
+def _axes(ndim: int, group_axis: Optional[int]) -> tuple[int, ...]:
+    group = None if group_axis is None else group_axis % ndim
+    return tuple(d for d in range(ndim - 1) if d != group)
+
+
+def _prepared(values: np.ndarray, absolute: bool, normalize: bool) -> np.ndarray:
+    v = np.abs(values) if absolute else np.asarray(values)
+    if normalize:
+        total = np.sum(v, axis=tuple(range(v.ndim - 1)))
+        v = v / np.where(total != 0, total, 1)
+    return v
+
+
+def masked_sum(values: np.ndarray, weights: Optional[np.ndarray] = None, absolute: bool = False,
+               normalize: bool = False, group_axis: Optional[int] = None) -> np.ndarray:
+    """
+    sum(weights * values) over every non action axis -> (A,), or (groups, A) with group_axis.
+    normalize divides values by their per action total first (skipped where the total is 0).
+    """
+    reduce = native.load("pearl_reduce")
+    if reduce is not None:
+        return reduce.masked_sum(values, weights, absolute, normalize, group_axis)
+
+    v = _prepared(values, absolute, normalize)
+    product = v if weights is None else v * weights
+    result = np.sum(product, axis=_axes(v.ndim, group_axis))
+    return result if group_axis is not None else result.reshape(-1)
+
+
+def overlap(values: np.ndarray, masks: np.ndarray, absolute: bool = False, normalize: bool = False,
+            group_axis: Optional[int] = None) -> np.ndarray:
+    """
+    Soft overlap of region masks and the attribution: sum(m * v) / (sum(max(m, v)) + 1)
+    over every non action axis -> (A,), or (groups, A) with group_axis.
+    """
+    reduce = native.load("pearl_reduce")
+    if reduce is not None:
+        return reduce.overlap(values, masks, absolute, normalize, group_axis)
+
+    v = _prepared(values, absolute, normalize)
+    axes = _axes(v.ndim, group_axis)
+    result = np.sum(masks * v, axis=axes) / (np.sum(np.maximum(masks, v), axis=axes) + 1)
+    return result if group_axis is not None else result.reshape(-1)
+
+
+def normalize(values: np.ndarray, absolute: bool = False) -> np.ndarray:
+    """
+    float32 copy of values (|values| if absolute) divided by its per action total,
+    for masks whose compute() is not a plain reduction.
+    """
+    reduce = native.load("pearl_reduce")
+    if reduce is not None:
+        return reduce.normalize(values, absolute)
+    return _prepared(values, absolute, True).astype(np.float32)
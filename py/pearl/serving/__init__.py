@@ -0,0 +1,115 @@
+"""
+Env worker processes for the lab's inference server (src/backend/inference_server.cpp).
+
+The lab keeps the agent, every worker only builds envs from env.worker_spec() and exchanges
+observations / actions with the server through a shared memory slot region, one slot per env.
+"""
+
+import os
+import pickle
+import shutil
+import subprocess
+import sys
+import tempfile
+from typing import Any, Callable, Dict, Optional, Tuple
+
+import numpy as np
+
+# slot states, Native::SlotState
+IDLE, REQUEST, RESPONSE, CLOSED = 0, 1, 2, 3
+
+REGION_HEADER = 64
+SLOT_HEADER = 64
+
+
+def build_env(spec: Tuple[Callable, tuple, Dict[str, Any]]):
+    factory, args, kwargs = spec
+    return factory(*args, **kwargs)
+
+
+class SlotRegion:
+    """
+    numpy views over the layout of Native::SlotRegion (see inference_slots.hpp).
+    Workers store the observation first and the state last, x86 keeps that order.
+    """
+
+    def __init__(self, name: str):
+        from multiprocessing import shared_memory
+        try:
+            self.shm = shared_memory.SharedMemory(name=name, track=False)
+        except TypeError:
+            # before 3.13 the resource tracker would unlink the server's segment when we exit
+            from multiprocessing import resource_tracker
+            self.shm = shared_memory.SharedMemory(name=name)
+            resource_tracker.unregister(self.shm._name, "shared_memory")
+
+        buf = self.shm.buf
+        if bytes(buf[:4]) != b"PRLS":
+            raise RuntimeError(f"{name} is not a pearl slot region")
+        self.header = np.ndarray((7,), dtype=np.uint32, buffer=buf)
+        self.slots, self.obs_size, stride, offset = (int(v) for v in self.header[2:6])
+
+        self.state, self.action, self.counters, self.times, self.last_return, self.obs = [], [], [], [], [], []
+        for i in range(self.slots):
+            base = offset + i * stride
+            u32 = np.ndarray((4,), dtype=np.uint32, buffer=buf, offset=base)
+            self.state.append(u32[0:1])
+            self.action.append(u32[2:3].view(np.int32))
+            self.counters.append(u32)  # seq at 1, episodes at 3
+            self.times.append(np.ndarray((2,), dtype=np.uint64, buffer=buf, offset=base + 16))  # sent_ns, steps
+            self.last_return.append(np.ndarray((1,), dtype=np.float32, buffer=buf, offset=base + 32))
+            self.obs.append(np.ndarray((self.obs_size,), dtype=np.float32, buffer=buf, offset=base + SLOT_HEADER))
+
+    @property
+    def shutdown(self) -> bool:
+        return bool(self.header[6])
+
+    def close(self):
+        # the views pin the buffer, they have to go before the mapping
+        self.header = None
+        self.state = self.action = self.counters = self.times = self.last_return = self.obs = []
+        self.shm.close()
+
+
+def _python() -> str:
+    return os.environ.get("PEARL_PYTHON") or shutil.which("python3") or sys.executable
+
+
+def launch_workers(env, shm_name: str, workers: int, envs_per_worker: int) -> Dict[str, Any]:
+    """Starts workers processes stepping envs_per_worker copies of env each, slots in worker order."""
+    spec = env.worker_spec() if hasattr(env, "worker_spec") else None
+    if spec is None:
+        raise ValueError(f"{type(env).__name__} has no worker_spec(), it can't be rebuilt in a worker process")
+
+    fd, spec_path = tempfile.mkstemp(prefix="pearl_env_", suffix=".pkl")
+    with os.fdopen(fd, "wb") as f:
+        pickle.dump(spec, f)
+
+    # inside the lab sys.executable is the lab itself, workers need a plain interpreter
+    environ = dict(os.environ)
+    environ["PYTHONPATH"] = os.pathsep.join(p for p in sys.path if p and os.path.isdir(p))
+
+    processes = []
+    for w in range(workers):
+        processes.append(subprocess.Popen(
+            [_python(), "-m", "pearl.serving.worker", "--shm", shm_name, "--first", str(w * envs_per_worker),
+             "--count", str(envs_per_worker), "--spec", spec_path],
+            env=environ,
+        ))
+    return {"processes": processes, "spec_path": spec_path}
+
+
+def stop_workers(handle: Optional[Dict[str, Any]], timeout: float = 5.0):
+    """The server already raised the shutdown flag, give the workers a moment to finish their step."""
+    if not handle:
+        return
+    for process in handle["processes"]:
+        try:
+            process.wait(timeout=timeout)
+        except subprocess.TimeoutExpired:
+            process.kill()
+            process.wait()
+    try:
+        os.remove(handle["spec_path"])
+    except OSError:
+        pass
@@ -0,0 +1,87 @@
+"""
+Env-only worker process: steps its share of the envs with actions from the lab's inference server.
+
+    python -m pearl.serving.worker --shm NAME --first SLOT --count N --spec ENV_SPEC.pkl
+"""
+
+import argparse
+import pickle
+import time
+
+import numpy as np
+
+from pearl.serving import CLOSED, REQUEST, RESPONSE, SlotRegion, build_env
+
+
+def _submit(region: SlotRegion, slot: int, obs):
+    region.obs[slot][:] = np.asarray(obs, dtype=np.float32).reshape(-1)
+    region.counters[slot][1] += 1
+    region.times[slot][0] = time.monotonic_ns()
+    region.state[slot][0] = REQUEST  # last, the server may read the slot right after
+
+
+def _reward(reward) -> float:
+    if isinstance(reward, dict):
+        return float(sum(np.sum(v) for v in reward.values()))
+    return float(np.sum(reward))
+
+
+def run(shm_name: str, first: int, count: int, spec):
+    region = SlotRegion(shm_name)
+    slots = range(first, min(first + count, region.slots))
+    envs = {}
+    returns = {slot: 0.0 for slot in slots}
+
+    try:
+        # inside the try: an env that fails to build still closes every slot of this worker,
+        # the server would otherwise wait on them for the whole window of every batch
+        for slot in slots:
+            envs[slot] = build_env(spec)
+
+        for slot, env in envs.items():
+            obs, _ = env.reset()
+            _submit(region, slot, obs)
+
+        while not region.shutdown:
+            progressed = False
+            for slot, env in envs.items():
+                if region.state[slot][0] != RESPONSE:
+                    continue
+                progressed = True
+
+                obs, reward, terminated, truncated, _ = env.step(int(region.action[slot][0]))
+                returns[slot] += _reward(reward)
+                region.times[slot][1] += 1
+
+                if terminated or truncated:
+                    region.last_return[slot][0] = returns[slot]
+                    region.counters[slot][3] += 1
+                    returns[slot] = 0.0
+                    obs, _ = env.reset()
+                _submit(region, slot, obs)
+
+            if not progressed:
+                time.sleep(50e-6)
+    finally:
+        for slot in slots:
+            region.state[slot][0] = CLOSED
+        for env in envs.values():
+            env.close()
+        region.close()
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--shm", required=True)
+    parser.add_argument("--first", type=int, required=True)
+    parser.add_argument("--count", type=int, required=True)
+    parser.add_argument("--spec", required=True)
+    args = parser.parse_args()
+
+    with open(args.spec, "rb") as f:
+        spec = pickle.load(f)
+    run(args.shm, args.first, args.count, spec)
+
+
+if __name__ == "__main__":
+    main()
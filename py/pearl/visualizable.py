@@ -33,10 +33,21 @@ class Visualizable(ABC):
         """
         return None
 
+    def getVisualizationNames(self, m: VisualizationMethod) -> list[str] | None:
+        """
+        Optional, for FEATURES / BAR_CHART: the names of the values, asked once when the visualization is
+        initialized. If given, getVisualization returns a 1d float array in this order instead of a dict,
+        so no strings are rebuilt per step
+        :param m: the visualization method to query
+        :return: None to hand out dicts, else the list of names
+        """
+        return None
+
     @abstractmethod
     def getVisualization(self, m: VisualizationMethod, params: Any = None) -> np.ndarray | dict | None:
         """
-        Should return the visualization as np.array (Heatmap , RGB, Gray) or dict (Features <str, float>)
+        Should return the visualization as np.array (Heatmap , RGB, Gray) or dict (Features <str, float>),
+        or a float np.array ordered as getVisualizationNames when that declares names
         :param m: the visualization method to query
         :param params: if ths method requires parameters, then this should be the dataclass of the parameters
         :return: visualization as np.array (Heatmap , RGB, Gray) or dict (Features <str, float>)
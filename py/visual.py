@@ -1,8 +1,8 @@
 from enum import Enum
 
 class VisualizationMethod(Enum):
-    FEATURES  = 0 # a feature map <string, float>
-    RGB_ARRAY = 1 # float 2d RGB image, where each pixel color is in the range of [0, 1.0]
-    GRAY_SCAL = 2 # float 2d Gray image [0, 1.0]
-    HEAT_MAP  = 3 # float 2d image [-inf, inf]
-    BAR_CHART = 4 # a bar chart <string, float> where the string is the feature name and the float is the value
\ No newline at end of file
+    FEATURES  = 0 # a feature map <string, float>, or a float array named by getVisualizationNames
+    RGB_ARRAY = 1 # 2d RGB / RGBA image (H, W, C) or (C, H, W), uint8 [0, 255] or float [0, 1.0]
+    GRAY_SCAL = 2 # 2d Gray image, uint8 [0, 255] or float [0, 1.0]
+    HEAT_MAP  = 3 # 2d image of any numeric dtype [-inf, inf]
+    BAR_CHART = 4 # a bar chart <string, float> where the string is the feature name and the float is the value, or a float array named by getVisualizationNames
\ No newline at end of file
@@ -0,0 +1,462 @@
+#include "frame_exporter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // ---- png: zlib stream of one fixed huffman deflate block ----
+
+    uint32_t _crc32(const uint8_t *data, size_t size, uint32_t crc = 0)
+    {
+        static const auto table = []
+        {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t n = 0; n < 256; n++)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++)
+                    c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    uint32_t _adler32(const uint8_t *data, size_t size)
+    {
+        uint32_t a = 1, b = 0;
+        while (size > 0)
+        {
+            const size_t n = std::min<size_t>(size, 5552); // largest run before b can overflow
+            for (size_t i = 0; i < n; i++)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += n;
+            size -= n;
+        }
+        return (b << 16) | a;
+    }
+
+    struct _BitWriter
+    {
+        std::vector<uint8_t> &out;
+        uint64_t bits = 0;
+        int count = 0;
+
+        void put(uint32_t value, int n) // lsb first, as deflate wants everything but the codes
+        {
+            bits |= static_cast<uint64_t>(value) << count;
+            count += n;
+            while (count >= 8)
+            {
+                out.push_back(static_cast<uint8_t>(bits));
+                bits >>= 8;
+                count -= 8;
+            }
+        }
+
+        void flush()
+        {
+            if (count > 0)
+                out.push_back(static_cast<uint8_t>(bits));
+            bits = 0;
+            count = 0;
+        }
+    };
+
+    constexpr uint16_t _LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                           35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    constexpr uint8_t _LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                           3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    constexpr uint16_t _DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                         257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    constexpr uint8_t _DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                         7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    constexpr int _WINDOW = 32768;
+    constexpr int _MAX_MATCH = 258;
+    constexpr int _HASH_BITS = 15;
+
+    uint32_t _reverse(uint32_t code, int n)
+    {
+        uint32_t r = 0;
+        for (int i = 0; i < n; i++, code >>= 1)
+            r = (r << 1) | (code & 1);
+        return r;
+    }
+
+    // fixed literal / length code (RFC 1951 3.2.6), bit reversed so put() can write it
+    void _literal(_BitWriter &w, int symbol)
+    {
+        if (symbol < 144)
+            w.put(_reverse(0x30 + symbol, 8), 8);
+        else if (symbol < 256)
+            w.put(_reverse(0x190 + symbol - 144, 9), 9);
+        else if (symbol < 280)
+            w.put(_reverse(symbol - 256, 7), 7);
+        else
+            w.put(_reverse(0xC0 + symbol - 280, 8), 8);
+    }
+
+    void _match(_BitWriter &w, int length, int distance)
+    {
+        int l = 28;
+        while (_LENGTH_BASE[l] > length)
+            l--;
+        _literal(w, 257 + l);
+        w.put(length - _LENGTH_BASE[l], _LENGTH_EXTRA[l]);
+
+        int d = 29;
+        while (_DIST_BASE[d] > distance)
+            d--;
+        w.put(_reverse(d, 5), 5);
+        w.put(distance - _DIST_BASE[d], _DIST_EXTRA[d]);
+    }
+
+    uint32_t _load32(const uint8_t *p)
+    {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+
+    // greedy lz77 with one candidate per hash, good enough for env frames: after the Up filter
+    // anything that didn't move is a long run of zeros
+    void _deflate(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
+    {
+        std::vector<int32_t> head(size_t(1) << _HASH_BITS, -1);
+        _BitWriter w{out};
+        w.put(1, 1); // final block
+        w.put(1, 2); // fixed huffman
+
+        size_t pos = 0;
+        while (pos + 4 <= size)
+        {
+            const uint32_t v = _load32(data + pos);
+            const uint32_t h = (v * 2654435761u) >> (32 - _HASH_BITS);
+            const int32_t candidate = head[h];
+            head[h] = static_cast<int32_t>(pos);
+
+            if (candidate >= 0 && pos - candidate <= _WINDOW && _load32(data + candidate) == v)
+            {
+                const size_t max = std::min<size_t>(_MAX_MATCH, size - pos);
+                size_t length = 4;
+                while (length < max && data[candidate + length] == data[pos + length])
+                    length++;
+                _match(w, static_cast<int>(length), static_cast<int>(pos - candidate));
+                pos += length;
+            }
+            else
+            {
+                _literal(w, data[pos++]);
+            }
+        }
+        for (; pos < size; pos++)
+            _literal(w, data[pos]);
+
+        _literal(w, 256); // end of block
+        w.flush();
+    }
+
+    void _put32(std::vector<uint8_t> &out, uint32_t v) // big endian
+    {
+        out.push_back(static_cast<uint8_t>(v >> 24));
+        out.push_back(static_cast<uint8_t>(v >> 16));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    void _chunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data)
+    {
+        _put32(png, static_cast<uint32_t>(data.size()));
+        const size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        _put32(png, _crc32(png.data() + start, png.size() - start));
+    }
+
+    // file name of a y4m segment and its captions, png streams stay in segment 0
+    std::string _segment(const std::string &stream, int segment)
+    {
+        return segment == 0 ? stream : stream + "_" + std::to_string(segment);
+    }
+
+    // ---- captions ----
+
+    std::string _srt_time(int64_t frame, int fps)
+    {
+        const int64_t ms = frame * 1000 / fps;
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%02lld:%02lld:%02lld,%03lld", static_cast<long long>(ms / 3600000),
+                      static_cast<long long>(ms / 60000 % 60), static_cast<long long>(ms / 1000 % 60),
+                      static_cast<long long>(ms % 1000));
+        return buffer;
+    }
+}
+
+bool FrameExporter::writePng(const std::string &path, const uint8_t *rgb, int width, int height)
+{
+    // every row with the Up filter, the first one against zeros is just the raw row
+    const size_t row = static_cast<size_t>(width) * 3;
+    std::vector<uint8_t> filtered((row + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        uint8_t *dst = filtered.data() + y * (row + 1);
+        const uint8_t *src = rgb + y * row;
+        dst[0] = 2;
+        if (y == 0)
+        {
+            std::memcpy(dst + 1, src, row);
+            continue;
+        }
+        const uint8_t *above = src - row;
+        for (size_t i = 0; i < row; i++)
+            dst[1 + i] = static_cast<uint8_t>(src[i] - above[i]);
+    }
+
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    _deflate(filtered.data(), filtered.size(), idat);
+    _put32(idat, _adler32(filtered.data(), filtered.size()));
+
+    std::vector<uint8_t> ihdr;
+    _put32(ihdr, static_cast<uint32_t>(width));
+    _put32(ihdr, static_cast<uint32_t>(height));
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0}); // 8 bit rgb, deflate, no interlace
+
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    _chunk(png, "IHDR", ihdr);
+    _chunk(png, "IDAT", idat);
+    _chunk(png, "IEND", {});
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    const bool ok = std::fwrite(png.data(), 1, png.size(), file) == png.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+void FrameExporter::rgbToYuv444(const uint8_t *rgb, int width, int height, uint8_t *out)
+{
+    // BT.601 full range (JFIF), the header says XCOLORRANGE=FULL. Limited range would squeeze
+    // 256 levels into 220 and lose distinct ones for good
+    const size_t pixels = static_cast<size_t>(width) * height;
+    uint8_t *y_plane = out, *u_plane = out + pixels, *v_plane = out + 2 * pixels;
+    for (size_t i = 0; i < pixels; i++)
+    {
+        const int r = rgb[3 * i], g = rgb[3 * i + 1], b = rgb[3 * i + 2];
+        y_plane[i] = static_cast<uint8_t>((77 * r + 150 * g + 29 * b + 128) >> 8);
+        u_plane[i] = static_cast<uint8_t>(std::min(((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128, 255));
+        v_plane[i] = static_cast<uint8_t>(std::min(((128 * r - 107 * g - 21 * b + 128) >> 8) + 128, 255));
+    }
+}
+
+FrameExporter::~FrameExporter()
+{
+    stop();
+}
+
+void FrameExporter::start(const ExportConfig &config)
+{
+    stop();
+
+    if (config.directory.empty() || config.fps <= 0)
+        throw std::invalid_argument("FrameExporter: needs a directory and a positive frame rate");
+
+    std::error_code ec;
+    fs::create_directories(config.directory, ec);
+    if (ec)
+        throw std::runtime_error("FrameExporter: can't create " + config.directory + ": " + ec.message());
+
+    config_ = config;
+    streams_.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+        stats_ = ExportStats{};
+        stop_ = false;
+    }
+    thread_ = std::thread(&FrameExporter::_run, this);
+}
+
+void FrameExporter::stop()
+{
+    if (!thread_.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+}
+
+bool FrameExporter::submit(const std::string &stream, int64_t step, std::vector<uint8_t> rgb, int width, int height,
+                           std::string caption)
+{
+    if (width <= 0 || height <= 0 || rgb.size() != static_cast<size_t>(width) * height * 3)
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!thread_.joinable() || stop_)
+            return false;
+
+        // one frame always fits, so a single frame above the budget still goes through
+        if (!queue_.empty() && stats_.queued_bytes + rgb.size() > config_.max_queued_bytes)
+        {
+            stats_.dropped++;
+            return false;
+        }
+
+        stats_.queued_bytes += rgb.size();
+        stats_.queued_frames++;
+        queue_.push_back({stream, step, std::move(rgb), width, height, std::move(caption)});
+    }
+    wake_.notify_one();
+    return true;
+}
+
+ExportStats FrameExporter::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void FrameExporter::_run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        wake_.wait(lock, [this]
+                   { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) // stopping, and everything is written
+            break;
+
+        Job job = std::move(queue_.front());
+        queue_.pop_front();
+        stats_.queued_bytes -= job.rgb.size();
+        stats_.queued_frames--;
+        stats_.writing = true;
+
+        lock.unlock();
+        const bool ok = _write(job);
+        lock.lock();
+        (ok ? stats_.written : stats_.dropped)++;
+        stats_.writing = false;
+    }
+    lock.unlock();
+    _close();
+}
+
+bool FrameExporter::_write(Job &job)
+{
+    Stream &stream = streams_[job.stream];
+    const fs::path directory(config_.directory);
+
+    if (config_.format == ExportFormat::Y4M)
+    {
+        if (stream.video && (stream.width != job.width || stream.height != job.height))
+        {
+            // a new segment starts its own captions, both clocks from zero
+            std::fclose(stream.video);
+            stream.video = nullptr;
+            if (stream.captions)
+                std::fclose(stream.captions);
+            stream.captions = nullptr;
+            stream.segment++;
+            stream.frames = 0;
+            stream.cues = 0;
+        }
+        if (!stream.video)
+        {
+            const std::string path = (directory / (_segment(job.stream, stream.segment) + ".y4m")).string();
+            stream.video = std::fopen(path.c_str(), "wb");
+            if (!stream.video)
+                return _fail("can't open " + path);
+            std::fprintf(stream.video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444 XCOLORRANGE=FULL\n", job.width, job.height, config_.fps);
+            stream.width = job.width;
+            stream.height = job.height;
+        }
+
+        scratch_.resize(job.rgb.size());
+        rgbToYuv444(job.rgb.data(), job.width, job.height, scratch_.data());
+        std::fputs("FRAME\n", stream.video);
+        if (std::fwrite(scratch_.data(), 1, scratch_.size(), stream.video) != scratch_.size())
+            return _fail("write failed for " + job.stream + ".y4m");
+    }
+    else
+    {
+        const fs::path folder = directory / job.stream;
+        if (stream.frames == 0)
+        {
+            std::error_code ec;
+            fs::create_directories(folder, ec);
+        }
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%08lld.png", static_cast<long long>(job.step));
+        const std::string path = (folder / name).string();
+        if (!writePng(path, job.rgb.data(), job.width, job.height))
+            return _fail("can't write " + path);
+    }
+
+    _caption(stream, job);
+    stream.frames++;
+    return true;
+}
+
+void FrameExporter::_caption(Stream &stream, const Job &job)
+{
+    if (job.caption.empty())
+        return;
+
+    if (!stream.captions)
+    {
+        const std::string path = (fs::path(config_.directory) / (_segment(job.stream, stream.segment) + ".srt")).string();
+        stream.captions = std::fopen(path.c_str(), "w");
+        if (!stream.captions)
+        {
+            _fail("can't open " + path);
+            return;
+        }
+    }
+
+    // shown for the frame's own duration, on the same clock as the video
+    std::fprintf(stream.captions, "%d\n%s --> %s\n%s\n\n", ++stream.cues, _srt_time(stream.frames, config_.fps).c_str(),
+                 _srt_time(stream.frames + 1, config_.fps).c_str(), job.caption.c_str());
+}
+
+void FrameExporter::_close()
+{
+    for (auto &[name, stream] : streams_)
+    {
+        if (stream.video)
+            std::fclose(stream.video);
+        if (stream.captions)
+            std::fclose(stream.captions);
+    }
+    streams_.clear();
+}
+
+bool FrameExporter::_fail(const std::string &message)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.error = message;
+    return false;
+}
@@ -0,0 +1,114 @@
+#ifndef FRAME_EXPORTER_HPP
+#define FRAME_EXPORTER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ExportFormat
+{
+    Y4M = 0, // one full range 4:4:4 video per stream
+    PNG      // <stream>/<frame>.png
+};
+
+struct ExportConfig
+{
+    std::string directory;
+    ExportFormat format = ExportFormat::PNG;
+    int fps = 30;                                // y4m frame rate and caption timing
+    size_t max_queued_bytes = size_t(256) << 20; // frames beyond this are dropped, not waited for
+};
+
+struct ExportStats
+{
+    uint64_t written = 0;
+    uint64_t dropped = 0; // queue was full or the write failed
+    size_t queued_bytes = 0;
+    size_t queued_frames = 0;
+    bool writing = false; // a frame taken off the queue is still being encoded
+    std::string error; // last write error, empty if none
+};
+
+// Writes frames handed over by the simulation to disk on its own thread. submit() only moves
+// the frame into a queue, so the caller never waits on encoding or the disk: when the encoder
+// falls behind by more than max_queued_bytes, new frames are dropped and counted instead.
+//
+// Each stream (one per agent) gets its own video or image folder, captions go to a
+// <stream>.srt next to it (<stream>_<n>.srt for the y4m segment a size change starts).
+// No python, GL or ImGui in here, any thread can own it.
+class FrameExporter
+{
+public:
+    FrameExporter() = default;
+    ~FrameExporter();
+
+    FrameExporter(const FrameExporter &) = delete;
+    FrameExporter &operator=(const FrameExporter &) = delete;
+
+    // creates the directory, throws if that fails or the config is invalid
+    void start(const ExportConfig &config);
+    // writes out what's still queued, then closes every file
+    void stop();
+
+    // rgb is width * height * 3 packed bytes. false if the frame was dropped
+    bool submit(const std::string &stream, int64_t step, std::vector<uint8_t> rgb, int width, int height,
+                std::string caption = {});
+
+    bool running() const { return thread_.joinable(); }
+    const ExportConfig &config() const { return config_; }
+    ExportStats stats() const;
+
+    // encoders, exposed for anything else that wants a frame on disk. png stores the bytes
+    // exactly, use it when frames have to match. y4m is full range BT.601 4:4:4: no chroma
+    // subsampling, near-lossless, an rgb -> yuv -> rgb round trip is off by a level or two
+    static bool writePng(const std::string &path, const uint8_t *rgb, int width, int height);
+    static void rgbToYuv444(const uint8_t *rgb, int width, int height, uint8_t *out);
+
+private:
+    struct Job
+    {
+        std::string stream;
+        int64_t step;
+        std::vector<uint8_t> rgb;
+        int width, height;
+        std::string caption;
+    };
+
+    struct Stream
+    {
+        std::FILE *video = nullptr;
+        std::FILE *captions = nullptr;
+        int width = 0, height = 0;
+        int segment = 0;   // y4m: bumped on a size change, each segment is its own video and .srt
+        int64_t frames = 0; // written to this segment so far, the caption clock
+        int cues = 0;
+    };
+
+    void _run();
+    bool _write(Job &job); // false if the frame didn't make it to disk
+    void _caption(Stream &stream, const Job &job);
+    void _close();
+    bool _fail(const std::string &message); // records the error, returns false
+
+    ExportConfig config_;
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Job> queue_;
+    bool stop_ = false;
+    ExportStats stats_;
+
+    // worker thread only
+    std::map<std::string, Stream> streams_;
+    std::vector<uint8_t> scratch_;
+};
+
+#endif // FRAME_EXPORTER_HPP
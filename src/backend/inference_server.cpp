@@ -0,0 +1,303 @@
+#include "inference_server.hpp"
+
+#include <pybind11/numpy.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "../ui/modules/logger.hpp"
+
+namespace
+{
+    uint64_t _monotonicNs()
+    {
+        // steady_clock is CLOCK_MONOTONIC on linux, same clock as python's time.monotonic_ns()
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    int32_t _argmax(const float *row, size_t n)
+    {
+        return static_cast<int32_t>(std::max_element(row, row + n) - row);
+    }
+}
+
+InferenceServer::~InferenceServer()
+{
+    stop();
+}
+
+bool InferenceServer::start(const PyAgent &agent, const py::object &env, const InferenceServerConfig &config)
+{
+    stop();
+
+    if (config.workers <= 0 || config.envs_per_worker <= 0 || config.max_batch <= 0 || config.window_us < 0)
+        throw std::invalid_argument("InferenceServer: workers, envs per worker and max batch must be positive");
+
+    // observation layout from the lab's own instance of the env
+    auto obs = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(env.attr("get_observations")());
+    if (!obs || obs.size() == 0)
+        throw std::runtime_error("InferenceServer: the environment has no observation, reset it first");
+
+    obs_shape_.assign(obs.shape(), obs.shape() + obs.ndim());
+    if (obs_shape_.size() > 1 && obs_shape_.front() == 1)
+        obs_shape_.erase(obs_shape_.begin());
+
+    config_ = config;
+    agent_ = agent;
+    if (agent.native_model && agent.native_model->inputSize() == static_cast<size_t>(obs.size()))
+        model_ = std::make_unique<Native::Model>(agent.native_model->path());
+
+    static int instance = 0;
+    const std::string name = "pearl_srv_" + std::to_string(getpid()) + "_" + std::to_string(instance++);
+    const uint32_t slots = static_cast<uint32_t>(config.workers * config.envs_per_worker);
+
+    try
+    {
+        region_ = std::make_unique<Native::SlotRegion>(name, slots, static_cast<uint32_t>(obs.size()));
+        pending_.assign(slots, 0);
+
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_ = InferenceStats{};
+            stats_.native = model_ != nullptr;
+            window_start_ = std::chrono::steady_clock::now();
+            window_requests_ = 0;
+            window_latency_sum_ = 0;
+            window_latency_max_ = 0;
+        }
+
+        workers_ = py::module_::import("pearl.serving")
+                       .attr("launch_workers")(env, name, config.workers, config.envs_per_worker);
+    }
+    catch (...)
+    {
+        stop();
+        throw;
+    }
+
+    if (model_)
+    {
+        stop_ = false;
+        thread_ = std::thread(&InferenceServer::_serveLoop, this);
+    }
+
+    Logger::info("Inference server: " + std::to_string(slots) + " envs over " + std::to_string(config.workers) +
+                 " workers, " + (model_ ? "native model on the server thread" : "python predict on the UI thread"));
+    return true;
+}
+
+void InferenceServer::stop()
+{
+    if (thread_.joinable())
+    {
+        stop_ = true;
+        thread_.join();
+    }
+
+    if (region_)
+    {
+        region_->requestShutdown();
+        if (workers_ && !workers_.is_none())
+        {
+            try
+            {
+                py::module_::import("pearl.serving").attr("stop_workers")(workers_);
+            }
+            catch (const std::exception &e)
+            {
+                Logger::warning("Inference server: " + std::string(e.what()));
+            }
+        }
+        region_.reset();
+        Logger::info("Inference server stopped.");
+    }
+
+    workers_ = py::object();
+    agent_ = PyAgent();
+    model_.reset();
+}
+
+void InferenceServer::_collect(std::vector<Ready> &ready)
+{
+    for (uint32_t i = 0; i < region_->slots(); i++)
+    {
+        if (!pending_[i] && region_->state(i) == Native::SlotState::REQUEST)
+        {
+            pending_[i] = 1;
+            ready.push_back({i, region_->slot(i).sent_ns});
+        }
+    }
+}
+
+void InferenceServer::_serveLoop()
+{
+    std::vector<Ready> ready;
+    const size_t max_batch = static_cast<size_t>(config_.max_batch);
+
+    while (!stop_)
+    {
+        ready.clear();
+        _collect(ready);
+        if (ready.empty())
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+
+        // the first request opens the batch, wait for the rest of the envs a little
+        size_t live = 0;
+        for (uint32_t i = 0; i < region_->slots(); i++)
+            live += region_->state(i) != Native::SlotState::CLOSED;
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(config_.window_us);
+        while (ready.size() < std::min(max_batch, live) && std::chrono::steady_clock::now() < deadline && !stop_)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+            _collect(ready);
+        }
+
+        // anything above max_batch goes in the next round
+        for (size_t k = max_batch; k < ready.size(); k++)
+            pending_[ready[k].slot] = 0;
+        if (ready.size() > max_batch)
+            ready.resize(max_batch);
+
+        _serveNative(ready);
+    }
+}
+
+void InferenceServer::_serveNative(const std::vector<Ready> &ready)
+{
+    const size_t n = ready.size();
+    const size_t obs_size = region_->obsSize();
+
+    batch_.resize(n * obs_size);
+    for (size_t k = 0; k < n; k++)
+        std::memcpy(batch_.data() + k * obs_size, region_->observation(ready[k].slot), obs_size * sizeof(float));
+
+    const float *out = model_->forward(batch_.data(), n);
+    const size_t actions = model_->outputSize();
+    for (size_t k = 0; k < n; k++)
+    {
+        pending_[ready[k].slot] = 0;
+        region_->respond(ready[k].slot, _argmax(out + k * actions, actions));
+    }
+    _record(ready);
+}
+
+void InferenceServer::_servePython(const std::vector<Ready> &ready)
+{
+    const size_t n = ready.size();
+    const size_t obs_size = region_->obsSize();
+
+    std::vector<ssize_t> shape = {static_cast<ssize_t>(n)};
+    shape.insert(shape.end(), obs_shape_.begin(), obs_shape_.end());
+    py::array_t<float> batch(shape);
+    for (size_t k = 0; k < n; k++)
+        std::memcpy(batch.mutable_data() + k * obs_size, region_->observation(ready[k].slot), obs_size * sizeof(float));
+
+    // agents return (n, actions) or the same flattened
+    auto prediction = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(agent_.predict(batch));
+    if (!prediction || prediction.size() == 0 || static_cast<size_t>(prediction.size()) % n != 0)
+        throw std::runtime_error("InferenceServer: predict returned " + std::to_string(prediction ? prediction.size() : 0) +
+                                 " values for a batch of " + std::to_string(n));
+
+    const size_t actions = static_cast<size_t>(prediction.size()) / n;
+    for (size_t k = 0; k < n; k++)
+    {
+        pending_[ready[k].slot] = 0;
+        region_->respond(ready[k].slot, _argmax(prediction.data() + k * actions, actions));
+    }
+    _record(ready);
+}
+
+void InferenceServer::poll()
+{
+    if (!region_)
+        return;
+
+    if (!model_)
+    {
+        std::vector<Ready> ready;
+        _collect(ready);
+        if (!ready.empty())
+        {
+            try
+            {
+                _servePython(ready);
+            }
+            catch (...)
+            {
+                // let the slots be picked up again next frame
+                for (const auto &r : ready)
+                    pending_[r.slot] = 0;
+                throw;
+            }
+        }
+    }
+
+    // env side counters, written by the workers
+    uint64_t episodes = 0, steps = 0;
+    double returns = 0;
+    int live = 0, finished = 0;
+    for (uint32_t i = 0; i < region_->slots(); i++)
+    {
+        const auto &slot = region_->slot(i);
+        live += region_->state(i) != Native::SlotState::CLOSED;
+        episodes += slot.episodes;
+        steps += slot.steps;
+        if (slot.episodes > 0)
+        {
+            returns += slot.last_return;
+            finished++;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.episodes = episodes;
+    stats_.env_steps = steps;
+    stats_.mean_return = finished ? returns / finished : 0;
+    stats_.live_envs = live;
+}
+
+void InferenceServer::_record(const std::vector<Ready> &ready)
+{
+    const uint64_t now = _monotonicNs();
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.requests += ready.size();
+    stats_.batches += 1;
+    stats_.mean_batch = static_cast<double>(stats_.requests) / stats_.batches;
+
+    for (const auto &r : ready)
+    {
+        const double latency = now > r.sent_ns ? (now - r.sent_ns) / 1000.0 : 0.0;
+        window_latency_sum_ += latency;
+        window_latency_max_ = std::max(window_latency_max_, latency);
+    }
+    window_requests_ += ready.size();
+
+    // rates over roughly the last second
+    const auto elapsed = std::chrono::steady_clock::now() - window_start_;
+    if (elapsed >= std::chrono::seconds(1))
+    {
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+        stats_.requests_per_second = window_requests_ / seconds;
+        stats_.mean_latency_us = window_requests_ ? window_latency_sum_ / window_requests_ : 0;
+        stats_.max_latency_us = window_latency_max_;
+
+        window_start_ = std::chrono::steady_clock::now();
+        window_requests_ = 0;
+        window_latency_sum_ = 0;
+        window_latency_max_ = 0;
+    }
+}
+
+InferenceStats InferenceServer::stats() const
+{
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
@@ -0,0 +1,101 @@
+#ifndef INFERENCE_SERVER_HPP
+#define INFERENCE_SERVER_HPP
+
+#include <pybind11/pybind11.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "py_agent.hpp"
+#include "native/inference_slots.hpp"
+#include "native/model.hpp"
+
+namespace py = pybind11;
+
+struct InferenceServerConfig
+{
+    int workers = 2;          // env worker processes
+    int envs_per_worker = 4;  // envs (slots) each worker steps
+    int window_us = 2000;     // how long the first request of a batch waits for more
+    int max_batch = 64;       // a batch is sent as soon as it has this many requests
+};
+
+struct InferenceStats
+{
+    uint64_t requests = 0;
+    uint64_t batches = 0;
+    double mean_batch = 0;          // requests per batch
+    double mean_latency_us = 0;     // request written -> action written, last second
+    double max_latency_us = 0;      // last second
+    double requests_per_second = 0; // last second
+    uint64_t episodes = 0;
+    uint64_t env_steps = 0;
+    double mean_return = 0; // last finished episode of every env
+    int live_envs = 0;
+    bool native = false;
+};
+
+// SEED style evaluation: the lab holds the agent, env-only worker processes (pearl.serving.worker)
+// send observations through a shared memory SlotRegion and get actions back.
+//
+// With a native model the server runs on its own thread without the GIL: the first request opens
+// a batch that waits up to window_us for the other envs, then everything goes through one forward.
+// Agents without a native model are served from poll() on the UI thread via PyAgent::predict,
+// which batches whatever is ready at that moment.
+class InferenceServer
+{
+public:
+    InferenceServer() = default;
+    ~InferenceServer();
+
+    // GIL held. env is an instance of the env to run (its worker_spec() and observation shape are used)
+    bool start(const PyAgent &agent, const py::object &env, const InferenceServerConfig &config);
+    void stop();
+
+    // UI thread, GIL held: serves the python path, refreshes the env stats
+    void poll();
+
+    bool running() const { return region_ != nullptr; }
+    InferenceStats stats() const;
+
+private:
+    struct Ready
+    {
+        uint32_t slot;
+        uint64_t sent_ns;
+    };
+
+    void _serveLoop();
+    void _collect(std::vector<Ready> &ready);
+    void _serveNative(const std::vector<Ready> &ready);
+    void _servePython(const std::vector<Ready> &ready);
+    void _record(const std::vector<Ready> &ready);
+
+    InferenceServerConfig config_;
+    std::unique_ptr<Native::SlotRegion> region_;
+    std::unique_ptr<Native::Model> model_; // own copy, Native::Model isn't thread safe
+    PyAgent agent_;
+    py::object workers_;
+    std::vector<ssize_t> obs_shape_; // one observation, leading batch dim of 1 dropped
+
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+
+    std::vector<float> batch_;
+    std::vector<uint8_t> pending_; // python path, slots already taken this poll
+
+    mutable std::mutex stats_mutex_;
+    InferenceStats stats_;
+    std::chrono::steady_clock::time_point window_start_;
+    uint64_t window_requests_ = 0;
+    double window_latency_sum_ = 0;
+    double window_latency_max_ = 0;
+};
+
+#endif // INFERENCE_SERVER_HPP
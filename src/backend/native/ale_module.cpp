@@ -0,0 +1,165 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "atari_frame.hpp"
+
+namespace py = pybind11;
+
+// Drives an ale_py.ALEInterface directly (no gym.make, no wrappers) and does the whole
+// frame-skip / max-pool / grayscale / resize / stack chain in C++.
+// The observation and screen are exposed as numpy views over the native buffers, so
+// agents and the preview read them without any copy.
+class AtariEnvCore
+{
+public:
+    AtariEnvCore(py::object ale, int frame_skip, int stack, int height, int width, bool grayscale, bool max_pool)
+        : ale_(std::move(ale)), frame_skip_(frame_skip)
+    {
+        if (frame_skip <= 0)
+            throw std::invalid_argument("frame_skip must be positive");
+
+        py::tuple dims = ale_.attr("getScreenDims")();
+
+        Native::AtariFrameConfig config;
+        config.screen_h = dims[0].cast<int>();
+        config.screen_w = dims[1].cast<int>();
+        config.out_h = height;
+        config.out_w = width;
+        config.stack = stack;
+        config.grayscale = grayscale;
+        config.max_pool = max_pool;
+        pipeline_ = std::make_unique<Native::AtariFramePipeline>(config);
+
+        py::list action_set = ale_.attr("getMinimalActionSet")();
+        for (auto a : action_set)
+        {
+            actions_.append(a);
+        }
+
+        act_ = ale_.attr("act");
+        game_over_ = ale_.attr("game_over");
+        get_screen_ = ale_.attr("getScreenRGB");
+        has_truncation_ = py::hasattr(ale_, "game_truncated");
+
+        // views over the two native screen buffers, the emulator renders into them directly
+        for (int i = 0; i < 2; i++)
+        {
+            screen_views_[i] = py::array_t<uint8_t>({config.screen_h, config.screen_w, 3},
+                                                    pipeline_->screen(i), py::capsule(this, [](void *) {}));
+        }
+    }
+
+    void reset()
+    {
+        ale_.attr("reset_game")();
+        get_screen_(screen_views_[1]);
+
+        py::gil_scoped_release release;
+        pipeline_->reset();
+    }
+
+    // returns (reward, terminated, truncated)
+    py::tuple step(int action)
+    {
+        if (action < 0 || action >= static_cast<int>(actions_.size()))
+            throw std::out_of_range("action index " + std::to_string(action) + " out of range");
+
+        py::object ale_action = actions_[action];
+
+        double reward = 0;
+        bool terminated = false;
+        int captured = 0;
+
+        for (int i = 0; i < frame_skip_; i++)
+        {
+            reward += act_(ale_action).cast<double>();
+
+            // only the last two frames of a skip matter for pooling
+            if (i >= frame_skip_ - 2)
+            {
+                get_screen_(screen_views_[frame_skip_ == 1 ? 1 : i - (frame_skip_ - 2)]);
+                captured++;
+            }
+
+            if (game_over_().cast<bool>())
+            {
+                terminated = true;
+                break;
+            }
+        }
+
+        // ended early, the latest screen is whatever the emulator shows now
+        if (captured == 0 || (terminated && captured < 2 && frame_skip_ > 1))
+        {
+            get_screen_(screen_views_[1]);
+            captured = 1;
+        }
+
+        bool truncated = has_truncation_ && ale_.attr("game_truncated")().cast<bool>();
+        if (truncated)
+            terminated = false;
+
+        {
+            py::gil_scoped_release release;
+            pipeline_->push(captured == 2);
+        }
+
+        return py::make_tuple(reward, terminated, truncated);
+    }
+
+    int actionCount() const { return static_cast<int>(actions_.size()); }
+
+    const Native::AtariFramePipeline &pipeline() const { return *pipeline_; }
+    Native::AtariFramePipeline &pipeline() { return *pipeline_; }
+
+private:
+    py::object ale_;
+    py::object act_;
+    py::object game_over_;
+    py::object get_screen_;
+    py::list actions_;
+    py::array_t<uint8_t> screen_views_[2];
+    bool has_truncation_ = false;
+
+    int frame_skip_;
+    std::unique_ptr<Native::AtariFramePipeline> pipeline_;
+};
+
+PYBIND11_EMBEDDED_MODULE(pearl_ale, m)
+{
+    py::class_<AtariEnvCore>(m, "AtariEnvCore")
+        .def(py::init<py::object, int, int, int, int, bool, bool>(),
+             py::arg("ale"), py::arg("frame_skip") = 4, py::arg("stack") = 4,
+             py::arg("height") = 84, py::arg("width") = 84,
+             py::arg("grayscale") = true, py::arg("max_pool") = true)
+        .def("reset", &AtariEnvCore::reset)
+        .def("step", &AtariEnvCore::step)
+        .def("action_count", &AtariEnvCore::actionCount)
+        // (stack, H, W) or (stack, H, W, 3) uint8 view, valid until the next step / reset
+        .def("observation", [](py::object self)
+             {
+                auto &core = self.cast<AtariEnvCore &>();
+                const auto &c = core.pipeline().config();
+                std::vector<ssize_t> shape = {c.stack, c.out_h, c.out_w};
+                if (!c.grayscale) shape.push_back(3);
+                return py::array_t<uint8_t>(shape, core.pipeline().observation(), self); })
+        // same layout as observation(), scaled to [0, 1]
+        .def("observation_float", [](py::object self)
+             {
+                auto &core = self.cast<AtariEnvCore &>();
+                const auto &c = core.pipeline().config();
+                std::vector<ssize_t> shape = {c.stack, c.out_h, c.out_w};
+                if (!c.grayscale) shape.push_back(3);
+                return py::array_t<float>(shape, core.pipeline().observationFloat(), self); })
+        // latest raw RGB screen (H, W, 3)
+        .def("screen", [](py::object self)
+             {
+                auto &core = self.cast<AtariEnvCore &>();
+                const auto &c = core.pipeline().config();
+                return py::array_t<uint8_t>({c.screen_h, c.screen_w, 3}, core.pipeline().lastScreen(), self); });
+}
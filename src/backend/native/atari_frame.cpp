@@ -0,0 +1,73 @@
+#include "atari_frame.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+Native::AtariFramePipeline::AtariFramePipeline(const AtariFrameConfig &config)
+    : config_(config)
+{
+    if (config.stack <= 0)
+        throw std::invalid_argument("AtariFramePipeline: stack must be positive");
+
+    resizer_ = AreaResizer(config.screen_h, config.screen_w, config.out_h, config.out_w, channels());
+
+    screens_[0].resize(screenSize());
+    screens_[1].resize(screenSize());
+    pooled_.resize(screenSize());
+    gray_.resize(static_cast<size_t>(config.screen_h) * config.screen_w);
+    stacked_.resize(frameSize() * config.stack);
+    stacked_float_.resize(stacked_.size());
+}
+
+void Native::AtariFramePipeline::_process(bool pooled, uint8_t *out)
+{
+    const uint8_t *rgb = screens_[1].data();
+    if (pooled && config_.max_pool)
+    {
+        maxPool(screens_[0].data(), screens_[1].data(), pooled_.data(), pooled_.size());
+        rgb = pooled_.data();
+    }
+
+    const uint8_t *src = rgb;
+    if (config_.grayscale)
+    {
+        rgbToGray(rgb, gray_.data(), gray_.size());
+        src = gray_.data();
+    }
+
+    resizer_.resize(src, out);
+    float_dirty_ = true;
+}
+
+void Native::AtariFramePipeline::reset()
+{
+    const size_t frame = frameSize();
+    uint8_t *last = stacked_.data() + (config_.stack - 1) * frame;
+
+    _process(false, last);
+    for (int i = 0; i < config_.stack - 1; i++)
+    {
+        std::memcpy(stacked_.data() + i * frame, last, frame);
+    }
+}
+
+void Native::AtariFramePipeline::push(bool pooled)
+{
+    const size_t frame = frameSize();
+    if (config_.stack > 1)
+    {
+        std::memmove(stacked_.data(), stacked_.data() + frame, frame * (config_.stack - 1));
+    }
+
+    _process(pooled, stacked_.data() + (config_.stack - 1) * frame);
+}
+
+const float *Native::AtariFramePipeline::observationFloat()
+{
+    if (float_dirty_)
+    {
+        toUnitFloat(stacked_.data(), stacked_float_.data(), stacked_.size());
+        float_dirty_ = false;
+    }
+    return stacked_float_.data();
+}
@@ -0,0 +1,67 @@
+#ifndef NATIVE_ATARI_FRAME_HPP
+#define NATIVE_ATARI_FRAME_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "image_ops.hpp"
+
+namespace Native
+{
+    struct AtariFrameConfig
+    {
+        int screen_h = 210;
+        int screen_w = 160;
+        int out_h = 84;
+        int out_w = 84;
+        int stack = 4;
+        bool grayscale = true;
+        bool max_pool = true; // max over the last two emulator frames of a skip (removes sprite flicker)
+    };
+
+    // Turns raw ALE screens into the stacked observation the agents consume.
+    //
+    // The emulator writes RGB screens straight into screen(0) / screen(1), (1) being the most recent.
+    // push() then runs max-pool -> grayscale -> area resize in place and appends the result to the
+    // frame stack, which is kept as one contiguous (stack, out_h, out_w[, 3]) buffer, oldest frame first.
+    class AtariFramePipeline
+    {
+    public:
+        explicit AtariFramePipeline(const AtariFrameConfig &config);
+
+        uint8_t *screen(int index) { return screens_[index].data(); }
+        const uint8_t *lastScreen() const { return screens_[1].data(); }
+
+        // fills every stack slot with the processed screen(1)
+        void reset();
+
+        // processes the latest screens and shifts them into the stack,
+        // pooled = false when the step ended before the second screen was captured
+        void push(bool pooled);
+
+        const uint8_t *observation() const { return stacked_.data(); }
+        const float *observationFloat(); // [0, 1] copy of observation(), converted lazily
+
+        const uint8_t *lastFrame() const { return stacked_.data() + (config_.stack - 1) * frameSize(); }
+
+        const AtariFrameConfig &config() const { return config_; }
+        int channels() const { return config_.grayscale ? 1 : 3; }
+        size_t frameSize() const { return static_cast<size_t>(config_.out_h) * config_.out_w * channels(); }
+        size_t screenSize() const { return static_cast<size_t>(config_.screen_h) * config_.screen_w * 3; }
+
+    private:
+        void _process(bool pooled, uint8_t *out);
+
+        AtariFrameConfig config_;
+        AreaResizer resizer_;
+
+        std::vector<uint8_t> screens_[2];
+        std::vector<uint8_t> pooled_;
+        std::vector<uint8_t> gray_;
+        std::vector<uint8_t> stacked_;
+        std::vector<float> stacked_float_;
+        bool float_dirty_ = true;
+    };
+}
+
+#endif // NATIVE_ATARI_FRAME_HPP
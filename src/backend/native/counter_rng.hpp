@@ -0,0 +1,62 @@
+#ifndef NATIVE_COUNTER_RNG_HPP
+#define NATIVE_COUNTER_RNG_HPP
+
+#include <cmath>
+#include <cstdint>
+
+namespace Native
+{
+    // splitmix64 finalizer
+    inline uint64_t mix64(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Counter based random numbers: value i of a (seed, stream) pair is a pure function of i,
+    // so threads can fill any slice of a perturbation batch and get the same numbers as a
+    // serial loop. Streams give every explanation / step its own independent sequence.
+    class CounterRng
+    {
+    public:
+        CounterRng(uint64_t seed = 0, uint64_t stream = 0)
+            : key_(mix64(seed ^ mix64(stream + 0x632BE59BD9B4E019ull)))
+        {
+        }
+
+        uint64_t bits(uint64_t counter) const
+        {
+            return mix64(mix64(counter * 0x9E3779B97F4A7C15ull + key_) ^ key_);
+        }
+
+        // [0, 1)
+        float uniform(uint64_t counter) const
+        {
+            return static_cast<float>(bits(counter) >> 40) * (1.0f / 16777216.0f);
+        }
+
+        // (0, 1], safe for log
+        float uniformOpen(uint64_t counter) const
+        {
+            return static_cast<float>((bits(counter) >> 40) + 1) * (1.0f / 16777216.0f);
+        }
+
+        // two independent standard normals (Box-Muller, single precision) from one 64 bit draw
+        void normalPair(uint64_t counter, float &a, float &b) const
+        {
+            const uint64_t v = bits(counter);
+            const float u1 = static_cast<float>((v >> 40) + 1) * (1.0f / 16777216.0f);
+            const float u2 = static_cast<float>((v >> 16) & 0xFFFFFF) * (1.0f / 16777216.0f);
+            const float r = std::sqrt(-2.0f * std::log(u1));
+            const float t = 6.2831853f * u2;
+            a = r * std::cos(t);
+            b = r * std::sin(t);
+        }
+
+    private:
+        uint64_t key_;
+    };
+}
+
+#endif // NATIVE_COUNTER_RNG_HPP
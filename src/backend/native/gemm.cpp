@@ -0,0 +1,355 @@
+#include "gemm.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define NATIVE_GEMM_AVX2 1
+#endif
+
+namespace
+{
+    inline float _apply(float v, Native::Activation act)
+    {
+        switch (act)
+        {
+        case Native::Activation::RELU:
+            return v > 0 ? v : 0;
+        case Native::Activation::TANH:
+            return std::tanh(v);
+        case Native::Activation::SIGMOID:
+            return 1.0f / (1.0f + std::exp(-v));
+        default:
+            return v;
+        }
+    }
+
+#ifdef NATIVE_GEMM_AVX2
+    inline float _hsum(__m256 v)
+    {
+        __m128 lo = _mm256_castps256_ps128(v);
+        __m128 hi = _mm256_extractf128_ps(v, 1);
+        lo = _mm_add_ps(lo, hi);
+        lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+        lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 0x55));
+        return _mm_cvtss_f32(lo);
+    }
+#endif
+}
+
+void Native::activate(float *x, size_t n, Activation act)
+{
+    if (act == Activation::NONE || act == Activation::SOFTMAX)
+        return;
+
+    if (act == Activation::RELU)
+    {
+        for (size_t i = 0; i < n; i++)
+            x[i] = x[i] > 0 ? x[i] : 0;
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++)
+        x[i] = _apply(x[i], act);
+}
+
+void Native::softmaxRows(float *x, size_t rows, size_t cols)
+{
+    for (size_t r = 0; r < rows; r++)
+    {
+        float *row = x + r * cols;
+        const float max = *std::max_element(row, row + cols);
+
+        float sum = 0;
+        for (size_t c = 0; c < cols; c++)
+        {
+            row[c] = std::exp(row[c] - max);
+            sum += row[c];
+        }
+
+        const float inv = 1.0f / sum;
+        for (size_t c = 0; c < cols; c++)
+            row[c] *= inv;
+    }
+}
+
+float Native::dot(const float *a, const float *b, size_t n)
+{
+    size_t i = 0;
+    float result = 0;
+
+#ifdef NATIVE_GEMM_AVX2
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+
+    for (; i + 32 <= n; i += 32)
+    {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+    }
+    for (; i + 8 <= n; i += 8)
+    {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+
+    result = _hsum(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+#endif
+
+    for (; i < n; i++)
+        result += a[i] * b[i];
+
+    return result;
+}
+
+void Native::gemv(const float *W, const float *x, const float *bias, float *y,
+                  size_t out, size_t in, Activation act)
+{
+    for (size_t o = 0; o < out; o++)
+    {
+        const float v = dot(W + o * in, x, in) + (bias ? bias[o] : 0.0f);
+        y[o] = _apply(v, act);
+    }
+}
+
+void Native::gemmNT(const float *X, const float *W, const float *bias, float *Y,
+                    size_t batch, size_t out, size_t in, Activation act)
+{
+    if (batch == 1)
+    {
+        gemv(W, X, bias, Y, out, in, act);
+        return;
+    }
+
+    size_t b = 0;
+
+#ifdef NATIVE_GEMM_AVX2
+    for (; b + 4 <= batch; b += 4)
+    {
+        const float *x0 = X + (b + 0) * in;
+        const float *x1 = X + (b + 1) * in;
+        const float *x2 = X + (b + 2) * in;
+        const float *x3 = X + (b + 3) * in;
+
+        for (size_t o = 0; o < out; o++)
+        {
+            const float *w = W + o * in;
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            __m256 acc2 = _mm256_setzero_ps();
+            __m256 acc3 = _mm256_setzero_ps();
+
+            size_t k = 0;
+            for (; k + 8 <= in; k += 8)
+            {
+                const __m256 wv = _mm256_loadu_ps(w + k);
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x0 + k), wv, acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x1 + k), wv, acc1);
+                acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(x2 + k), wv, acc2);
+                acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(x3 + k), wv, acc3);
+            }
+
+            float s0 = _hsum(acc0), s1 = _hsum(acc1), s2 = _hsum(acc2), s3 = _hsum(acc3);
+            for (; k < in; k++)
+            {
+                s0 += x0[k] * w[k];
+                s1 += x1[k] * w[k];
+                s2 += x2[k] * w[k];
+                s3 += x3[k] * w[k];
+            }
+
+            const float bv = bias ? bias[o] : 0.0f;
+            Y[(b + 0) * out + o] = _apply(s0 + bv, act);
+            Y[(b + 1) * out + o] = _apply(s1 + bv, act);
+            Y[(b + 2) * out + o] = _apply(s2 + bv, act);
+            Y[(b + 3) * out + o] = _apply(s3 + bv, act);
+        }
+    }
+#endif
+
+    for (; b < batch; b++)
+    {
+        gemv(W, X + b * in, bias, Y + b * out, out, in, act);
+    }
+}
+
+namespace
+{
+    constexpr size_t GEMM_KC = 256; // rows of B per block (B block stays in L2)
+    constexpr size_t GEMM_NC = 512; // columns of B per block
+
+    // C[R, 16] (+)= A[R, k] . B[k, 16] for one register tile, R <= 4
+    template <size_t R>
+    inline void _tile16(const float *A, size_t lda, const float *B, size_t ldb, float *C, size_t ldc,
+                        size_t k, bool accumulate)
+    {
+#ifdef NATIVE_GEMM_AVX2
+        __m256 c[R][2];
+        for (size_t r = 0; r < R; r++)
+        {
+            c[r][0] = accumulate ? _mm256_loadu_ps(C + r * ldc) : _mm256_setzero_ps();
+            c[r][1] = accumulate ? _mm256_loadu_ps(C + r * ldc + 8) : _mm256_setzero_ps();
+        }
+
+        for (size_t p = 0; p < k; p++)
+        {
+            const __m256 b0 = _mm256_loadu_ps(B + p * ldb);
+            const __m256 b1 = _mm256_loadu_ps(B + p * ldb + 8);
+            for (size_t r = 0; r < R; r++)
+            {
+                const __m256 a = _mm256_broadcast_ss(A + r * lda + p);
+                c[r][0] = _mm256_fmadd_ps(a, b0, c[r][0]);
+                c[r][1] = _mm256_fmadd_ps(a, b1, c[r][1]);
+            }
+        }
+
+        for (size_t r = 0; r < R; r++)
+        {
+            _mm256_storeu_ps(C + r * ldc, c[r][0]);
+            _mm256_storeu_ps(C + r * ldc + 8, c[r][1]);
+        }
+#else
+        float c[R][16];
+        for (size_t r = 0; r < R; r++)
+            for (size_t j = 0; j < 16; j++)
+                c[r][j] = accumulate ? C[r * ldc + j] : 0.0f;
+
+        for (size_t p = 0; p < k; p++)
+            for (size_t r = 0; r < R; r++)
+            {
+                const float a = A[r * lda + p];
+                for (size_t j = 0; j < 16; j++)
+                    c[r][j] += a * B[p * ldb + j];
+            }
+
+        for (size_t r = 0; r < R; r++)
+            for (size_t j = 0; j < 16; j++)
+                C[r * ldc + j] = c[r][j];
+#endif
+    }
+
+    // leftover columns (< 16) of a row block
+    inline void _tileTail(const float *A, size_t lda, const float *B, size_t ldb, float *C, size_t ldc,
+                          size_t rows, size_t cols, size_t k, bool accumulate)
+    {
+        for (size_t r = 0; r < rows; r++)
+        {
+            float *c = C + r * ldc;
+            if (!accumulate)
+                std::fill(c, c + cols, 0.0f);
+
+            for (size_t p = 0; p < k; p++)
+            {
+                const float a = A[r * lda + p];
+                const float *b = B + p * ldb;
+                for (size_t j = 0; j < cols; j++)
+                    c[j] += a * b[j];
+            }
+        }
+    }
+}
+
+void Native::gemmNN(const float *A, const float *B, const float *bias, float *C,
+                    size_t M, size_t N, size_t K, Activation act)
+{
+    for (size_t kk = 0; kk < K; kk += GEMM_KC)
+    {
+        const size_t kb = std::min(GEMM_KC, K - kk);
+        const bool accumulate = kk > 0;
+
+        for (size_t jj = 0; jj < N; jj += GEMM_NC)
+        {
+            const size_t nb = std::min(GEMM_NC, N - jj);
+            const float *Bb = B + kk * N + jj;
+
+            for (size_t i = 0; i < M; i += 4)
+            {
+                const size_t rows = std::min<size_t>(4, M - i);
+                const float *Ab = A + i * K + kk;
+                float *Cb = C + i * N + jj;
+
+                size_t j = 0;
+                for (; j + 16 <= nb; j += 16)
+                {
+                    switch (rows)
+                    {
+                    case 4:
+                        _tile16<4>(Ab, K, Bb + j, N, Cb + j, N, kb, accumulate);
+                        break;
+                    case 3:
+                        _tile16<3>(Ab, K, Bb + j, N, Cb + j, N, kb, accumulate);
+                        break;
+                    case 2:
+                        _tile16<2>(Ab, K, Bb + j, N, Cb + j, N, kb, accumulate);
+                        break;
+                    default:
+                        _tile16<1>(Ab, K, Bb + j, N, Cb + j, N, kb, accumulate);
+                        break;
+                    }
+                }
+
+                if (j < nb)
+                    _tileTail(Ab, K, Bb + j, N, Cb + j, N, rows, nb - j, kb, accumulate);
+            }
+        }
+    }
+
+    if (K == 0)
+        std::fill(C, C + M * N, 0.0f);
+
+    // epilogue: bias + activation while the rows are still warm
+    for (size_t i = 0; i < M; i++)
+    {
+        float *c = C + i * N;
+        if (bias)
+        {
+            const float bv = bias[i];
+            for (size_t j = 0; j < N; j++)
+                c[j] += bv;
+        }
+        activate(c, N, act);
+    }
+}
+
+void Native::im2col(const float *image, float *columns, size_t channels, size_t height, size_t width,
+                    size_t kh, size_t kw, size_t stride, size_t pad, size_t out_h, size_t out_w)
+{
+    for (size_t c = 0; c < channels; c++)
+    {
+        const float *plane = image + c * height * width;
+        for (size_t ky = 0; ky < kh; ky++)
+        {
+            for (size_t kx = 0; kx < kw; kx++)
+            {
+                float *col = columns + ((c * kh + ky) * kw + kx) * out_h * out_w;
+                for (size_t oy = 0; oy < out_h; oy++)
+                {
+                    const long y = static_cast<long>(oy * stride + ky) - static_cast<long>(pad);
+                    float *dst = col + oy * out_w;
+                    if (y < 0 || y >= static_cast<long>(height))
+                    {
+                        std::fill(dst, dst + out_w, 0.0f);
+                        continue;
+                    }
+
+                    const float *row = plane + y * width;
+                    if (pad == 0 && stride == 1)
+                    {
+                        std::copy(row + kx, row + kx + out_w, dst);
+                        continue;
+                    }
+
+                    for (size_t ox = 0; ox < out_w; ox++)
+                    {
+                        const long x = static_cast<long>(ox * stride + kx) - static_cast<long>(pad);
+                        dst[ox] = (x < 0 || x >= static_cast<long>(width)) ? 0.0f : row[x];
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef NATIVE_GEMM_HPP
+#define NATIVE_GEMM_HPP
+
+#include <cstddef>
+
+namespace Native
+{
+    enum class Activation : unsigned int
+    {
+        NONE = 0,
+        RELU = 1,
+        TANH = 2,
+        SIGMOID = 3,
+        SOFTMAX = 4, // only valid as a model output activation (row wise)
+    };
+
+    // applies an element wise activation in place (SOFTMAX is handled by softmaxRows)
+    void activate(float *x, size_t n, Activation act);
+
+    // row wise, numerically stable softmax of a (rows x cols) matrix, in place
+    void softmaxRows(float *x, size_t rows, size_t cols);
+
+    // dot product of two contiguous float vectors
+    float dot(const float *a, const float *b, size_t n);
+
+    // y[out] = act(W[out, in] . x[in] + bias[out])
+    // W is row major (torch nn.Linear layout), bias may be null
+    void gemv(const float *W, const float *x, const float *bias, float *y,
+              size_t out, size_t in, Activation act);
+
+    // Y[batch, out] = act(X[batch, in] . W[out, in]^T + bias[out])
+    // batched nn.Linear: processes 4 samples per weight row so each row is loaded once per block
+    void gemmNT(const float *X, const float *W, const float *bias, float *Y,
+                size_t batch, size_t out, size_t in, Activation act);
+
+    // C[M, N] = act(A[M, K] . B[K, N] + bias[M]), all row major and contiguous, bias may be null
+    // blocked over K / N with a 4x16 register tile, used for convolutions (A = filters, B = im2col)
+    void gemmNN(const float *A, const float *B, const float *bias, float *C,
+                size_t M, size_t N, size_t K, Activation act);
+
+    // unfolds a (channels, height, width) image into (channels * kh * kw, out_h * out_w) columns
+    // so a convolution becomes one gemmNN, zero padding outside the image
+    void im2col(const float *image, float *columns, size_t channels, size_t height, size_t width,
+                size_t kh, size_t kw, size_t stride, size_t pad, size_t out_h, size_t out_w);
+}
+
+#endif // NATIVE_GEMM_HPP
@@ -0,0 +1,40 @@
+#ifndef NATIVE_HASH_HPP
+#define NATIVE_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "counter_rng.hpp"
+
+namespace Native
+{
+    // 64 bit content hash for cache keys (observations, frames), not cryptographic.
+    // Four independent lanes of 8 byte words so a frame hashes at memory speed.
+    inline uint64_t hashBytes(const void *data, size_t size, uint64_t seed = 0)
+    {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        uint64_t lanes[4] = {seed ^ 0x9E3779B97F4A7C15ull, seed + 0xC2B2AE3D27D4EB4Full,
+                             seed ^ 0x165667B19E3779F9ull, seed + 0x27D4EB2F165667C5ull};
+
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            for (int l = 0; l < 4; l++)
+            {
+                uint64_t word;
+                std::memcpy(&word, bytes + i + 8 * l, 8);
+                lanes[l] = (lanes[l] ^ word) * 0xBF58476D1CE4E5B9ull;
+                lanes[l] ^= lanes[l] >> 29;
+            }
+        }
+
+        uint64_t h = mix64(lanes[0]) ^ mix64(lanes[1] + 1) ^ mix64(lanes[2] + 2) ^ mix64(lanes[3] + 3);
+        for (; i < size; i++)
+            h = (h ^ bytes[i]) * 0x100000001B3ull;
+
+        return mix64(h ^ size);
+    }
+}
+
+#endif // NATIVE_HASH_HPP
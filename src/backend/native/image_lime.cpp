@@ -0,0 +1,87 @@
+#include "image_lime.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "counter_rng.hpp"
+#include "linalg.hpp"
+#include "thread_pool.hpp"
+
+void Native::maskedBatch(const float *image, size_t planes, size_t pixels, const int32_t *labels,
+                         const uint8_t *samples, size_t count, size_t segments_count, float hide, float *out)
+{
+    const size_t size = planes * pixels;
+
+    ThreadPool::global().parallelFor(count, [&](size_t begin, size_t end, size_t)
+                                     {
+        for (size_t s = begin; s < end; s++)
+        {
+            const uint8_t *on = samples + s * segments_count;
+            float *dst = out + s * size;
+            for (size_t c = 0; c < planes; c++)
+            {
+                const float *src = image + c * pixels;
+                float *plane = dst + c * pixels;
+                // labels were validated against segments_count by the caller
+                for (size_t p = 0; p < pixels; p++)
+                    plane[p] = on[labels[p]] ? src[p] : hide;
+            }
+        } });
+}
+
+Native::ImageLime::ImageLime(const ImageLimeConfig &config)
+    : config_(config)
+{
+    if (config.samples < 2)
+        throw std::invalid_argument("ImageLime: needs at least two samples");
+}
+
+void Native::ImageLime::sample(size_t segments_count)
+{
+    if (segments_count == 0)
+        throw std::invalid_argument("ImageLime: no segments");
+
+    const size_t n = config_.samples;
+    const size_t k = segments_count;
+    const CounterRng rng(config_.seed, stream_++);
+
+    segments_ = k;
+    samples_.resize(n * k);
+    weights_.resize(n);
+
+    // 64 coin flips per draw
+    const size_t chunks = (k + 63) / 64;
+    for (size_t s = 0; s < n; s++)
+    {
+        uint8_t *row = samples_.data() + s * k;
+        for (size_t j = 0; j < k; j += 64)
+        {
+            const uint64_t bits = rng.bits(s * chunks + j / 64);
+            for (size_t b = 0; b < 64 && j + b < k; b++)
+                row[j + b] = static_cast<uint8_t>((bits >> b) & 1u);
+        }
+    }
+    std::fill(samples_.begin(), samples_.begin() + k, uint8_t(1));
+
+    // cosine distance of a 0/1 vector with s ones to the all ones vector is 1 - sqrt(s / k)
+    for (size_t s = 0; s < n; s++)
+    {
+        size_t on = 0;
+        for (size_t j = 0; j < k; j++)
+            on += samples_[s * k + j];
+        const float d = on ? 1.0f - std::sqrt(static_cast<float>(on) / k) : 1.0f;
+        weights_[s] = std::exp(-d * d / config_.kernel_width);
+    }
+}
+
+void Native::ImageLime::fit(const float *outputs, size_t outputs_count, float *coef, float *intercept) const
+{
+    if (segments_ == 0)
+        throw std::logic_error("ImageLime: fit() before sample()");
+
+    const std::vector<float> x(samples_.begin(), samples_.end());
+    if (!weightedRidge(x.data(), config_.samples, segments_, weights_.data(), outputs, outputs_count,
+                       config_.alpha, coef, intercept))
+        throw std::runtime_error("ImageLime: singular fit, alpha must be positive");
+}
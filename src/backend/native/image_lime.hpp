@@ -0,0 +1,55 @@
+#ifndef NATIVE_IMAGE_LIME_HPP
+#define NATIVE_IMAGE_LIME_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Native
+{
+    struct ImageLimeConfig
+    {
+        size_t samples = 1000;
+        float kernel_width = 0.25f; // exp(-d^2 / kernel_width) on the cosine distance, lime's default
+        double alpha = 1.0;         // ridge penalty
+        uint64_t seed = 0;
+    };
+
+    // Builds the perturbed batch (count, planes, h * w) from a planar image (planes, h * w):
+    // pixel p of sample s keeps its value if samples[s * segments_count + labels[p]] is set,
+    // otherwise it becomes hide. Samples are filled in parallel.
+    void maskedBatch(const float *image, size_t planes, size_t pixels, const int32_t *labels,
+                     const uint8_t *samples, size_t count, size_t segments_count, float hide, float *out);
+
+    // Image LIME over superpixels (what customLimeImage.CustomLimeImageExplainer does):
+    // random on/off segment vectors (row 0 = the original image), cosine distance kernel to
+    // the all on vector and a weighted ridge per output.
+    //
+    // Usage: sample() -> maskedBatch() -> evaluate once -> fit().
+    class ImageLime
+    {
+    public:
+        explicit ImageLime(const ImageLimeConfig &config = {});
+
+        // draws samples (samples, segments_count) with the next rng stream and their kernel weights
+        void sample(size_t segments_count);
+
+        size_t samples() const { return config_.samples; }
+        size_t segments() const { return segments_; }
+        const std::vector<uint8_t> &mask() const { return samples_; }
+        const std::vector<float> &weights() const { return weights_; }
+
+        // outputs (samples, outputs_count) -> coef (outputs_count, segments), intercept (outputs_count)
+        void fit(const float *outputs, size_t outputs_count, float *coef, float *intercept) const;
+
+    private:
+        ImageLimeConfig config_;
+        uint64_t stream_ = 0;
+        size_t segments_ = 0;
+
+        std::vector<uint8_t> samples_;
+        std::vector<float> weights_;
+    };
+}
+
+#endif // NATIVE_IMAGE_LIME_HPP
@@ -0,0 +1,124 @@
+#include "image_ops.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+void Native::rgbToGray(const uint8_t *rgb, uint8_t *gray, size_t pixels)
+{
+    constexpr uint32_t R = 4899, G = 9617, B = 1868; // 0.299, 0.587, 0.114 in Q14
+    constexpr uint32_t HALF = 1u << 13;
+
+    for (size_t i = 0; i < pixels; i++)
+    {
+        const uint8_t *p = rgb + i * 3;
+        gray[i] = static_cast<uint8_t>((p[0] * R + p[1] * G + p[2] * B + HALF) >> 14);
+    }
+}
+
+void Native::maxPool(const uint8_t *a, const uint8_t *b, uint8_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = a[i] > b[i] ? a[i] : b[i];
+    }
+}
+
+void Native::toUnitFloat(const uint8_t *in, float *out, size_t n)
+{
+    constexpr float scale = 1.0f / 255.0f;
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = static_cast<float>(in[i]) * scale;
+    }
+}
+
+Native::AreaResizer::AreaResizer(int src_h, int src_w, int dst_h, int dst_w, int channels)
+    : src_h_(src_h), src_w_(src_w), dst_h_(dst_h), dst_w_(dst_w), channels_(channels)
+{
+    if (src_h <= 0 || src_w <= 0 || dst_h <= 0 || dst_w <= 0 || channels <= 0)
+        throw std::invalid_argument("AreaResizer: sizes must be positive");
+
+    _buildTaps(src_w, dst_w, x_offsets_, x_taps_);
+    _buildTaps(src_h, dst_h, y_offsets_, y_taps_);
+
+    rows_.resize(static_cast<size_t>(src_h) * dst_w * channels);
+    acc_.resize(static_cast<size_t>(dst_w) * channels);
+}
+
+void Native::AreaResizer::_buildTaps(int src, int dst, std::vector<int> &offsets, std::vector<Tap> &taps)
+{
+    const double scale = static_cast<double>(src) / dst;
+
+    offsets.clear();
+    taps.clear();
+    offsets.reserve(dst + 1);
+
+    for (int i = 0; i < dst; i++)
+    {
+        offsets.push_back(static_cast<int>(taps.size()));
+
+        const double begin = i * scale;
+        const double end = std::min<double>((i + 1) * scale, src);
+        const double span = end - begin;
+
+        for (int j = static_cast<int>(std::floor(begin)); j < static_cast<int>(std::ceil(end)); j++)
+        {
+            const double overlap = std::min<double>(end, j + 1) - std::max<double>(begin, j);
+            if (overlap <= 1e-9)
+                continue;
+            taps.push_back({std::min(j, src - 1), static_cast<float>(overlap / span)});
+        }
+    }
+
+    offsets.push_back(static_cast<int>(taps.size()));
+}
+
+void Native::AreaResizer::resize(const uint8_t *src, uint8_t *dst)
+{
+    const int c = channels_;
+    const size_t row_out = static_cast<size_t>(dst_w_) * c;
+
+    // horizontal pass: every source row into dst_w columns
+    for (int y = 0; y < src_h_; y++)
+    {
+        const uint8_t *in = src + static_cast<size_t>(y) * src_w_ * c;
+        float *out = rows_.data() + y * row_out;
+
+        for (int x = 0; x < dst_w_; x++)
+        {
+            for (int k = 0; k < c; k++)
+            {
+                float sum = 0;
+                for (int t = x_offsets_[x]; t < x_offsets_[x + 1]; t++)
+                {
+                    sum += x_taps_[t].weight * in[x_taps_[t].index * c + k];
+                }
+                out[x * c + k] = sum;
+            }
+        }
+    }
+
+    // vertical pass: contiguous rows, so the inner loop vectorizes
+    for (int y = 0; y < dst_h_; y++)
+    {
+        std::fill(acc_.begin(), acc_.end(), 0.0f);
+
+        for (int t = y_offsets_[y]; t < y_offsets_[y + 1]; t++)
+        {
+            const float w = y_taps_[t].weight;
+            const float *row = rows_.data() + y_taps_[t].index * row_out;
+            for (size_t i = 0; i < row_out; i++)
+            {
+                acc_[i] += w * row[i];
+            }
+        }
+
+        uint8_t *out = dst + y * row_out;
+        for (size_t i = 0; i < row_out; i++)
+        {
+            const float v = acc_[i] + 0.5f;
+            out[i] = static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+        }
+    }
+}
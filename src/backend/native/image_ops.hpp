@@ -0,0 +1,62 @@
+#ifndef NATIVE_IMAGE_OPS_HPP
+#define NATIVE_IMAGE_OPS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Native
+{
+    // ITU-R BT.601 luma in fixed point, same weights / rounding as cv2.COLOR_RGB2GRAY
+    void rgbToGray(const uint8_t *rgb, uint8_t *gray, size_t pixels);
+
+    // out[i] = max(a[i], b[i]), out may alias a or b
+    void maxPool(const uint8_t *a, const uint8_t *b, uint8_t *out, size_t n);
+
+    // out[i] = in[i] / 255
+    void toUnitFloat(const uint8_t *in, float *out, size_t n);
+
+    // Area (box) resampling of an interleaved image, equivalent to cv2.INTER_AREA when shrinking.
+    // The separable weights are computed once per (src, dst) size, so resizing is two
+    // tight multiply-add passes with no allocation.
+    class AreaResizer
+    {
+    public:
+        AreaResizer() = default;
+        AreaResizer(int src_h, int src_w, int dst_h, int dst_w, int channels = 1);
+
+        void resize(const uint8_t *src, uint8_t *dst);
+
+        int srcHeight() const { return src_h_; }
+        int srcWidth() const { return src_w_; }
+        int dstHeight() const { return dst_h_; }
+        int dstWidth() const { return dst_w_; }
+        int channels() const { return channels_; }
+
+    private:
+        struct Tap
+        {
+            int index;
+            float weight;
+        };
+
+        // taps of output i are taps[offsets[i] .. offsets[i + 1])
+        static void _buildTaps(int src, int dst, std::vector<int> &offsets, std::vector<Tap> &taps);
+
+        int src_h_ = 0;
+        int src_w_ = 0;
+        int dst_h_ = 0;
+        int dst_w_ = 0;
+        int channels_ = 1;
+
+        std::vector<int> x_offsets_;
+        std::vector<Tap> x_taps_;
+        std::vector<int> y_offsets_;
+        std::vector<Tap> y_taps_;
+
+        std::vector<float> rows_; // horizontally resampled source rows (src_h x dst_w x channels)
+        std::vector<float> acc_;  // one output row accumulator (dst_w x channels)
+    };
+}
+
+#endif // NATIVE_IMAGE_OPS_HPP
@@ -0,0 +1,56 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "model.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+    // runs the model on a (inputShape) or (batch, inputShape) array, keeping the batch dim only if given
+    py::array_t<float> _forward(Native::Model &model, const py::array_t<float, py::array::c_style | py::array::forcecast> &input)
+    {
+        const size_t total = static_cast<size_t>(input.size());
+        if (total == 0 || total % model.inputSize() != 0)
+            throw std::invalid_argument("NativeModel: input of " + std::to_string(total) +
+                                        " values does not match input size " + std::to_string(model.inputSize()));
+
+        const size_t batch = total / model.inputSize();
+        const bool batched = static_cast<size_t>(input.ndim()) > model.inputShape().size();
+
+        std::vector<ssize_t> shape = {static_cast<ssize_t>(model.outputSize())};
+        if (batched)
+            shape.insert(shape.begin(), static_cast<ssize_t>(batch));
+
+        py::array_t<float> result(shape);
+        {
+            py::gil_scoped_release release;
+            const float *out = model.forward(input.data(), batch);
+            std::copy(out, out + batch * model.outputSize(), result.mutable_data());
+        }
+        return result;
+    }
+}
+
+PYBIND11_EMBEDDED_MODULE(pearl_infer, m)
+{
+    py::class_<Native::Model, std::shared_ptr<Native::Model>>(m, "NativeModel")
+        .def(py::init<const std::string &>(), py::arg("path"))
+        .def("forward", &_forward, py::arg("input"))
+        .def("__call__", &_forward, py::arg("input"))
+        .def_property_readonly("input_shape", &Native::Model::inputShape)
+        .def_property_readonly("input_size", &Native::Model::inputSize)
+        .def_property_readonly("output_size", &Native::Model::outputSize)
+        .def_property_readonly("input_scale", &Native::Model::inputScale)
+        .def("set_parallel", &Native::Model::setParallel, py::arg("parallel"))
+        .def_property_readonly("path", &Native::Model::path)
+        .def("__len__", [](const Native::Model &model)
+             { return model.layers().size(); });
+}
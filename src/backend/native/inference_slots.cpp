@@ -0,0 +1,73 @@
+#include "inference_slots.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+Native::SlotRegion::SlotRegion(const std::string &name, uint32_t slots, uint32_t obs_size) : name_(name)
+{
+    if (slots == 0 || obs_size == 0)
+        throw std::invalid_argument("SlotRegion: slots and obs_size must be positive");
+
+    const size_t stride = (sizeof(SlotHeader) + static_cast<size_t>(obs_size) * sizeof(float) + 63) / 64 * 64;
+    size_ = sizeof(RegionHeader) + stride * slots;
+
+    const std::string path = "/" + name;
+    fd_ = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd_ < 0)
+        throw std::runtime_error("SlotRegion: shm_open(" + path + ") failed: " + std::strerror(errno));
+
+    if (ftruncate(fd_, static_cast<off_t>(size_)) != 0)
+    {
+        const int err = errno;
+        close(fd_);
+        shm_unlink(path.c_str());
+        throw std::runtime_error("SlotRegion: ftruncate failed: " + std::string(std::strerror(err)));
+    }
+
+    void *mapped = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED)
+    {
+        const int err = errno;
+        close(fd_);
+        shm_unlink(path.c_str());
+        throw std::runtime_error("SlotRegion: mmap failed: " + std::string(std::strerror(err)));
+    }
+
+    // fresh object, ftruncate zero filled it
+    base_ = static_cast<uint8_t *>(mapped);
+    header_ = new (base_) RegionHeader{};
+    std::memcpy(header_->magic, "PRLS", 4);
+    header_->version = VERSION;
+    header_->slots = slots;
+    header_->obs_size = obs_size;
+    header_->slot_stride = static_cast<uint32_t>(stride);
+    header_->header_size = sizeof(RegionHeader);
+    header_->shutdown.store(0);
+
+    for (uint32_t i = 0; i < slots; i++)
+    {
+        new (_slotBase(i)) SlotHeader{};
+    }
+}
+
+Native::SlotRegion::~SlotRegion()
+{
+    if (base_)
+        munmap(base_, size_);
+    if (fd_ >= 0)
+        close(fd_);
+    shm_unlink(("/" + name_).c_str());
+}
+
+void Native::SlotRegion::respond(uint32_t i, int32_t action)
+{
+    SlotHeader &s = slot(i);
+    s.action = action;
+    s.state.store(static_cast<uint32_t>(SlotState::RESPONSE), std::memory_order_release);
+}
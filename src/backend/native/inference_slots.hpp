@@ -0,0 +1,91 @@
+#ifndef NATIVE_INFERENCE_SLOTS_HPP
+#define NATIVE_INFERENCE_SLOTS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Native
+{
+    // Shared memory exchange between the inference server (the lab) and env worker processes,
+    // one slot per env. pearl/serving/worker.py maps the same layout with numpy:
+    //
+    //   RegionHeader                       64 bytes
+    //   slot i at header_size + i * slot_stride:
+    //     SlotHeader                       64 bytes
+    //     f32 observation[obs_size]
+    //
+    // A worker writes the observation, then stores REQUEST in state. The server reads it, writes
+    // action and stores RESPONSE. x86 keeps stores in order, so plain numpy stores on the worker side
+    // are enough; the server uses acquire / release.
+    enum class SlotState : uint32_t
+    {
+        IDLE = 0,
+        REQUEST = 1,
+        RESPONSE = 2,
+        CLOSED = 3, // the worker is gone
+    };
+
+    struct alignas(64) RegionHeader
+    {
+        char magic[4]; // "PRLS"
+        uint32_t version;
+        uint32_t slots;
+        uint32_t obs_size;    // floats per observation
+        uint32_t slot_stride; // bytes
+        uint32_t header_size; // bytes before slot 0
+        std::atomic<uint32_t> shutdown;
+    };
+
+    struct alignas(64) SlotHeader
+    {
+        std::atomic<uint32_t> state;
+        uint32_t seq;      // request counter of this slot
+        int32_t action;    // server -> worker
+        uint32_t episodes; // worker -> server, finished episodes
+        uint64_t sent_ns;  // CLOCK_MONOTONIC of the request (time.monotonic_ns())
+        uint64_t steps;    // worker -> server, env steps so far
+        float last_return; // worker -> server, return of the last finished episode
+    };
+
+    static_assert(sizeof(RegionHeader) == 64 && sizeof(SlotHeader) == 64, "layout shared with python");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "slot state must be a plain u32");
+
+    // Owns (creates and unlinks) the POSIX shared memory object
+    class SlotRegion
+    {
+    public:
+        static constexpr uint32_t VERSION = 1;
+
+        // name without the leading '/', throws std::runtime_error if it can't be created
+        SlotRegion(const std::string &name, uint32_t slots, uint32_t obs_size);
+        ~SlotRegion();
+
+        SlotRegion(const SlotRegion &) = delete;
+        SlotRegion &operator=(const SlotRegion &) = delete;
+
+        const std::string &name() const { return name_; }
+        uint32_t slots() const { return header_->slots; }
+        uint32_t obsSize() const { return header_->obs_size; }
+
+        SlotHeader &slot(uint32_t i) { return *reinterpret_cast<SlotHeader *>(_slotBase(i)); }
+        const float *observation(uint32_t i) { return reinterpret_cast<const float *>(_slotBase(i) + sizeof(SlotHeader)); }
+
+        SlotState state(uint32_t i) { return static_cast<SlotState>(slot(i).state.load(std::memory_order_acquire)); }
+        void respond(uint32_t i, int32_t action);
+
+        void requestShutdown() { header_->shutdown.store(1, std::memory_order_release); }
+
+    private:
+        uint8_t *_slotBase(uint32_t i) { return base_ + header_->header_size + static_cast<size_t>(i) * header_->slot_stride; }
+
+        std::string name_;
+        int fd_ = -1;
+        size_t size_ = 0;
+        uint8_t *base_ = nullptr;
+        RegionHeader *header_ = nullptr;
+    };
+}
+
+#endif // NATIVE_INFERENCE_SLOTS_HPP
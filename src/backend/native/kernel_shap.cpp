@@ -0,0 +1,247 @@
+#include "kernel_shap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "linalg.hpp"
+#include "thread_pool.hpp"
+
+namespace
+{
+    // log C(n, k)
+    double _logChoose(size_t n, size_t k)
+    {
+        return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+    }
+}
+
+Native::KernelShap::KernelShap(size_t features, const KernelShapConfig &config)
+    : features_(features), config_(config), rng_(config.seed)
+{
+    if (features == 0)
+        throw std::invalid_argument("KernelShap: no features");
+
+    if (config_.samples == 0)
+        config_.samples = 2 * features + 2048;
+}
+
+void Native::KernelShap::sample()
+{
+    masks_.clear();
+    weights_.clear();
+
+    // a single feature gets everything through the efficiency constraint
+    if (features_ == 1)
+    {
+        exact_ = true;
+        return;
+    }
+
+    const bool fits = features_ < 31 && ((size_t(1) << features_) - 2) <= config_.samples;
+    exact_ = fits;
+    if (fits)
+        _enumerate();
+    else
+        _draw();
+}
+
+void Native::KernelShap::_enumerate()
+{
+    const size_t M = features_;
+    const size_t count = (size_t(1) << M) - 2;
+
+    masks_.resize(count * M);
+    weights_.resize(count);
+
+    for (size_t c = 0; c < count; c++)
+    {
+        const size_t bits = c + 1;
+        uint8_t *mask = masks_.data() + c * M;
+        size_t s = 0;
+        for (size_t j = 0; j < M; j++)
+        {
+            mask[j] = (bits >> j) & 1;
+            s += mask[j];
+        }
+
+        // Shapley kernel: (M - 1) / (C(M, s) s (M - s))
+        weights_[c] = (M - 1.0) / (std::exp(_logChoose(M, s)) * s * (M - s));
+    }
+}
+
+void Native::KernelShap::_draw()
+{
+    const size_t M = features_;
+
+    // size distribution of the kernel, symmetric in s <-> M - s
+    std::vector<double> size_mass(M - 1);
+    for (size_t s = 1; s < M; s++)
+        size_mass[s - 1] = 1.0 / (s * (M - s));
+    std::discrete_distribution<size_t> size_dist(size_mass.begin(), size_mass.end());
+
+    std::vector<size_t> order(M);
+    std::iota(order.begin(), order.end(), 0);
+
+    std::unordered_map<std::string, size_t> seen;
+    std::string key(M, '\0');
+
+    auto add = [&](const std::string &mask)
+    {
+        auto it = seen.find(mask);
+        if (it != seen.end())
+        {
+            weights_[it->second] += 1.0;
+            return;
+        }
+        seen.emplace(mask, weights_.size());
+        masks_.insert(masks_.end(), mask.begin(), mask.end());
+        weights_.push_back(1.0);
+    };
+
+    const size_t draws = config_.paired ? (config_.samples + 1) / 2 : config_.samples;
+    for (size_t d = 0; d < draws; d++)
+    {
+        const size_t s = size_dist(rng_) + 1;
+
+        // partial Fisher-Yates, the first s indices become the coalition
+        for (size_t i = 0; i < s; i++)
+        {
+            std::uniform_int_distribution<size_t> pick(i, M - 1);
+            std::swap(order[i], order[pick(rng_)]);
+        }
+
+        std::fill(key.begin(), key.end(), '\0');
+        for (size_t i = 0; i < s; i++)
+            key[order[i]] = 1;
+        add(key);
+
+        if (config_.paired)
+        {
+            for (auto &k : key)
+                k = k ? 0 : 1;
+            add(key);
+        }
+    }
+}
+
+void Native::KernelShap::fillBatch(const float *x, const float *background, size_t background_rows, float *batch) const
+{
+    const size_t M = features_;
+    std::copy(x, x + M, batch);
+    std::copy(background, background + background_rows * M, batch + M);
+
+    float *rows = batch + (1 + background_rows) * M;
+    ThreadPool::global().parallelFor(coalitions(), [&](size_t begin, size_t end, size_t)
+                                     {
+        for (size_t c = begin; c < end; c++)
+        {
+            const uint8_t *mask = masks_.data() + c * M;
+            for (size_t b = 0; b < background_rows; b++)
+            {
+                const float *bg = background + b * M;
+                float *row = rows + (c * background_rows + b) * M;
+                for (size_t j = 0; j < M; j++)
+                    row[j] = mask[j] ? x[j] : bg[j];
+            }
+        } });
+}
+
+void Native::KernelShap::solve(const float *outputs, size_t background_rows, size_t actions,
+                               float *phi, float *base, float *fx) const
+{
+    const size_t M = features_;
+    const size_t S = coalitions();
+    const size_t B = std::max<size_t>(1, background_rows);
+
+    // f(x) and E[f(background)]
+    std::vector<double> delta(actions);
+    for (size_t a = 0; a < actions; a++)
+    {
+        double mean = 0;
+        for (size_t b = 0; b < background_rows; b++)
+            mean += outputs[(1 + b) * actions + a];
+        mean /= B;
+
+        fx[a] = outputs[a];
+        base[a] = static_cast<float>(mean);
+        delta[a] = outputs[a] - mean;
+    }
+
+    if (M == 1 || S == 0)
+    {
+        for (size_t a = 0; a < actions; a++)
+        {
+            std::fill(phi + a * M, phi + (a + 1) * M, 0.0f);
+            phi[a * M + M - 1] = static_cast<float>(delta[a]);
+        }
+        return;
+    }
+
+    // y'[s, a] = E_b[f(z_s)] - base - z_last * delta, x'[s, j] = z_j - z_last
+    const size_t P = M - 1;
+    std::vector<double> y(S * actions);
+    const float *coalition_out = outputs + (1 + background_rows) * actions;
+    for (size_t s = 0; s < S; s++)
+    {
+        const double last = masks_[s * M + P];
+        for (size_t a = 0; a < actions; a++)
+        {
+            double mean = 0;
+            for (size_t b = 0; b < background_rows; b++)
+                mean += coalition_out[(s * background_rows + b) * actions + a];
+            y[s * actions + a] = mean / B - base[a] - last * delta[a];
+        }
+    }
+
+    // normal equations, shared by every action
+    std::vector<double> gram(P * P, 0.0);
+    std::vector<double> rhs(actions * P, 0.0);
+    ThreadPool &pool = ThreadPool::global();
+
+    pool.parallelFor(P, [&](size_t begin, size_t end, size_t)
+                     {
+        for (size_t i = begin; i < end; i++)
+        {
+            for (size_t s = 0; s < S; s++)
+            {
+                const uint8_t *z = masks_.data() + s * M;
+                const double xi = double(z[i]) - z[P];
+                if (xi == 0)
+                    continue;
+
+                const double w = weights_[s] * xi;
+                for (size_t j = 0; j <= i; j++)
+                    gram[i * P + j] += w * (double(z[j]) - z[P]);
+                for (size_t a = 0; a < actions; a++)
+                    rhs[a * P + i] += w * y[s * actions + a];
+            }
+        } });
+
+    for (size_t i = 0; i < P; i++)
+        for (size_t j = 0; j < i; j++)
+            gram[j * P + i] = gram[i * P + j];
+
+    addRidge(gram.data(), P, config_.ridge);
+    if (!choleskyFactor(gram.data(), P))
+        throw std::runtime_error("KernelShap: singular system, increase the number of samples");
+
+    pool.parallelFor(actions, [&](size_t begin, size_t end, size_t)
+                     {
+        for (size_t a = begin; a < end; a++)
+        {
+            double *r = rhs.data() + a * P;
+            choleskySolve(gram.data(), P, r);
+
+            double sum = 0;
+            for (size_t j = 0; j < P; j++)
+            {
+                phi[a * M + j] = static_cast<float>(r[j]);
+                sum += r[j];
+            }
+            phi[a * M + P] = static_cast<float>(delta[a] - sum);
+        } });
+}
@@ -0,0 +1,69 @@
+#ifndef NATIVE_KERNEL_SHAP_HPP
+#define NATIVE_KERNEL_SHAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace Native
+{
+    struct KernelShapConfig
+    {
+        size_t samples = 0;  // coalitions to evaluate, 0 = 2 * features + 2048 (shap's default)
+        bool paired = true;  // also evaluate the complement of every sampled coalition
+        uint64_t seed = 0;
+        double ridge = 1e-8; // relative to the mean diagonal of the normal equations
+    };
+
+    // KernelSHAP (Lundberg & Lee 2017) for a model with several outputs (one per action).
+    //
+    // Usage: sample() -> fillBatch() -> evaluate the batch once -> solve().
+    // Coalitions are enumerated exactly with their Shapley kernel weights when all 2^M - 2 of
+    // them fit the budget, otherwise sizes are drawn from the kernel distribution
+    // (p(s) ~ (M - 1) / (s (M - s))), duplicates merged into weights.
+    // The efficiency constraint sum(phi) = f(x) - E[f(background)] is enforced exactly by
+    // eliminating the last feature, and all actions share one factorization.
+    class KernelShap
+    {
+    public:
+        KernelShap(size_t features, const KernelShapConfig &config = {});
+
+        // draws a new set of coalitions
+        void sample();
+
+        size_t features() const { return features_; }
+        size_t coalitions() const { return weights_.size(); }
+        bool exact() const { return exact_; }
+
+        // (coalitions, features), 1 = feature taken from x
+        const uint8_t *masks() const { return masks_.data(); }
+        const double *weights() const { return weights_.data(); }
+
+        // rows of the evaluation batch: x, then the background rows, then every coalition
+        // combined with every background row
+        size_t batchRows(size_t background_rows) const { return 1 + background_rows * (1 + coalitions()); }
+
+        // x (features), background (background_rows, features), batch (batchRows, features)
+        void fillBatch(const float *x, const float *background, size_t background_rows, float *batch) const;
+
+        // outputs (batchRows, actions) -> phi (actions, features), base / fx (actions)
+        // base is the expected output over the background, fx the output for x
+        void solve(const float *outputs, size_t background_rows, size_t actions,
+                   float *phi, float *base, float *fx) const;
+
+    private:
+        void _enumerate();
+        void _draw();
+
+        size_t features_;
+        KernelShapConfig config_;
+        std::mt19937_64 rng_;
+        bool exact_ = false;
+
+        std::vector<uint8_t> masks_;
+        std::vector<double> weights_;
+    };
+}
+
+#endif // NATIVE_KERNEL_SHAP_HPP
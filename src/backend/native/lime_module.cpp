@@ -0,0 +1,126 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "lime_tabular.hpp"
+
+namespace py = pybind11;
+
+using FloatArray = py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+// Python facing tabular LIME: perturb / one predict_fn call / fit for every output at once
+class TabularExplainer
+{
+public:
+    TabularExplainer(size_t features, size_t samples, float noise_scale, float kernel_width, double alpha, uint64_t seed)
+        : lime_(features, Native::LimeTabularConfig{samples, noise_scale, kernel_width, alpha, seed})
+    {
+    }
+
+    // returns {"coef": (outputs, features), "intercept": (outputs,), "samples": (samples, features), "weights": (samples,)}
+    py::dict explain(const FloatArray &x, const py::function &predict_fn)
+    {
+        const size_t d = lime_.features();
+        if (static_cast<size_t>(x.size()) != d)
+            throw std::invalid_argument("TabularExplainer: expected " + std::to_string(d) + " features, got " +
+                                        std::to_string(x.size()));
+
+        const ssize_t rows = static_cast<ssize_t>(lime_.samples());
+        py::array_t<float> batch({rows, static_cast<ssize_t>(d)});
+        {
+            py::gil_scoped_release release;
+            lime_.perturb(x.data(), batch.mutable_data());
+        }
+
+        FloatArray preds = FloatArray::ensure(predict_fn(batch));
+        if (!preds || preds.ndim() == 0 || preds.shape(0) != rows)
+            throw std::runtime_error("TabularExplainer: predict_fn must return one row per sample");
+        const size_t outputs = static_cast<size_t>(preds.size()) / lime_.samples();
+
+        py::array_t<float> coef({static_cast<ssize_t>(outputs), static_cast<ssize_t>(d)});
+        py::array_t<float> intercept(static_cast<ssize_t>(outputs));
+        {
+            py::gil_scoped_release release;
+            lime_.fit(batch.data(), preds.data(), outputs, coef.mutable_data(), intercept.mutable_data());
+        }
+
+        const auto &w = lime_.weights();
+        py::dict result;
+        result["coef"] = coef;
+        result["intercept"] = intercept;
+        result["samples"] = batch;
+        result["weights"] = py::array_t<float>(static_cast<ssize_t>(w.size()), w.data());
+        return result;
+    }
+
+    // the first half of explain(), for callers that batch predict_fn over several explainers:
+    // returns {"samples": (samples, features), "weights": (samples,)} from the next rng stream
+    py::dict perturb(const FloatArray &x)
+    {
+        const size_t d = lime_.features();
+        if (static_cast<size_t>(x.size()) != d)
+            throw std::invalid_argument("TabularExplainer: expected " + std::to_string(d) + " features, got " +
+                                        std::to_string(x.size()));
+
+        const ssize_t rows = static_cast<ssize_t>(lime_.samples());
+        py::array_t<float> batch({rows, static_cast<ssize_t>(d)});
+        py::array_t<float> weights(rows);
+        {
+            py::gil_scoped_release release;
+            lime_.perturb(x.data(), 1, batch.mutable_data(), weights.mutable_data());
+        }
+
+        py::dict result;
+        result["samples"] = batch;
+        result["weights"] = weights;
+        return result;
+    }
+
+    // the second half: perturb()'s samples and weights plus predict_fn's (samples, outputs)
+    // returns {"coef": (outputs, features), "intercept": (outputs,)}
+    py::dict fit(const FloatArray &samples, const FloatArray &weights, const FloatArray &preds)
+    {
+        const size_t d = lime_.features();
+        const size_t n = lime_.samples();
+        if (static_cast<size_t>(samples.size()) != n * d || static_cast<size_t>(weights.size()) != n)
+            throw std::invalid_argument("TabularExplainer: samples and weights must come from perturb()");
+        if (preds.ndim() == 0 || preds.size() == 0 || static_cast<size_t>(preds.size()) % n != 0)
+            throw std::runtime_error("TabularExplainer: predict_fn must return one row per sample");
+        const size_t outputs = static_cast<size_t>(preds.size()) / n;
+
+        py::array_t<float> coef({static_cast<ssize_t>(outputs), static_cast<ssize_t>(d)});
+        py::array_t<float> intercept(static_cast<ssize_t>(outputs));
+        {
+            py::gil_scoped_release release;
+            lime_.fit(samples.data(), weights.data(), preds.data(), outputs, coef.mutable_data(), intercept.mutable_data());
+        }
+
+        py::dict result;
+        result["coef"] = coef;
+        result["intercept"] = intercept;
+        return result;
+    }
+
+    size_t features() const { return lime_.features(); }
+    size_t samples() const { return lime_.samples(); }
+
+private:
+    Native::LimeTabular lime_;
+};
+
+PYBIND11_EMBEDDED_MODULE(pearl_lime, m)
+{
+    py::class_<TabularExplainer>(m, "TabularExplainer")
+        .def(py::init<size_t, size_t, float, float, double, uint64_t>(),
+             py::arg("features"), py::arg("samples") = 5000, py::arg("noise_scale") = 0.1f,
+             py::arg("kernel_width") = 0.0f, py::arg("alpha") = 1.0, py::arg("seed") = 0)
+        .def("explain", &TabularExplainer::explain, py::arg("x"), py::arg("predict_fn"))
+        .def("perturb", &TabularExplainer::perturb, py::arg("x"))
+        .def("fit", &TabularExplainer::fit, py::arg("samples"), py::arg("weights"), py::arg("preds"))
+        .def_property_readonly("features", &TabularExplainer::features)
+        .def_property_readonly("samples", &TabularExplainer::samples);
+}
@@ -0,0 +1,104 @@
+#include "lime_tabular.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "counter_rng.hpp"
+#include "linalg.hpp"
+#include "thread_pool.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define NATIVE_LIME_AVX2 1
+#endif
+
+void Native::squaredDistances(const float *rows, const float *ref, float *out, size_t count, size_t n)
+{
+    for (size_t r = 0; r < count; r++)
+    {
+        const float *row = rows + r * n;
+        size_t j = 0;
+        float sum = 0;
+
+#ifdef NATIVE_LIME_AVX2
+        __m256 acc = _mm256_setzero_ps();
+        for (; j + 8 <= n; j += 8)
+        {
+            const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(row + j), _mm256_loadu_ps(ref + j));
+            acc = _mm256_fmadd_ps(d, d, acc);
+        }
+        __m128 lo = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+        lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 0x55));
+        sum = _mm_cvtss_f32(lo);
+#endif
+
+        for (; j < n; j++)
+        {
+            const float d = row[j] - ref[j];
+            sum += d * d;
+        }
+        out[r] = sum;
+    }
+}
+
+Native::LimeTabular::LimeTabular(size_t features, const LimeTabularConfig &config)
+    : features_(features), config_(config)
+{
+    if (features == 0 || config.samples == 0)
+        throw std::invalid_argument("LimeTabular: needs at least one feature and one sample");
+
+    if (config_.kernel_width <= 0)
+        config_.kernel_width = 0.75f * std::sqrt(static_cast<float>(features));
+
+    weights_.resize(config_.samples);
+}
+
+void Native::LimeTabular::perturb(const float *x, float *batch)
+{
+    perturb(x, 1, batch, weights_.data());
+}
+
+void Native::LimeTabular::perturb(const float *X, size_t count, float *batch, float *weights)
+{
+    const size_t d = features_;
+    const size_t n = config_.samples;
+    const size_t pairs = (d + 1) / 2;
+    const CounterRng rng(config_.seed, stream_++);
+    const float scale = config_.noise_scale;
+    const float inv_width2 = 1.0f / (config_.kernel_width * config_.kernel_width);
+
+    // rows of every instance in one parallel loop, row r belongs to instance r / n
+    ThreadPool::global().parallelFor(count * n, [&](size_t begin, size_t end, size_t)
+                                     {
+        for (size_t r = begin; r < end; r++)
+        {
+            const float *x = X + (r / n) * d;
+            float *row = batch + r * d;
+            for (size_t p = 0; p < pairs; p++)
+            {
+                float a, b;
+                rng.normalPair(r * pairs + p, a, b);
+                row[2 * p] = x[2 * p] + scale * a;
+                if (2 * p + 1 < d)
+                    row[2 * p + 1] = x[2 * p + 1] + scale * b;
+            }
+
+            squaredDistances(row, x, &weights[r], 1, d);
+            weights[r] = std::exp(-weights[r] * inv_width2);
+        } });
+}
+
+void Native::LimeTabular::fit(const float *batch, const float *outputs, size_t outputs_count,
+                              float *coef, float *intercept) const
+{
+    fit(batch, weights_.data(), outputs, outputs_count, coef, intercept);
+}
+
+void Native::LimeTabular::fit(const float *batch, const float *weights, const float *outputs, size_t outputs_count,
+                              float *coef, float *intercept) const
+{
+    if (!weightedRidge(batch, config_.samples, features_, weights, outputs, outputs_count,
+                       config_.alpha, coef, intercept))
+        throw std::runtime_error("LimeTabular: singular fit, all kernel weights are zero or alpha is not positive");
+}
@@ -0,0 +1,61 @@
+#ifndef NATIVE_LIME_TABULAR_HPP
+#define NATIVE_LIME_TABULAR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Native
+{
+    struct LimeTabularConfig
+    {
+        size_t samples = 5000;
+        float noise_scale = 0.1f;  // perturbation = x + noise_scale * N(0, 1)
+        float kernel_width = 0.0f; // 0 = 0.75 * sqrt(features)
+        double alpha = 1.0;        // ridge penalty, same meaning as sklearn's Ridge(alpha)
+        uint64_t seed = 0;
+    };
+
+    // squared euclidean distance of every (rows, n) row to ref
+    void squaredDistances(const float *rows, const float *ref, float *out, size_t count, size_t n);
+
+    // Tabular LIME without a background dataset (what customLime.CustomLimeTabularExplainer does):
+    // gaussian perturbations around x, exponential kernel on the distance to x and a weighted
+    // ridge with intercept per output. Every output is fitted from one factorization.
+    //
+    // Usage: perturb() -> evaluate the batch once -> fit().
+    class LimeTabular
+    {
+    public:
+        LimeTabular(size_t features, const LimeTabularConfig &config = {});
+
+        size_t features() const { return features_; }
+        size_t samples() const { return config_.samples; }
+
+        // fills batch (samples, features) around x with the next rng stream and computes the kernel weights
+        void perturb(const float *x, float *batch);
+
+        // same for several instances at once (explaining many agents per tick):
+        // X (count, features) -> batch (count, samples, features), weights (count, samples)
+        void perturb(const float *X, size_t count, float *batch, float *weights);
+
+        const std::vector<float> &weights() const { return weights_; }
+
+        // outputs (samples, outputs) of the perturbed batch -> coef (outputs, features), intercept (outputs)
+        // sklearn Ridge(alpha, fit_intercept=True).fit(batch, y, sample_weight=weights), in double (see weightedRidge)
+        void fit(const float *batch, const float *outputs, size_t outputs_count, float *coef, float *intercept) const;
+
+        // fit with explicit kernel weights (samples), for batches from the multi instance perturb
+        void fit(const float *batch, const float *weights, const float *outputs, size_t outputs_count,
+                 float *coef, float *intercept) const;
+
+    private:
+        size_t features_;
+        LimeTabularConfig config_;
+        uint64_t stream_ = 0;
+
+        std::vector<float> weights_;
+    };
+}
+
+#endif // NATIVE_LIME_TABULAR_HPP
@@ -0,0 +1,182 @@
+#include "linalg.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // contiguous double dot product, 4 partial sums so the compiler can keep it in vector registers
+    inline double _dot(const double *a, const double *b, size_t n)
+    {
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        size_t k = 0;
+        for (; k + 4 <= n; k += 4)
+        {
+            s0 += a[k] * b[k];
+            s1 += a[k + 1] * b[k + 1];
+            s2 += a[k + 2] * b[k + 2];
+            s3 += a[k + 3] * b[k + 3];
+        }
+        for (; k < n; k++)
+            s0 += a[k] * b[k];
+        return (s0 + s1) + (s2 + s3);
+    }
+}
+
+bool Native::choleskyFactor(double *A, size_t n)
+{
+    for (size_t j = 0; j < n; j++)
+    {
+        const double *row_j = A + j * n;
+        double d = A[j * n + j] - _dot(row_j, row_j, j);
+
+        if (!(d > 0))
+            return false;
+
+        d = std::sqrt(d);
+        A[j * n + j] = d;
+
+        for (size_t i = j + 1; i < n; i++)
+        {
+            A[i * n + j] = (A[i * n + j] - _dot(A + i * n, row_j, j)) / d;
+        }
+    }
+    return true;
+}
+
+void Native::choleskySolve(const double *L, size_t n, double *b)
+{
+    // L y = b
+    for (size_t i = 0; i < n; i++)
+    {
+        double v = b[i];
+        for (size_t k = 0; k < i; k++)
+            v -= L[i * n + k] * b[k];
+        b[i] = v / L[i * n + i];
+    }
+
+    // L^T x = y
+    for (size_t i = n; i-- > 0;)
+    {
+        double v = b[i];
+        for (size_t k = i + 1; k < n; k++)
+            v -= L[k * n + i] * b[k];
+        b[i] = v / L[i * n + i];
+    }
+}
+
+void Native::addRidge(double *A, size_t n, double lambda)
+{
+    if (n == 0 || lambda <= 0)
+        return;
+
+    double trace = 0;
+    for (size_t i = 0; i < n; i++)
+        trace += A[i * n + i];
+
+    const double ridge = lambda * (trace > 0 ? trace / n : 1.0);
+    for (size_t i = 0; i < n; i++)
+        A[i * n + i] += ridge;
+}
+
+bool Native::weightedRidge(const float *X, size_t rows, size_t cols, const float *weights,
+                           const float *Y, size_t outputs, double alpha, float *coef, float *intercept)
+{
+    // weighted means, sklearn centers with the sample weights
+    double weight_sum = 0;
+    std::vector<double> x_mean(cols, 0.0), y_mean(outputs, 0.0);
+    for (size_t s = 0; s < rows; s++)
+    {
+        const double w = weights[s];
+        weight_sum += w;
+        for (size_t j = 0; j < cols; j++)
+            x_mean[j] += w * X[s * cols + j];
+        for (size_t a = 0; a < outputs; a++)
+            y_mean[a] += w * Y[s * outputs + a];
+    }
+
+    if (!(weight_sum > 0))
+        return false;
+
+    for (auto &v : x_mean)
+        v /= weight_sum;
+    for (auto &v : y_mean)
+        v /= weight_sum;
+
+    // sqrt(w) scaled, centered data in double, transposed so every product below is a row dot.
+    // The grams and right hand sides are accumulated in double like sklearn's float64 fit,
+    // float sums over thousands of samples would drift from it
+    std::vector<double> xt(cols * rows), yt(outputs * rows);
+    for (size_t s = 0; s < rows; s++)
+    {
+        const double sw = std::sqrt(static_cast<double>(weights[s]));
+        for (size_t j = 0; j < cols; j++)
+            xt[j * rows + s] = sw * (X[s * cols + j] - x_mean[j]);
+        for (size_t a = 0; a < outputs; a++)
+            yt[a * rows + s] = sw * (Y[s * outputs + a] - y_mean[a]);
+    }
+
+    std::vector<double> system;
+    std::vector<double> rhs;
+
+    if (cols <= rows)
+    {
+        // primal: (Xs^T Xs + alpha I) coef = Xs^T ys
+        system.resize(cols * cols);
+        for (size_t i = 0; i < cols; i++)
+            for (size_t j = 0; j <= i; j++)
+                system[i * cols + j] = system[j * cols + i] = _dot(xt.data() + i * rows, xt.data() + j * rows, rows);
+        for (size_t i = 0; i < cols; i++)
+            system[i * cols + i] += alpha;
+
+        if (!choleskyFactor(system.data(), cols))
+            return false;
+
+        rhs.resize(outputs * cols);
+        for (size_t a = 0; a < outputs; a++)
+            for (size_t j = 0; j < cols; j++)
+                rhs[a * cols + j] = _dot(yt.data() + a * rows, xt.data() + j * rows, rows);
+
+        for (size_t a = 0; a < outputs; a++)
+        {
+            choleskySolve(system.data(), cols, rhs.data() + a * cols);
+            for (size_t j = 0; j < cols; j++)
+                coef[a * cols + j] = static_cast<float>(rhs[a * cols + j]);
+        }
+    }
+    else
+    {
+        // dual: coef = Xs^T (Xs Xs^T + alpha I)^-1 ys, rows x rows is the smaller system
+        std::vector<double> xs(rows * cols);
+        for (size_t j = 0; j < cols; j++)
+            for (size_t s = 0; s < rows; s++)
+                xs[s * cols + j] = xt[j * rows + s];
+
+        system.resize(rows * rows);
+        for (size_t i = 0; i < rows; i++)
+            for (size_t k = 0; k <= i; k++)
+                system[i * rows + k] = system[k * rows + i] = _dot(xs.data() + i * cols, xs.data() + k * cols, cols);
+        for (size_t i = 0; i < rows; i++)
+            system[i * rows + i] += alpha;
+
+        if (!choleskyFactor(system.data(), rows))
+            return false;
+
+        rhs = yt;
+        for (size_t a = 0; a < outputs; a++)
+        {
+            choleskySolve(system.data(), rows, rhs.data() + a * rows);
+            for (size_t j = 0; j < cols; j++)
+                coef[a * cols + j] = static_cast<float>(_dot(rhs.data() + a * rows, xt.data() + j * rows, rows));
+        }
+    }
+
+    for (size_t a = 0; a < outputs; a++)
+    {
+        double offset = y_mean[a];
+        for (size_t j = 0; j < cols; j++)
+            offset -= x_mean[j] * coef[a * cols + j];
+        intercept[a] = static_cast<float>(offset);
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef NATIVE_LINALG_HPP
+#define NATIVE_LINALG_HPP
+
+#include <cstddef>
+
+namespace Native
+{
+    // In place Cholesky factorization of a symmetric positive definite (n x n) row major matrix,
+    // the lower triangle is replaced by L (A = L L^T). Returns false if A is not positive definite.
+    bool choleskyFactor(double *A, size_t n);
+
+    // Solves L L^T x = b for one right hand side, b (n) is overwritten with x
+    void choleskySolve(const double *L, size_t n, double *b);
+
+    // Adds lambda * mean(diag(A)) to the diagonal (relative ridge), keeps near singular systems solvable
+    void addRidge(double *A, size_t n, double lambda);
+
+    // Weighted ridge regression with intercept for several outputs at once, sklearn's
+    // Ridge(alpha, fit_intercept=True).fit(X, Y, sample_weight=weights). Accumulated and solved in
+    // double like sklearn, only the float32 inputs and results round.
+    // X (rows, cols), weights (rows), Y (rows, outputs) -> coef (outputs, cols), intercept (outputs).
+    // Solves the primal (cols x cols) or the dual (rows x rows) system, whichever is smaller,
+    // with a single Cholesky factorization shared by all outputs. Returns false if singular.
+    bool weightedRidge(const float *X, size_t rows, size_t cols, const float *weights,
+                       const float *Y, size_t outputs, double alpha, float *coef, float *intercept);
+}
+
+#endif // NATIVE_LINALG_HPP
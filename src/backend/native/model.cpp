@@ -0,0 +1,288 @@
+#include "model.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "thread_pool.hpp"
+
+namespace
+{
+    class _Reader
+    {
+    public:
+        _Reader(const std::string &path) : path_(path), file_(path, std::ios::binary)
+        {
+            if (!file_)
+                throw std::runtime_error("Native model: cannot open " + path);
+        }
+
+        void read(void *dst, size_t bytes)
+        {
+            file_.read(static_cast<char *>(dst), static_cast<std::streamsize>(bytes));
+            if (static_cast<size_t>(file_.gcount()) != bytes)
+                throw std::runtime_error("Native model: unexpected end of file in " + path_);
+        }
+
+        uint32_t u32()
+        {
+            uint32_t v;
+            read(&v, sizeof(v));
+            return v;
+        }
+
+        float f32()
+        {
+            float v;
+            read(&v, sizeof(v));
+            return v;
+        }
+
+        void floats(std::vector<float> &dst, size_t count)
+        {
+            dst.resize(count);
+            read(dst.data(), count * sizeof(float));
+        }
+
+        bool atEnd()
+        {
+            return file_.peek() == std::char_traits<char>::eof();
+        }
+
+    private:
+        std::string path_;
+        std::ifstream file_;
+    };
+
+    Native::Activation _activation(uint32_t v, bool output)
+    {
+        if (v > static_cast<uint32_t>(Native::Activation::SOFTMAX) ||
+            (!output && v == static_cast<uint32_t>(Native::Activation::SOFTMAX)))
+            throw std::runtime_error("Native model: unsupported activation " + std::to_string(v));
+        return static_cast<Native::Activation>(v);
+    }
+}
+
+Native::Model::Model(const std::string &path) : path_(path)
+{
+    _Reader reader(path);
+
+    char magic[4];
+    reader.read(magic, sizeof(magic));
+    if (std::memcmp(magic, "PRLM", 4) != 0)
+        throw std::runtime_error("Native model: " + path + " is not a pearl model file");
+
+    const uint32_t version = reader.u32();
+    if (version != 1 && version != VERSION)
+        throw std::runtime_error("Native model: unsupported version " + std::to_string(version));
+
+    const uint32_t layer_count = reader.u32();
+    const uint32_t rank = reader.u32();
+    if (rank == 0)
+        throw std::runtime_error("Native model: empty input shape");
+
+    input_size_ = 1;
+    for (uint32_t i = 0; i < rank; i++)
+    {
+        network_shape_.push_back(reader.u32());
+        input_size_ *= network_shape_.back();
+    }
+
+    input_scale_ = reader.f32();
+    output_activation_ = _activation(reader.u32(), true);
+
+    input_shape_ = network_shape_;
+    if (version >= 2)
+    {
+        const uint32_t layout = reader.u32();
+        if (layout > static_cast<uint32_t>(InputLayout::HWC) || (layout == static_cast<uint32_t>(InputLayout::HWC) && rank != 3))
+            throw std::runtime_error("Native model: unsupported input layout " + std::to_string(layout));
+        input_layout_ = static_cast<InputLayout>(layout);
+        if (input_layout_ == InputLayout::HWC)
+            input_shape_ = {network_shape_[1], network_shape_[2], network_shape_[0]};
+    }
+
+    // shape of the activations flowing into the next layer, (C, H, W) or (N)
+    std::vector<size_t> shape = network_shape_;
+    size_t current = input_size_;
+    size_t widest = input_size_;
+
+    for (uint32_t i = 0; i < layer_count; i++)
+    {
+        Layer layer;
+        layer.type = static_cast<LayerType>(reader.u32());
+        layer.in = current;
+
+        switch (layer.type)
+        {
+        case LayerType::LINEAR:
+        {
+            const size_t in = reader.u32();
+            layer.out = reader.u32();
+            layer.activation = _activation(reader.u32(), false);
+            if (in != current)
+                throw std::runtime_error("Native model: layer " + std::to_string(i) + " expects " +
+                                         std::to_string(in) + " inputs, got " + std::to_string(current));
+            reader.floats(layer.weight, layer.in * layer.out);
+            reader.floats(layer.bias, layer.out);
+            shape = {layer.out};
+            break;
+        }
+        case LayerType::CONV2D:
+        {
+            layer.in_c = reader.u32();
+            layer.out_c = reader.u32();
+            layer.kh = reader.u32();
+            layer.kw = reader.u32();
+            layer.stride = reader.u32();
+            layer.pad = reader.u32();
+            layer.activation = _activation(reader.u32(), false);
+
+            if (shape.size() != 3 || shape[0] != layer.in_c)
+                throw std::runtime_error("Native model: conv layer " + std::to_string(i) + " expects " +
+                                         std::to_string(layer.in_c) + " input channels in (C, H, W) layout");
+            if (layer.stride == 0 || shape[1] + 2 * layer.pad < layer.kh || shape[2] + 2 * layer.pad < layer.kw)
+                throw std::runtime_error("Native model: conv layer " + std::to_string(i) + " does not fit its input");
+
+            layer.in_h = shape[1];
+            layer.in_w = shape[2];
+            layer.out_h = (layer.in_h + 2 * layer.pad - layer.kh) / layer.stride + 1;
+            layer.out_w = (layer.in_w + 2 * layer.pad - layer.kw) / layer.stride + 1;
+            layer.out = layer.out_c * layer.out_h * layer.out_w;
+
+            reader.floats(layer.weight, layer.out_c * layer.in_c * layer.kh * layer.kw);
+            reader.floats(layer.bias, layer.out_c);
+
+            columns_ = std::max(columns_, layer.in_c * layer.kh * layer.kw * layer.out_h * layer.out_w);
+            shape = {layer.out_c, layer.out_h, layer.out_w};
+            has_conv_ = true;
+            break;
+        }
+        case LayerType::FLATTEN:
+            layer.out = current;
+            shape = {current};
+            break;
+        default:
+            throw std::runtime_error("Native model: unknown layer type " +
+                                     std::to_string(static_cast<uint32_t>(layer.type)));
+        }
+
+        current = layer.out;
+        widest = std::max(widest, current);
+        layers_.push_back(std::move(layer));
+    }
+
+    if (!reader.atEnd())
+        throw std::runtime_error("Native model: trailing data in " + path);
+
+    output_size_ = current;
+    width_ = widest;
+}
+
+void Native::Model::_run(const float *input, size_t batch, Workspace &ws, float *out)
+{
+    // buffers grow with the largest batch seen so far
+    if (ws.buffers[0].size() < width_ * batch)
+    {
+        ws.buffers[0].resize(width_ * batch);
+        ws.buffers[1].resize(width_ * batch);
+    }
+    if (ws.columns.size() < columns_)
+        ws.columns.resize(columns_);
+
+    const float *src = input;
+    if (input_layout_ == InputLayout::HWC)
+    {
+        // (H, W, C) -> (C, H, W), scaled on the way
+        const size_t c = network_shape_[0], hw = network_shape_[1] * network_shape_[2];
+        float *transposed = ws.buffers[1].data();
+        for (size_t s = 0; s < batch; s++)
+        {
+            const float *in = input + s * input_size_;
+            float *out = transposed + s * input_size_;
+            for (size_t p = 0; p < hw; p++)
+                for (size_t k = 0; k < c; k++)
+                    out[k * hw + p] = in[p * c + k] * input_scale_;
+        }
+        src = transposed;
+    }
+    else if (input_scale_ != 1.0f)
+    {
+        float *scaled = ws.buffers[1].data();
+        for (size_t i = 0; i < input_size_ * batch; i++)
+            scaled[i] = input[i] * input_scale_;
+        src = scaled;
+    }
+
+    int target = 0;
+    for (const auto &layer : layers_)
+    {
+        float *dst = ws.buffers[target].data();
+
+        switch (layer.type)
+        {
+        case LayerType::LINEAR:
+            gemmNT(src, layer.weight.data(), layer.bias.data(), dst, batch, layer.out, layer.in, layer.activation);
+            break;
+        case LayerType::CONV2D:
+        {
+            const size_t k = layer.in_c * layer.kh * layer.kw;
+            const size_t n = layer.out_h * layer.out_w;
+            const bool pointwise = layer.kh == 1 && layer.kw == 1 && layer.stride == 1 && layer.pad == 0;
+
+            for (size_t s = 0; s < batch; s++)
+            {
+                const float *columns = src + s * layer.in;
+                if (!pointwise)
+                {
+                    im2col(columns, ws.columns.data(), layer.in_c, layer.in_h, layer.in_w,
+                           layer.kh, layer.kw, layer.stride, layer.pad, layer.out_h, layer.out_w);
+                    columns = ws.columns.data();
+                }
+                gemmNN(layer.weight.data(), columns, layer.bias.data(), dst + s * layer.out,
+                       layer.out_c, n, k, layer.activation);
+            }
+            break;
+        }
+        case LayerType::FLATTEN:
+            continue;
+        }
+
+        src = dst;
+        target ^= 1;
+    }
+
+    std::copy(src, src + output_size_ * batch, out);
+
+    if (output_activation_ == Activation::SOFTMAX)
+        softmaxRows(out, batch, output_size_);
+    else
+        activate(out, output_size_ * batch, output_activation_);
+}
+
+const float *Native::Model::forward(const float *input, size_t batch)
+{
+    result_.resize(output_size_ * batch);
+
+    // conv layers go sample by sample anyway, so any batch splits well. Pure MLPs are
+    // memory bound on the weights and only gain from threads on large batches.
+    const size_t min_batch = has_conv_ ? 2 : 64;
+    ThreadPool &pool = ThreadPool::global();
+
+    if (!parallel_ || batch < min_batch || pool.size() == 1)
+    {
+        if (workspaces_.empty())
+            workspaces_.resize(1);
+        _run(input, batch, workspaces_[0], result_.data());
+        return result_.data();
+    }
+
+    if (workspaces_.size() < pool.size())
+        workspaces_.resize(pool.size());
+
+    pool.parallelFor(batch, [&](size_t begin, size_t end, size_t worker)
+                     { _run(input + begin * input_size_, end - begin, workspaces_[worker], result_.data() + begin * output_size_); });
+
+    return result_.data();
+}
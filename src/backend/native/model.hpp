@@ -0,0 +1,115 @@
+#ifndef NATIVE_MODEL_HPP
+#define NATIVE_MODEL_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gemm.hpp"
+
+namespace Native
+{
+    // Flat binary model format written by pearl.native.export (little endian):
+    //
+    //   char[4]  magic "PRLM"
+    //   u32      version (1 or 2)
+    //   u32      layer count
+    //   u32      input rank, followed by rank u32 dims (no batch dimension), the network's (C, H, W)
+    //   f32      input scale (inputs are multiplied by it before the first layer)
+    //   u32      output activation (Activation, SOFTMAX allowed)
+    //   u32      input layout (InputLayout), version 2 only. 1 has CHW inputs
+    //
+    // then per layer a u32 LayerType followed by its payload:
+    //   LINEAR:  u32 in, u32 out, u32 activation, f32 W[out * in], f32 b[out]
+    //   CONV2D:  u32 in_c, u32 out_c, u32 kh, u32 kw, u32 stride, u32 pad, u32 activation,
+    //            f32 W[out_c * in_c * kh * kw], f32 b[out_c]   (input must currently be (C, H, W))
+    //   FLATTEN: no payload, (C, H, W) -> (C * H * W), activations are NCHW so it is free
+    enum class LayerType : uint32_t
+    {
+        LINEAR = 1,
+        CONV2D = 2,
+        FLATTEN = 3,
+    };
+
+    // how observations arrive. HWC frames, as envs hand them out, are transposed to (C, H, W)
+    // together with the input scale, the layers always see CHW
+    enum class InputLayout : uint32_t
+    {
+        CHW = 0,
+        HWC = 1,
+    };
+
+    struct Layer
+    {
+        LayerType type;
+        Activation activation = Activation::NONE;
+
+        // flattened per sample sizes
+        size_t in = 0;
+        size_t out = 0;
+        std::vector<float> weight;
+        std::vector<float> bias;
+
+        // CONV2D only
+        size_t in_c = 0, in_h = 0, in_w = 0;
+        size_t out_c = 0, out_h = 0, out_w = 0;
+        size_t kh = 0, kw = 0, stride = 1, pad = 0;
+    };
+
+    // Small feed forward network evaluated on the CPU, used in place of torch for the
+    // exported policy / q networks. Batches are split across ThreadPool::global().
+    // Not thread safe, forward() reuses internal buffers.
+    class Model
+    {
+    public:
+        static constexpr uint32_t VERSION = 2;
+
+        // throws std::runtime_error if the file is missing or malformed
+        explicit Model(const std::string &path);
+
+        // input is (batch, inputSize()) contiguous floats, returns (batch, outputSize())
+        // the returned pointer stays valid until the next call
+        const float *forward(const float *input, size_t batch);
+
+        size_t inputSize() const { return input_size_; }
+        size_t outputSize() const { return output_size_; }
+        float inputScale() const { return input_scale_; }
+        InputLayout inputLayout() const { return input_layout_; }
+        // one observation as callers pass it, (H, W, C) for HWC models
+        const std::vector<size_t> &inputShape() const { return input_shape_; }
+        const std::vector<Layer> &layers() const { return layers_; }
+        const std::string &path() const { return path_; }
+
+        // run batches on the shared thread pool (default on)
+        void setParallel(bool parallel) { parallel_ = parallel; }
+
+    private:
+        // per thread scratch
+        struct Workspace
+        {
+            std::vector<float> buffers[2]; // ping pong activations
+            std::vector<float> columns;    // im2col of one sample
+        };
+
+        void _run(const float *input, size_t batch, Workspace &ws, float *out);
+
+        std::string path_;
+        std::vector<Layer> layers_;
+        std::vector<size_t> input_shape_;
+        std::vector<size_t> network_shape_; // what the first layer sees, (C, H, W) for conv nets
+        size_t input_size_ = 0;
+        size_t output_size_ = 0;
+        size_t width_ = 0;   // widest activation of a single sample
+        size_t columns_ = 0; // largest im2col buffer of a single sample
+        float input_scale_ = 1.0f;
+        InputLayout input_layout_ = InputLayout::CHW;
+        Activation output_activation_ = Activation::NONE;
+        bool has_conv_ = false;
+        bool parallel_ = true;
+
+        std::vector<Workspace> workspaces_;
+        std::vector<float> result_;
+    };
+}
+
+#endif // NATIVE_MODEL_HPP
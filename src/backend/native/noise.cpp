@@ -0,0 +1,89 @@
+#include "noise.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "counter_rng.hpp"
+#include "thread_pool.hpp"
+
+Native::NoiseType Native::parseNoiseType(const std::string &name)
+{
+    if (name == "gaussian")
+        return NoiseType::GAUSSIAN;
+    if (name == "salt_pepper")
+        return NoiseType::SALT_PEPPER;
+    if (name == "occlusion")
+        return NoiseType::OCCLUSION;
+    throw std::invalid_argument("unknown noise type '" + name + "' (gaussian, salt_pepper, occlusion)");
+}
+
+void Native::NoiseEngine::perturb(const float *x, size_t planes, size_t h, size_t w, size_t count, float *out)
+{
+    const size_t size = planes * h * w;
+    const CounterRng rng(config_.seed, stream_++);
+    const float strength = config_.strength;
+    const float low = config_.low, high = config_.high;
+
+    ThreadPool::global().parallelFor(count, [&](size_t begin, size_t end, size_t)
+                                     {
+        for (size_t s = begin; s < end; s++)
+        {
+            float *dst = out + s * size;
+
+            switch (config_.type)
+            {
+            case NoiseType::GAUSSIAN:
+            {
+                // one 64 bit draw gives two normals
+                const uint64_t base = s * ((size + 1) / 2);
+                size_t i = 0;
+                for (; i + 2 <= size; i += 2)
+                {
+                    float a, b;
+                    rng.normalPair(base + i / 2, a, b);
+                    dst[i] = x[i] + strength * a;
+                    dst[i + 1] = x[i + 1] + strength * b;
+                }
+                if (i < size)
+                {
+                    float a, b;
+                    rng.normalPair(base + i / 2, a, b);
+                    dst[i] = x[i] + strength * a;
+                }
+                for (size_t j = 0; j < size; j++)
+                    dst[j] = std::clamp(dst[j], low, high);
+                break;
+            }
+            case NoiseType::SALT_PEPPER:
+            {
+                // top 24 bits decide whether the element is hit, bit 0 salt or pepper
+                const uint64_t base = s * size;
+                const uint32_t threshold = static_cast<uint32_t>(std::clamp(strength, 0.0f, 1.0f) * 16777216.0f);
+                for (size_t i = 0; i < size; i++)
+                {
+                    const uint64_t v = rng.bits(base + i);
+                    const bool hit = static_cast<uint32_t>(v >> 40) < threshold;
+                    dst[i] = hit ? ((v & 1u) ? high : low) : x[i];
+                }
+                break;
+            }
+            case NoiseType::OCCLUSION:
+            {
+                std::memcpy(dst, x, size * sizeof(float));
+                const size_t side = std::min({h, w, static_cast<size_t>(std::lround(strength * std::min(h, w)))});
+                if (side == 0)
+                    break;
+
+                const uint64_t v = rng.bits(s);
+                const size_t y0 = static_cast<size_t>((v >> 32) % (h - side + 1));
+                const size_t x0 = static_cast<size_t>((v & 0xFFFFFFFFu) % (w - side + 1));
+                for (size_t c = 0; c < planes; c++)
+                    for (size_t y = y0; y < y0 + side; y++)
+                        std::fill_n(dst + (c * h + y) * w + x0, side, low);
+                break;
+            }
+            }
+        } });
+}
@@ -0,0 +1,48 @@
+#ifndef NATIVE_NOISE_HPP
+#define NATIVE_NOISE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Native
+{
+    enum class NoiseType
+    {
+        GAUSSIAN,    // x + strength * N(0, 1), clamped to [low, high]
+        SALT_PEPPER, // every element becomes low or high with probability strength
+        OCCLUSION,   // one square per sample, side = strength * min(h, w), set to low on every plane
+    };
+
+    // "gaussian", "salt_pepper", "occlusion", throws std::invalid_argument otherwise
+    NoiseType parseNoiseType(const std::string &name);
+
+    struct NoiseConfig
+    {
+        NoiseType type = NoiseType::GAUSSIAN;
+        float strength = 0.01f;
+        float low = 0.0f;
+        float high = 1.0f;
+        uint64_t seed = 0;
+    };
+
+    // Fills a batch of noisy copies of one observation. Every call uses the next stream of a
+    // counter based rng, so a batch is reproducible and independent of the thread count.
+    class NoiseEngine
+    {
+    public:
+        explicit NoiseEngine(const NoiseConfig &config = {}) : config_(config) {}
+
+        // x is (planes, h, w) contiguous (h = 1 for flat observations), out (count, planes, h, w)
+        void perturb(const float *x, size_t planes, size_t h, size_t w, size_t count, float *out);
+
+        const NoiseConfig &config() const { return config_; }
+        void setStrength(float strength) { config_.strength = strength; }
+
+    private:
+        NoiseConfig config_;
+        uint64_t stream_ = 0;
+    };
+}
+
+#endif // NATIVE_NOISE_HPP
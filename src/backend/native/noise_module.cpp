@@ -0,0 +1,76 @@
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "noise.hpp"
+
+namespace py = pybind11;
+
+using FloatArray = py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+// Python facing noise engine: one call fills the whole (count, ...) batch of noisy observations
+class NoiseEngine
+{
+public:
+    NoiseEngine(const std::string &noise_type, float strength, uint64_t seed, float low, float high)
+        : engine_(Native::NoiseConfig{Native::parseNoiseType(noise_type), strength, low, high, seed})
+    {
+    }
+
+    // x (..., H, W), a leading batch dim of 1 is dropped: returns / fills out (count, ...)
+    py::array perturb(const FloatArray &x, size_t count, std::optional<py::array> out)
+    {
+        std::vector<ssize_t> item(x.shape(), x.shape() + x.ndim());
+        if (item.size() > 1 && item.front() == 1)
+            item.erase(item.begin());
+
+        const size_t w = item.empty() ? 1 : static_cast<size_t>(item.back());
+        const size_t h = item.size() < 2 ? 1 : static_cast<size_t>(item[item.size() - 2]);
+        const size_t planes = w * h == 0 ? 0 : static_cast<size_t>(x.size()) / (w * h);
+
+        std::vector<ssize_t> shape{static_cast<ssize_t>(count)};
+        shape.insert(shape.end(), item.begin(), item.end());
+
+        py::array batch;
+        if (out)
+        {
+            // filled in place, e.g. a preallocated buffer reused every step, so no conversion
+            batch = *out;
+            if (!py::isinstance<py::array_t<float>>(batch) || !(batch.flags() & py::array::c_style) ||
+                !batch.writeable() || batch.size() != static_cast<ssize_t>(count * planes * h * w))
+                throw std::invalid_argument("NoiseEngine: out must be a writable contiguous float32 array of " +
+                                            std::to_string(count * planes * h * w) + " elements");
+        }
+        else
+        {
+            batch = py::array_t<float>(shape);
+        }
+
+        {
+            py::gil_scoped_release release;
+            engine_.perturb(x.data(), planes, h, w, count, static_cast<float *>(batch.mutable_data()));
+        }
+        return batch;
+    }
+
+    float strength() const { return engine_.config().strength; }
+    void setStrength(float strength) { engine_.setStrength(strength); }
+
+private:
+    Native::NoiseEngine engine_;
+};
+
+PYBIND11_EMBEDDED_MODULE(pearl_noise, m)
+{
+    py::class_<NoiseEngine>(m, "NoiseEngine")
+        .def(py::init<const std::string &, float, uint64_t, float, float>(), py::arg("noise_type") = "gaussian",
+             py::arg("strength") = 0.01f, py::arg("seed") = 0, py::arg("low") = 0.0f, py::arg("high") = 1.0f)
+        .def("perturb", &NoiseEngine::perturb, py::arg("x"), py::arg("count"), py::arg("out") = py::none())
+        .def_property("strength", &NoiseEngine::strength, &NoiseEngine::setStrength);
+}
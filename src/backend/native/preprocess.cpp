@@ -0,0 +1,330 @@
+#include "preprocess.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    std::string _trim(const std::string &s)
+    {
+        const size_t begin = s.find_first_not_of(" \t");
+        if (begin == std::string::npos)
+            return "";
+        const size_t end = s.find_last_not_of(" \t");
+        return s.substr(begin, end - begin + 1);
+    }
+
+    // "a:b:c" / "axb" -> numbers, throws if the count does not match
+    std::vector<float> _numbers(const std::string &token, const std::string &value, size_t count)
+    {
+        std::vector<float> out;
+        std::string item;
+        std::stringstream ss(value);
+        while (std::getline(ss, item, value.find('x') != std::string::npos ? 'x' : ':'))
+        {
+            try
+            {
+                size_t used = 0;
+                out.push_back(std::stof(item, &used));
+                if (used != item.size())
+                    throw std::invalid_argument(item);
+            }
+            catch (const std::exception &)
+            {
+                throw std::invalid_argument("preprocess: bad number '" + item + "' in '" + token + "'");
+            }
+        }
+        if (out.size() != count)
+            throw std::invalid_argument("preprocess: '" + token + "' expects " + std::to_string(count) + " values");
+        return out;
+    }
+
+    int _positive(const std::string &token, float v)
+    {
+        if (v <= 0 || v != static_cast<int>(v))
+            throw std::invalid_argument("preprocess: '" + token + "' needs positive integers");
+        return static_cast<int>(v);
+    }
+}
+
+Native::PreprocessSpec Native::parsePreprocessSpec(const std::string &spec)
+{
+    PreprocessSpec out;
+    bool terminal = false; // normalize / stack seen, geometric ops can not follow
+
+    std::string raw;
+    std::stringstream ss(spec);
+    while (std::getline(ss, raw, ','))
+    {
+        const std::string token = _trim(raw);
+        if (token.empty())
+            continue;
+
+        const size_t eq = token.find('=');
+        const std::string name = token.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : token.substr(eq + 1);
+
+        if (name == "normalize")
+        {
+            out.normalize = true;
+            if (!value.empty())
+            {
+                const auto v = _numbers(token, value, 2);
+                if (v[1] == 0)
+                    throw std::invalid_argument("preprocess: normalize std can not be 0");
+                out.mean = v[0];
+                out.std = v[1];
+            }
+            terminal = true;
+            continue;
+        }
+        if (name == "stack")
+        {
+            out.stack = _positive(token, _numbers(token, value, 1)[0]);
+            terminal = true;
+            continue;
+        }
+
+        if (terminal)
+            throw std::invalid_argument("preprocess: '" + token + "' must come before normalize / stack");
+
+        PreprocessOp op{};
+        if (name == "maxpool")
+        {
+            op.type = PreprocessOpType::MAX_POOL;
+        }
+        else if (name == "gray" || name == "grayscale")
+        {
+            op.type = PreprocessOpType::GRAYSCALE;
+        }
+        else if (name == "crop")
+        {
+            const auto v = _numbers(token, value, 4);
+            if (v[0] < 0 || v[1] < 0)
+                throw std::invalid_argument("preprocess: crop offsets can not be negative");
+            op.type = PreprocessOpType::CROP;
+            op.top = static_cast<int>(v[0]);
+            op.left = static_cast<int>(v[1]);
+            op.height = _positive(token, v[2]);
+            op.width = _positive(token, v[3]);
+        }
+        else if (name == "resize")
+        {
+            const auto v = _numbers(token, value, 2);
+            op.type = PreprocessOpType::RESIZE;
+            op.height = _positive(token, v[0]);
+            op.width = _positive(token, v[1]);
+        }
+        else
+        {
+            throw std::invalid_argument("preprocess: unknown op '" + name + "'");
+        }
+        out.ops.push_back(op);
+    }
+    return out;
+}
+
+Native::PreprocessChain::PreprocessChain(PreprocessSpec spec) : spec_(std::move(spec))
+{
+    if (spec_.stack <= 0)
+        throw std::invalid_argument("preprocess: stack must be positive");
+}
+
+void Native::PreprocessChain::_configure(int h, int w, int channels)
+{
+    if (h <= 0 || w <= 0 || channels <= 0)
+        throw std::invalid_argument("preprocess: frame sizes must be positive");
+    if (h == in_h_ && w == in_w_ && channels == in_c_)
+        return;
+
+    stages_.clear();
+    stages_.reserve(spec_.ops.size());
+
+    int ch = h, cw = w, cc = channels;
+    for (const auto &op : spec_.ops)
+    {
+        Stage stage;
+        stage.op = op;
+
+        switch (op.type)
+        {
+        case PreprocessOpType::MAX_POOL:
+            stage.previous.resize(static_cast<size_t>(ch) * cw * cc);
+            break;
+        case PreprocessOpType::GRAYSCALE:
+            if (cc != 1 && cc != 3 && cc != 4)
+                throw std::invalid_argument("preprocess: gray needs 1, 3 or 4 channels, got " + std::to_string(cc));
+            cc = 1;
+            break;
+        case PreprocessOpType::CROP:
+            if (op.top + op.height > ch || op.left + op.width > cw)
+                throw std::invalid_argument("preprocess: crop " + std::to_string(op.height) + "x" +
+                                            std::to_string(op.width) + " at " + std::to_string(op.top) + ":" +
+                                            std::to_string(op.left) + " outside of a " + std::to_string(ch) + "x" +
+                                            std::to_string(cw) + " frame");
+            ch = op.height;
+            cw = op.width;
+            break;
+        case PreprocessOpType::RESIZE:
+            stage.resizer = AreaResizer(ch, cw, op.height, op.width, cc);
+            ch = op.height;
+            cw = op.width;
+            break;
+        }
+
+        stage.h = ch;
+        stage.w = cw;
+        stage.c = cc;
+        stage.out.resize(static_cast<size_t>(ch) * cw * cc);
+        stages_.push_back(std::move(stage));
+    }
+
+    in_h_ = h;
+    in_w_ = w;
+    in_c_ = channels;
+    out_h_ = ch;
+    out_w_ = cw;
+    out_c_ = cc;
+
+    const size_t slots = 3 * static_cast<size_t>(spec_.stack);
+    if (spec_.normalize)
+    {
+        ring_float_.assign(slots * frameSize(), 0.0f);
+        ring_.clear();
+    }
+    else
+    {
+        ring_.assign(slots * frameSize(), 0);
+        ring_float_.clear();
+    }
+    newest_ = static_cast<size_t>(spec_.stack) - 1;
+}
+
+const uint8_t *Native::PreprocessChain::_run(const uint8_t *frame, bool first)
+{
+    const uint8_t *in = frame;
+    int h = in_h_, w = in_w_, c = in_c_;
+
+    for (auto &stage : stages_)
+    {
+        const size_t n = static_cast<size_t>(h) * w * c;
+        const size_t pixels = static_cast<size_t>(h) * w;
+        uint8_t *out = stage.out.data();
+
+        switch (stage.op.type)
+        {
+        case PreprocessOpType::MAX_POOL:
+            if (first)
+                std::memcpy(out, in, n);
+            else
+                maxPool(in, stage.previous.data(), out, n);
+            std::memcpy(stage.previous.data(), in, n);
+            break;
+        case PreprocessOpType::GRAYSCALE:
+            if (c == 1)
+            {
+                std::memcpy(out, in, n);
+            }
+            else if (c == 3)
+            {
+                rgbToGray(in, out, pixels);
+            }
+            else
+            {
+                // RGBA, alpha ignored, same weights as rgbToGray
+                for (size_t i = 0; i < pixels; i++)
+                {
+                    const uint8_t *p = in + i * 4;
+                    out[i] = static_cast<uint8_t>((p[0] * 4899u + p[1] * 9617u + p[2] * 1868u + (1u << 13)) >> 14);
+                }
+            }
+            break;
+        case PreprocessOpType::CROP:
+        {
+            const size_t row = static_cast<size_t>(stage.w) * c;
+            for (int y = 0; y < stage.h; y++)
+            {
+                const uint8_t *src = in + (static_cast<size_t>(stage.op.top + y) * w + stage.op.left) * c;
+                std::memcpy(out + y * row, src, row);
+            }
+            break;
+        }
+        case PreprocessOpType::RESIZE:
+            stage.resizer.resize(in, out);
+            break;
+        }
+
+        in = out;
+        h = stage.h;
+        w = stage.w;
+        c = stage.c;
+    }
+    return in;
+}
+
+void Native::PreprocessChain::_write(const uint8_t *frame, size_t slot)
+{
+    const size_t n = frameSize();
+    if (spec_.normalize)
+    {
+        float *dst = ring_float_.data() + slot * n;
+        const float scale = 1.0f / (255.0f * spec_.std);
+        const float shift = -spec_.mean / spec_.std;
+        for (size_t i = 0; i < n; i++)
+            dst[i] = static_cast<float>(frame[i]) * scale + shift;
+    }
+    else
+    {
+        std::memcpy(ring_.data() + slot * n, frame, n);
+    }
+}
+
+void Native::PreprocessChain::reset(const uint8_t *frame, int h, int w, int channels)
+{
+    _configure(h, w, channels);
+    const uint8_t *processed = _run(frame, true);
+
+    const size_t stack = static_cast<size_t>(spec_.stack);
+    for (size_t slot = 0; slot < stack; slot++)
+        _write(processed, slot);
+    newest_ = stack - 1;
+}
+
+void Native::PreprocessChain::push(const uint8_t *frame, int h, int w, int channels)
+{
+    if (!configured() || h != in_h_ || w != in_w_ || channels != in_c_)
+    {
+        reset(frame, h, w, channels);
+        return;
+    }
+
+    const uint8_t *processed = _run(frame, false);
+
+    const size_t stack = static_cast<size_t>(spec_.stack);
+    const size_t n = frameSize();
+    if (newest_ + 1 == 3 * stack)
+    {
+        // end of the buffer, the newest stack - 1 frames move to the front
+        const size_t from = (newest_ + 2 - stack) * n, count = (stack - 1) * n;
+        if (spec_.normalize)
+            std::copy_n(ring_float_.data() + from, count, ring_float_.data());
+        else
+            std::copy_n(ring_.data() + from, count, ring_.data());
+        newest_ = stack - 2; // wraps to size_t max for stack 1, the increment below brings it to 0
+    }
+
+    newest_++;
+    _write(processed, newest_);
+}
+
+const uint8_t *Native::PreprocessChain::observation() const
+{
+    return ring_.empty() ? nullptr : ring_.data() + (newest_ + 1 - spec_.stack) * frameSize();
+}
+
+const float *Native::PreprocessChain::observationFloat() const
+{
+    return ring_float_.empty() ? nullptr : ring_float_.data() + (newest_ + 1 - spec_.stack) * frameSize();
+}
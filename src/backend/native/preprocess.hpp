@@ -0,0 +1,99 @@
+#ifndef NATIVE_PREPROCESS_HPP
+#define NATIVE_PREPROCESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "image_ops.hpp"
+
+namespace Native
+{
+    enum class PreprocessOpType
+    {
+        MAX_POOL,  // max with the previous frame at this point of the chain (sprite flicker)
+        GRAYSCALE, // RGB -> luma, no-op on single channel frames
+        CROP,      // top, left, height, width
+        RESIZE,    // area resize to height x width
+    };
+
+    struct PreprocessOp
+    {
+        PreprocessOpType type;
+        int top = 0;
+        int left = 0;
+        int height = 0;
+        int width = 0;
+    };
+
+    struct PreprocessSpec
+    {
+        std::vector<PreprocessOp> ops; // geometric ops, in order, on uint8 frames
+
+        // terminal stages, fused into the write of the final frame
+        bool normalize = false; // float output, (x / 255 - mean) / std
+        float mean = 0.0f;
+        float std = 1.0f;
+        int stack = 1; // > 1: (stack, H, W[, C]) oldest frame first
+    };
+
+    // "maxpool,gray,crop=34:0:160:160,resize=84x84,normalize,stack=4"
+    // normalize takes an optional "=mean:std". Throws std::invalid_argument on a bad spec.
+    PreprocessSpec parsePreprocessSpec(const std::string &spec);
+
+    // Per step observation preprocessing of an env's raw frames.
+    //
+    // Every op owns its output buffer, sized once for the input shape (and again only if that
+    // changes), so a push is one pass per op with no allocation. The frame stack lives in a
+    // 3 * stack slot buffer written front to back, the window is the last stack slots written.
+    // Reaching the end moves the newest stack - 1 frames to the front, so windows are always
+    // contiguous, a push costs well under one extra frame copy on average, and a window handed
+    // out stays untouched for the next stack pushes (the pipeline scores the pre step observation).
+    class PreprocessChain
+    {
+    public:
+        explicit PreprocessChain(PreprocessSpec spec);
+
+        // frame (h, w, channels) uint8, contiguous. reset() fills the whole stack with it.
+        void reset(const uint8_t *frame, int h, int w, int channels);
+        void push(const uint8_t *frame, int h, int w, int channels);
+
+        // (stack, H, W, C) contiguous, u8 or float depending on spec().normalize
+        const uint8_t *observation() const;
+        const float *observationFloat() const;
+
+        const PreprocessSpec &spec() const { return spec_; }
+        int outHeight() const { return out_h_; }
+        int outWidth() const { return out_w_; }
+        int outChannels() const { return out_c_; }
+        size_t frameSize() const { return static_cast<size_t>(out_h_) * out_w_ * out_c_; }
+        bool configured() const { return in_h_ > 0; }
+
+    private:
+        struct Stage
+        {
+            PreprocessOp op;
+            int h = 0, w = 0, c = 0; // output shape
+            std::vector<uint8_t> out;
+            std::vector<uint8_t> previous; // MAX_POOL only
+            AreaResizer resizer;           // RESIZE only
+        };
+
+        void _configure(int h, int w, int channels);
+        const uint8_t *_run(const uint8_t *frame, bool first);
+        void _write(const uint8_t *frame, size_t slot);
+
+        PreprocessSpec spec_;
+        std::vector<Stage> stages_;
+
+        int in_h_ = 0, in_w_ = 0, in_c_ = 0;
+        int out_h_ = 0, out_w_ = 0, out_c_ = 0;
+
+        std::vector<uint8_t> ring_;
+        std::vector<float> ring_float_;
+        size_t newest_ = 0; // slot of the latest frame, the window is [newest_ - stack + 1, newest_]
+    };
+}
+
+#endif // NATIVE_PREPROCESS_HPP
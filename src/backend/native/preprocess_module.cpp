@@ -0,0 +1,74 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "preprocess.hpp"
+
+namespace py = pybind11;
+
+using ByteArray = py::array_t<uint8_t, py::array::c_style | py::array::forcecast>;
+
+// Python facing preprocessing chain, fed the env's raw uint8 frames every step
+class PreprocessChain
+{
+public:
+    explicit PreprocessChain(const std::string &spec) : chain_(Native::parsePreprocessSpec(spec)) {}
+
+    void reset(const ByteArray &frame) { _feed(frame, true); }
+    void push(const ByteArray &frame) { _feed(frame, false); }
+
+    // (stack, H, W[, C]) view over the native buffer, (H, W[, C]) without stacking. The stack
+    // axis is dropped for stack 1 and the channel axis for single channel frames.
+    py::array observation(py::object self)
+    {
+        if (!chain_.configured())
+            throw std::runtime_error("PreprocessChain: reset() before observation()");
+
+        std::vector<ssize_t> shape;
+        if (chain_.spec().stack > 1)
+            shape.push_back(chain_.spec().stack);
+        shape.push_back(chain_.outHeight());
+        shape.push_back(chain_.outWidth());
+        if (chain_.outChannels() > 1)
+            shape.push_back(chain_.outChannels());
+
+        if (chain_.spec().normalize)
+            return py::array_t<float>(shape, chain_.observationFloat(), self);
+        return py::array_t<uint8_t>(shape, chain_.observation(), self);
+    }
+
+private:
+    // frame (H, W) or (H, W, C)
+    void _feed(const ByteArray &frame, bool reset)
+    {
+        if (frame.ndim() != 2 && frame.ndim() != 3)
+            throw std::invalid_argument("PreprocessChain: frames must be (H, W) or (H, W, C), got " +
+                                        std::to_string(frame.ndim()) + " axes");
+
+        const int h = static_cast<int>(frame.shape(0));
+        const int w = static_cast<int>(frame.shape(1));
+        const int c = frame.ndim() == 3 ? static_cast<int>(frame.shape(2)) : 1;
+
+        py::gil_scoped_release release;
+        if (reset)
+            chain_.reset(frame.data(), h, w, c);
+        else
+            chain_.push(frame.data(), h, w, c);
+    }
+
+    Native::PreprocessChain chain_;
+};
+
+PYBIND11_EMBEDDED_MODULE(pearl_preprocess, m)
+{
+    py::class_<PreprocessChain>(m, "PreprocessChain")
+        .def(py::init<const std::string &>(), py::arg("spec"))
+        .def("reset", &PreprocessChain::reset, py::arg("frame"))
+        .def("push", &PreprocessChain::push, py::arg("frame"))
+        .def("observation", [](py::object self)
+             { return self.cast<PreprocessChain &>().observation(self); });
+}
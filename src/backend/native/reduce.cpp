@@ -0,0 +1,235 @@
+#include "reduce.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Native::ScalarType;
+    using Native::StridedView;
+
+    template <typename Fn>
+    void _visitType(ScalarType type, Fn &&fn)
+    {
+        switch (type)
+        {
+        case ScalarType::F32:
+            fn(float{});
+            break;
+        case ScalarType::F64:
+            fn(double{});
+            break;
+        case ScalarType::U8:
+            fn(uint8_t{});
+            break;
+        }
+    }
+
+    template <typename T>
+    inline double _load(const char *p)
+    {
+        return static_cast<double>(*reinterpret_cast<const T *>(p));
+    }
+
+    // weights strides aligned to values' axes (numpy broadcasting, from the right)
+    void _broadcastStrides(const StridedView &values, const StridedView *weights, ptrdiff_t *strides)
+    {
+        std::fill(strides, strides + StridedView::MAX_DIMS, 0);
+        if (!weights)
+            return;
+
+        if (weights->ndim > values.ndim)
+            throw std::invalid_argument("reduce: weights have more axes than values");
+
+        const int offset = values.ndim - weights->ndim;
+        for (int d = 0; d < weights->ndim; d++)
+        {
+            const ptrdiff_t size = weights->shape[d];
+            if (size == values.shape[offset + d])
+                strides[offset + d] = weights->strides[d];
+            else if (size != 1)
+                throw std::invalid_argument("reduce: weights axis " + std::to_string(d) + " (" + std::to_string(size) +
+                                            ") does not broadcast to " + std::to_string(values.shape[offset + d]));
+        }
+    }
+
+    // calls fn(value_ptr, weight_ptr, group) for every position of the non action axes in C order,
+    // the innermost axis is a plain strided loop
+    template <typename Fn>
+    void _forEachPosition(const StridedView &values, const char *weights, const ptrdiff_t *wstrides, int group_axis,
+                          Fn &&fn)
+    {
+        const int dims = values.ndim - 1;
+        const char *vbase = static_cast<const char *>(values.data);
+        if (dims <= 0)
+        {
+            fn(vbase, weights, size_t(0));
+            return;
+        }
+
+        for (int d = 0; d < dims; d++)
+            if (values.shape[d] == 0)
+                return;
+
+        const int inner = dims - 1;
+        const ptrdiff_t n = values.shape[inner];
+        const ptrdiff_t vs = values.strides[inner], ws = wstrides[inner];
+        ptrdiff_t idx[StridedView::MAX_DIMS] = {};
+
+        while (true)
+        {
+            const char *vp = vbase;
+            const char *wp = weights;
+            for (int d = 0; d < inner; d++)
+            {
+                vp += idx[d] * values.strides[d];
+                wp += idx[d] * wstrides[d];
+            }
+
+            const size_t group = group_axis >= 0 && group_axis < inner ? static_cast<size_t>(idx[group_axis]) : 0;
+            for (ptrdiff_t i = 0; i < n; i++)
+                fn(vp + i * vs, wp + i * ws, group_axis == inner ? static_cast<size_t>(i) : group);
+
+            int d = inner - 1;
+            for (; d >= 0; d--)
+            {
+                if (++idx[d] < values.shape[d])
+                    break;
+                idx[d] = 0;
+            }
+            if (d < 0)
+                break;
+        }
+    }
+
+    template <typename V>
+    std::vector<double> _actionTotals(const StridedView &values, bool absolute)
+    {
+        const ptrdiff_t actions = values.shape[values.ndim - 1];
+        const ptrdiff_t as = values.strides[values.ndim - 1];
+        const ptrdiff_t no_strides[StridedView::MAX_DIMS] = {};
+        std::vector<double> totals(actions, 0.0);
+
+        _forEachPosition(values, nullptr, no_strides, -1, [&](const char *vp, const char *, size_t)
+                         {
+            for (ptrdiff_t a = 0; a < actions; a++)
+            {
+                const double v = _load<V>(vp + a * as);
+                totals[a] += absolute ? std::abs(v) : v;
+            } });
+        return totals;
+    }
+
+    void _checkValues(const StridedView &values)
+    {
+        if (values.ndim < 1 || values.ndim > StridedView::MAX_DIMS)
+            throw std::invalid_argument("reduce: values need 1 to 8 axes, the last one being the actions");
+    }
+}
+
+void Native::maskedReduce(const StridedView &values, const StridedView *weights, const ReduceOptions &options,
+                          double *out)
+{
+    _checkValues(values);
+    if (options.group_axis >= values.ndim - 1)
+        throw std::invalid_argument("reduce: group_axis must be one of the non action axes");
+
+    ptrdiff_t wstrides[StridedView::MAX_DIMS];
+    _broadcastStrides(values, weights, wstrides);
+
+    static const float one = 1.0f;
+    const char *wdata = weights ? static_cast<const char *>(weights->data) : reinterpret_cast<const char *>(&one);
+    const ScalarType wtype = weights ? weights->type : ScalarType::F32;
+
+    const ptrdiff_t actions = values.shape[values.ndim - 1];
+    const ptrdiff_t as = values.strides[values.ndim - 1];
+    const ptrdiff_t was = wstrides[values.ndim - 1];
+    const size_t groups = options.group_axis >= 0 ? static_cast<size_t>(values.shape[options.group_axis]) : 1;
+
+    std::vector<double> num(groups * actions, 0.0), den(groups * actions, 0.0);
+
+    _visitType(values.type, [&](auto vt)
+               {
+        using V = decltype(vt);
+
+        // OVERLAP needs the normalized value inside max(), so the totals come first. SUM only
+        // divides at the end and gets the totals from the same pass.
+        std::vector<double> scale(actions, 1.0);
+        if (options.normalize && options.mode == ReduceMode::OVERLAP)
+        {
+            const auto totals = _actionTotals<V>(values, options.absolute);
+            for (ptrdiff_t a = 0; a < actions; a++)
+                scale[a] = totals[a] != 0 ? 1.0 / totals[a] : 1.0;
+        }
+
+        _visitType(wtype, [&](auto wt)
+                   {
+            using W = decltype(wt);
+            std::vector<double> totals(actions, 0.0);
+
+            _forEachPosition(values, wdata, wstrides, options.group_axis, [&](const char *vp, const char *wp, size_t g)
+                             {
+                double *gn = num.data() + g * actions;
+                double *gd = den.data() + g * actions;
+                for (ptrdiff_t a = 0; a < actions; a++)
+                {
+                    double v = _load<V>(vp + a * as);
+                    if (options.absolute)
+                        v = std::abs(v);
+                    const double w = _load<W>(wp + a * was);
+
+                    if (options.mode == ReduceMode::SUM)
+                    {
+                        gn[a] += w * v;
+                        totals[a] += v;
+                    }
+                    else
+                    {
+                        v *= scale[a];
+                        gn[a] += w * v;
+                        gd[a] += std::max(w, v);
+                    }
+                } });
+
+            if (options.normalize && options.mode == ReduceMode::SUM)
+                for (ptrdiff_t a = 0; a < actions; a++)
+                    scale[a] = totals[a] != 0 ? 1.0 / totals[a] : 1.0; });
+
+        for (size_t g = 0; g < groups; g++)
+        {
+            for (ptrdiff_t a = 0; a < actions; a++)
+            {
+                const size_t i = g * actions + a;
+                out[i] = options.mode == ReduceMode::SUM ? num[i] * scale[a] : num[i] / (den[i] + 1.0);
+            }
+        } });
+}
+
+void Native::normalizeAttribution(const StridedView &values, bool absolute, float *out)
+{
+    _checkValues(values);
+
+    const ptrdiff_t actions = values.shape[values.ndim - 1];
+    const ptrdiff_t as = values.strides[values.ndim - 1];
+    const ptrdiff_t no_strides[StridedView::MAX_DIMS] = {};
+
+    _visitType(values.type, [&](auto vt)
+               {
+        using V = decltype(vt);
+        const auto totals = _actionTotals<V>(values, absolute);
+        std::vector<double> scale(actions);
+        for (ptrdiff_t a = 0; a < actions; a++)
+            scale[a] = totals[a] != 0 ? 1.0 / totals[a] : 1.0;
+
+        float *dst = out;
+        _forEachPosition(values, nullptr, no_strides, -1, [&](const char *vp, const char *, size_t)
+                         {
+            for (ptrdiff_t a = 0; a < actions; a++)
+            {
+                const double v = _load<V>(vp + a * as);
+                *dst++ = static_cast<float>((absolute ? std::abs(v) : v) * scale[a]);
+            } }); });
+}
@@ -0,0 +1,54 @@
+#ifndef NATIVE_REDUCE_HPP
+#define NATIVE_REDUCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Native
+{
+    enum class ScalarType
+    {
+        F32,
+        F64,
+        U8,
+    };
+
+    // n-d array described by byte strides, like a numpy view. A stride of 0 repeats the data
+    // along that axis, so np.broadcast_to results are read without being materialized.
+    struct StridedView
+    {
+        static constexpr int MAX_DIMS = 8;
+
+        const void *data = nullptr;
+        ScalarType type = ScalarType::F32;
+        int ndim = 0;
+        ptrdiff_t shape[MAX_DIMS] = {};
+        ptrdiff_t strides[MAX_DIMS] = {};
+    };
+
+    enum class ReduceMode
+    {
+        SUM,     // sum(w * v)
+        OVERLAP, // sum(w * v) / (sum(max(w, v)) + 1), soft overlap of a region mask and the attribution
+    };
+
+    struct ReduceOptions
+    {
+        ReduceMode mode = ReduceMode::SUM;
+        bool absolute = false;  // v = |v| first
+        bool normalize = false; // v /= sum of v over every non action axis (per action), skipped if that sum is 0
+        int group_axis = -1;    // >= 0: one result per index of this axis instead of summing over it
+    };
+
+    // values (..., A) with the action axis last, weights null (= 1) or broadcastable to values with
+    // numpy rules (a size 1 action axis shares the weights across actions).
+    // out is (groups, A), groups = values.shape[group_axis] or 1.
+    void maskedReduce(const StridedView &values, const StridedView *weights, const ReduceOptions &options,
+                      double *out);
+
+    // out (contiguous float, values' shape) = values (|values| if absolute) divided by its sum over
+    // every non action axis. The (possibly broadcast) input is read twice, the output written once.
+    void normalizeAttribution(const StridedView &values, bool absolute, float *out);
+}
+
+#endif // NATIVE_REDUCE_HPP
@@ -0,0 +1,121 @@
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "reduce.hpp"
+
+namespace py = pybind11;
+
+namespace
+{
+    // numpy view -> StridedView without copying. float32 / float64 / uint8 are read in place
+    // (broadcast and transposed views included), anything else (bool masks, ints) is converted once.
+    struct View
+    {
+        py::array owner;
+        Native::StridedView view;
+    };
+
+    View _view(const py::array &array)
+    {
+        View v;
+        if (py::isinstance<py::array_t<float>>(array))
+        {
+            v.owner = array;
+            v.view.type = Native::ScalarType::F32;
+        }
+        else if (py::isinstance<py::array_t<double>>(array))
+        {
+            v.owner = array;
+            v.view.type = Native::ScalarType::F64;
+        }
+        else if (py::isinstance<py::array_t<uint8_t>>(array))
+        {
+            v.owner = array;
+            v.view.type = Native::ScalarType::U8;
+        }
+        else
+        {
+            v.owner = py::array_t<float, py::array::forcecast>::ensure(array);
+            if (!v.owner)
+                throw std::invalid_argument("pearl_reduce: expected a numeric array");
+            v.view.type = Native::ScalarType::F32;
+        }
+
+        if (v.owner.ndim() > Native::StridedView::MAX_DIMS)
+            throw std::invalid_argument("pearl_reduce: at most 8 axes are supported");
+
+        v.view.data = v.owner.data();
+        v.view.ndim = static_cast<int>(v.owner.ndim());
+        for (int d = 0; d < v.view.ndim; d++)
+        {
+            v.view.shape[d] = v.owner.shape(d);
+            v.view.strides[d] = v.owner.strides(d);
+        }
+        return v;
+    }
+
+    py::array_t<double> _reduce(const py::array &values, const std::optional<py::array> &weights,
+                                Native::ReduceMode mode, bool absolute, bool normalize, std::optional<int> group_axis)
+    {
+        const View v = _view(values);
+        std::optional<View> w;
+        if (weights)
+            w = _view(*weights);
+
+        Native::ReduceOptions options{mode, absolute, normalize, -1};
+        if (group_axis)
+            options.group_axis = *group_axis < 0 ? *group_axis + v.view.ndim : *group_axis;
+
+        const ssize_t actions = v.view.ndim ? v.view.shape[v.view.ndim - 1] : 1;
+        py::array_t<double> out = options.group_axis >= 0 && options.group_axis < v.view.ndim
+                                      ? py::array_t<double>({static_cast<ssize_t>(v.view.shape[options.group_axis]), actions})
+                                      : py::array_t<double>(actions);
+        {
+            py::gil_scoped_release release;
+            Native::maskedReduce(v.view, w ? &w->view : nullptr, options, out.mutable_data());
+        }
+        return out;
+    }
+}
+
+py::array_t<double> maskedSum(const py::array &values, const std::optional<py::array> &weights, bool absolute,
+                              bool normalize, std::optional<int> group_axis)
+{
+    return _reduce(values, weights, Native::ReduceMode::SUM, absolute, normalize, group_axis);
+}
+
+py::array_t<double> overlap(const py::array &values, const py::array &masks, bool absolute, bool normalize,
+                            std::optional<int> group_axis)
+{
+    return _reduce(values, masks, Native::ReduceMode::OVERLAP, absolute, normalize, group_axis);
+}
+
+py::array_t<float> normalize(const py::array &values, bool absolute)
+{
+    const View v = _view(values);
+    std::vector<ssize_t> shape(v.view.shape, v.view.shape + v.view.ndim);
+
+    py::array_t<float> out(shape);
+    {
+        py::gil_scoped_release release;
+        Native::normalizeAttribution(v.view, absolute, out.mutable_data());
+    }
+    return out;
+}
+
+PYBIND11_EMBEDDED_MODULE(pearl_reduce, m)
+{
+    m.def("masked_sum", &maskedSum, py::arg("values"), py::arg("weights") = py::none(), py::arg("absolute") = false,
+          py::arg("normalize") = false, py::arg("group_axis") = py::none());
+
+    m.def("overlap", &overlap, py::arg("values"), py::arg("masks"), py::arg("absolute") = false,
+          py::arg("normalize") = false, py::arg("group_axis") = py::none());
+
+    m.def("normalize", &normalize, py::arg("values"), py::arg("absolute") = false);
+}
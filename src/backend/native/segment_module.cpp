@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "hash.hpp"
+#include "image_lime.hpp"
+#include "slic.hpp"
+
+namespace py = pybind11;
+
+using FloatArray = py::array_t<float, py::array::c_style | py::array::forcecast>;
+using ByteArray = py::array_t<uint8_t, py::array::c_style | py::array::forcecast>;
+using LabelArray = py::array_t<int32_t, py::array::c_style | py::array::forcecast>;
+
+namespace
+{
+    // (H, W) or (H, W, C) frame as interleaved float in [0, 1], uint8 frames are scaled by 1/255
+    struct Frame
+    {
+        int h = 0, w = 0, c = 1;
+        std::vector<float> data;
+        uint64_t hash = 0;
+    };
+
+    Frame _frame(const py::array &image)
+    {
+        if (image.ndim() != 2 && image.ndim() != 3)
+            throw std::invalid_argument("pearl_segment: image must be (H, W) or (H, W, C)");
+
+        Frame f;
+        f.h = static_cast<int>(image.shape(0));
+        f.w = static_cast<int>(image.shape(1));
+        f.c = image.ndim() == 3 ? static_cast<int>(image.shape(2)) : 1;
+        f.data.resize(static_cast<size_t>(f.h) * f.w * f.c);
+
+        if (py::isinstance<py::array_t<uint8_t>>(image))
+        {
+            const ByteArray bytes = ByteArray::ensure(image);
+            f.hash = Native::hashBytes(bytes.data(), bytes.size());
+            std::transform(bytes.data(), bytes.data() + bytes.size(), f.data.begin(),
+                           [](uint8_t v) { return v * (1.0f / 255.0f); });
+        }
+        else
+        {
+            const FloatArray floats = FloatArray::ensure(image);
+            if (!floats)
+                throw std::invalid_argument("pearl_segment: image must be numeric");
+            f.hash = Native::hashBytes(floats.data(), floats.size() * sizeof(float), 1);
+            std::copy_n(floats.data(), floats.size(), f.data.begin());
+        }
+        return f;
+    }
+
+    uint64_t _configHash(const Native::SlicConfig &config)
+    {
+        const float values[6] = {static_cast<float>(config.segments), config.compactness, config.sigma,
+                                 static_cast<float>(config.max_iter), static_cast<float>(config.convert_lab),
+                                 static_cast<float>(config.enforce_connectivity)};
+        return Native::hashBytes(values, sizeof(values));
+    }
+}
+
+// LRU of segmentations keyed by (frame content, slic parameters). Explaining the same frame
+// again (paused env, several methods on one observation) skips the segmentation.
+class SegmentCache
+{
+public:
+    explicit SegmentCache(size_t capacity) : capacity_(capacity) {}
+
+    // returns the labels (h * w) and their count, segmenting on a miss. Called without the GIL.
+    std::pair<const std::vector<int32_t> *, int> get(const Frame &frame, const Native::SlicConfig &config)
+    {
+        const uint64_t key = frame.hash ^ _configHash(config);
+
+        for (auto it = entries_.begin(); it != entries_.end(); ++it)
+        {
+            if (it->key == key && it->h == frame.h && it->w == frame.w)
+            {
+                hits_++;
+                entries_.splice(entries_.begin(), entries_, it);
+                return {&entries_.front().labels, entries_.front().count};
+            }
+        }
+
+        misses_++;
+        Entry entry{key, frame.h, frame.w, 0, std::vector<int32_t>(static_cast<size_t>(frame.h) * frame.w)};
+        entry.count = Native::slic(frame.data.data(), frame.h, frame.w, frame.c, config, entry.labels.data());
+        entries_.push_front(std::move(entry));
+        while (entries_.size() > std::max<size_t>(capacity_, 1))
+            entries_.pop_back();
+        return {&entries_.front().labels, entries_.front().count};
+    }
+
+    py::array_t<int32_t> segment(const py::array &image, int n_segments, float compactness, float sigma, int max_iter,
+                                 bool convert2lab)
+    {
+        const Frame frame = _frame(image);
+        const Native::SlicConfig config{n_segments, compactness, sigma, max_iter, convert2lab, true};
+
+        py::array_t<int32_t> labels({static_cast<ssize_t>(frame.h), static_cast<ssize_t>(frame.w)});
+        {
+            py::gil_scoped_release release;
+            const auto [cached, count] = get(frame, config);
+            std::copy(cached->begin(), cached->end(), labels.mutable_data());
+        }
+        return labels;
+    }
+
+    void clear() { entries_.clear(); }
+    size_t hits() const { return hits_; }
+    size_t misses() const { return misses_; }
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        int h, w;
+        int count;
+        std::vector<int32_t> labels;
+    };
+
+    size_t capacity_;
+    size_t hits_ = 0, misses_ = 0;
+    std::list<Entry> entries_;
+};
+
+py::array_t<int32_t> slicSegment(const py::array &image, int n_segments, float compactness, float sigma, int max_iter,
+                                 bool convert2lab, bool enforce_connectivity)
+{
+    const Frame frame = _frame(image);
+    const Native::SlicConfig config{n_segments, compactness, sigma, max_iter, convert2lab, enforce_connectivity};
+
+    py::array_t<int32_t> labels({static_cast<ssize_t>(frame.h), static_cast<ssize_t>(frame.w)});
+    {
+        py::gil_scoped_release release;
+        Native::slic(frame.data.data(), frame.h, frame.w, frame.c, config, labels.mutable_data());
+    }
+    return labels;
+}
+
+// image (..., H, W) planar, segments (H, W), samples (N, K) 0/1 -> (N, ...image.shape)
+py::array_t<float> maskedBatch(const FloatArray &image, const LabelArray &segments, const ByteArray &samples,
+                               float hide_color)
+{
+    if (image.ndim() < 2 || segments.ndim() != 2 || samples.ndim() != 2)
+        throw std::invalid_argument("masked_batch: expected image (..., H, W), segments (H, W), samples (N, K)");
+    if (image.shape(image.ndim() - 2) != segments.shape(0) || image.shape(image.ndim() - 1) != segments.shape(1))
+        throw std::invalid_argument("masked_batch: the last two image dims must match the segments");
+
+    const size_t pixels = static_cast<size_t>(segments.size());
+    const size_t planes = static_cast<size_t>(image.size()) / pixels;
+    const size_t count = static_cast<size_t>(samples.shape(0));
+    const size_t k = static_cast<size_t>(samples.shape(1));
+
+    const int32_t *labels = segments.data();
+    if (std::any_of(labels, labels + pixels, [k](int32_t l) { return l < 0 || static_cast<size_t>(l) >= k; }))
+        throw std::invalid_argument("masked_batch: segment ids must be in [0, " + std::to_string(k) + ")");
+
+    std::vector<ssize_t> shape{static_cast<ssize_t>(count)};
+    for (ssize_t d = 0; d < image.ndim(); d++)
+        shape.push_back(image.shape(d));
+
+    py::array_t<float> batch(shape);
+    {
+        py::gil_scoped_release release;
+        Native::maskedBatch(image.data(), planes, pixels, labels, samples.data(), count, k, hide_color,
+                            batch.mutable_data());
+    }
+    return batch;
+}
+
+// Python facing image LIME: cached segmentation / masked batch / one classifier_fn call / fit per output
+class ImageExplainer
+{
+public:
+    ImageExplainer(size_t num_samples, int n_segments, float compactness, float sigma, double alpha, uint64_t seed,
+                   size_t cache_size)
+        : lime_(Native::ImageLimeConfig{num_samples, 0.25f, alpha, seed}),
+          config_{n_segments, compactness, sigma, 10, true, true}, cache_(cache_size)
+    {
+    }
+
+    // seg_image (H, W[, C]) is segmented, target (..., H, W) is what classifier_fn consumes.
+    // returns {"segments", "coef": (outputs, K), "intercept", "samples": (N, K), "weights", "predictions"}
+    py::dict explain(const py::array &seg_image, const FloatArray &target, const py::function &classifier_fn,
+                     float hide_color)
+    {
+        const Frame frame = _frame(seg_image);
+
+        py::array_t<int32_t> segments({static_cast<ssize_t>(frame.h), static_cast<ssize_t>(frame.w)});
+        size_t k = 0;
+        {
+            py::gil_scoped_release release;
+            const auto [labels, count] = cache_.get(frame, config_);
+            std::copy(labels->begin(), labels->end(), segments.mutable_data());
+            k = static_cast<size_t>(count);
+            lime_.sample(k);
+        }
+
+        const size_t n = lime_.samples();
+        const ByteArray samples({static_cast<ssize_t>(n), static_cast<ssize_t>(k)}, lime_.mask().data());
+        const py::array_t<float> batch = maskedBatch(target, segments, samples, hide_color);
+
+        const FloatArray preds = FloatArray::ensure(classifier_fn(batch));
+        if (!preds || preds.ndim() == 0 || static_cast<size_t>(preds.shape(0)) != n)
+            throw std::runtime_error("ImageExplainer: classifier_fn must return one row per sample");
+        const size_t outputs = static_cast<size_t>(preds.size()) / n;
+
+        py::array_t<float> coef({static_cast<ssize_t>(outputs), static_cast<ssize_t>(k)});
+        py::array_t<float> intercept(static_cast<ssize_t>(outputs));
+        {
+            py::gil_scoped_release release;
+            lime_.fit(preds.data(), outputs, coef.mutable_data(), intercept.mutable_data());
+        }
+
+        const auto &w = lime_.weights();
+        py::dict result;
+        result["segments"] = segments;
+        result["coef"] = coef;
+        result["intercept"] = intercept;
+        result["samples"] = samples;
+        result["weights"] = py::array_t<float>(static_cast<ssize_t>(w.size()), w.data());
+        result["predictions"] = preds;
+        return result;
+    }
+
+    size_t samples() const { return lime_.samples(); }
+    SegmentCache &cache() { return cache_; }
+
+private:
+    Native::ImageLime lime_;
+    Native::SlicConfig config_;
+    SegmentCache cache_;
+};
+
+PYBIND11_EMBEDDED_MODULE(pearl_segment, m)
+{
+    m.def("slic", &slicSegment, py::arg("image"), py::arg("n_segments") = 100, py::arg("compactness") = 10.0f,
+          py::arg("sigma") = 1.0f, py::arg("max_iter") = 10, py::arg("convert2lab") = true,
+          py::arg("enforce_connectivity") = true);
+
+    m.def("masked_batch", &maskedBatch, py::arg("image"), py::arg("segments"), py::arg("samples"),
+          py::arg("hide_color") = 0.0f);
+
+    py::class_<SegmentCache>(m, "SegmentCache")
+        .def(py::init<size_t>(), py::arg("capacity") = 8)
+        .def("slic", &SegmentCache::segment, py::arg("image"), py::arg("n_segments") = 100,
+             py::arg("compactness") = 10.0f, py::arg("sigma") = 1.0f, py::arg("max_iter") = 10,
+             py::arg("convert2lab") = true)
+        .def("clear", &SegmentCache::clear)
+        .def_property_readonly("hits", &SegmentCache::hits)
+        .def_property_readonly("misses", &SegmentCache::misses)
+        .def("__len__", &SegmentCache::size);
+
+    py::class_<ImageExplainer>(m, "ImageExplainer")
+        .def(py::init<size_t, int, float, float, double, uint64_t, size_t>(), py::arg("num_samples") = 1000,
+             py::arg("n_segments") = 50, py::arg("compactness") = 10.0f, py::arg("sigma") = 1.0f,
+             py::arg("alpha") = 1.0, py::arg("seed") = 0, py::arg("cache_size") = 8)
+        .def("explain", &ImageExplainer::explain, py::arg("seg_image"), py::arg("target"), py::arg("classifier_fn"),
+             py::arg("hide_color") = 0.0f)
+        .def_property_readonly("samples", &ImageExplainer::samples)
+        .def_property_readonly("cache", &ImageExplainer::cache, py::return_value_policy::reference_internal);
+}
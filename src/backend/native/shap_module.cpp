@@ -0,0 +1,91 @@
+#include <stdexcept>
+#include <string>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "kernel_shap.hpp"
+
+namespace py = pybind11;
+
+using FloatArray = py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+// Python facing KernelSHAP: one sample / fill / model call / solve round trip per explain().
+// The model is called exactly once per explanation with the whole (rows, features) batch.
+class KernelExplainer
+{
+public:
+    KernelExplainer(size_t features, size_t samples, bool paired, uint64_t seed)
+        : shap_(features, Native::KernelShapConfig{samples, paired, seed})
+    {
+    }
+
+    // returns {"phi": (actions, features), "base": (actions,), "fx": (actions,)}
+    py::dict explain(const FloatArray &x, const py::function &model, const py::object &background)
+    {
+        const size_t M = shap_.features();
+        if (static_cast<size_t>(x.size()) != M)
+            throw std::invalid_argument("KernelExplainer: expected " + std::to_string(M) + " features, got " +
+                                        std::to_string(x.size()));
+
+        // zeros unless given, like the python explainer
+        FloatArray bg = background.is_none() ? FloatArray({static_cast<ssize_t>(1), static_cast<ssize_t>(M)})
+                                             : FloatArray::ensure(background);
+        if (!bg || bg.size() == 0 || static_cast<size_t>(bg.size()) % M != 0)
+            throw std::invalid_argument("KernelExplainer: background must be (rows, features)");
+        if (background.is_none())
+            std::fill(bg.mutable_data(), bg.mutable_data() + M, 0.0f);
+        const size_t bg_rows = static_cast<size_t>(bg.size()) / M;
+
+        FloatArray batch;
+        {
+            py::gil_scoped_release release;
+            shap_.sample();
+        }
+        batch = FloatArray({static_cast<ssize_t>(shap_.batchRows(bg_rows)), static_cast<ssize_t>(M)});
+        {
+            py::gil_scoped_release release;
+            shap_.fillBatch(x.data(), bg.data(), bg_rows, batch.mutable_data());
+        }
+
+        FloatArray outputs = FloatArray::ensure(model(batch));
+        if (!outputs || outputs.ndim() == 0 || static_cast<size_t>(outputs.shape(0)) != shap_.batchRows(bg_rows))
+            throw std::runtime_error("KernelExplainer: model must return one row per batch row");
+        const size_t actions = static_cast<size_t>(outputs.size()) / shap_.batchRows(bg_rows);
+
+        py::array_t<float> phi({static_cast<ssize_t>(actions), static_cast<ssize_t>(M)});
+        py::array_t<float> base(static_cast<ssize_t>(actions));
+        py::array_t<float> fx(static_cast<ssize_t>(actions));
+        {
+            py::gil_scoped_release release;
+            shap_.solve(outputs.data(), bg_rows, actions, phi.mutable_data(), base.mutable_data(), fx.mutable_data());
+        }
+
+        py::dict result;
+        result["phi"] = phi;
+        result["base"] = base;
+        result["fx"] = fx;
+        return result;
+    }
+
+    size_t features() const { return shap_.features(); }
+    size_t coalitions() const { return shap_.coalitions(); }
+    bool exact() const { return shap_.exact(); }
+
+private:
+    Native::KernelShap shap_;
+};
+
+PYBIND11_EMBEDDED_MODULE(pearl_shap, m)
+{
+    py::class_<KernelExplainer>(m, "KernelExplainer")
+        .def(py::init<size_t, size_t, bool, uint64_t>(),
+             py::arg("features"), py::arg("samples") = 0, py::arg("paired") = true, py::arg("seed") = 0)
+        .def("explain", &KernelExplainer::explain,
+             py::arg("x"), py::arg("model"), py::arg("background") = py::none())
+        .def_property_readonly("features", &KernelExplainer::features)
+        // coalitions evaluated by the last explain()
+        .def_property_readonly("coalitions", &KernelExplainer::coalitions)
+        .def_property_readonly("exact", &KernelExplainer::exact);
+}
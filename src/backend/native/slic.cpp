@@ -0,0 +1,285 @@
+#include "slic.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    // scipy 'reflect' (d c b a | a b c d | d c b a)
+    inline int _reflect(int i, int n)
+    {
+        while (i < 0 || i >= n)
+        {
+            i = i < 0 ? -i - 1 : 2 * n - i - 1;
+        }
+        return i;
+    }
+
+    inline float _labF(float t)
+    {
+        return t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f;
+    }
+
+    inline float _linear(float c)
+    {
+        return c > 0.04045f ? std::pow((c + 0.055f) / 1.055f, 2.4f) : c / 12.92f;
+    }
+}
+
+void Native::gaussianBlur(float *image, int h, int w, int c, float sigma)
+{
+    if (sigma <= 0 || h <= 0 || w <= 0)
+        return;
+
+    const int radius = static_cast<int>(4.0f * sigma + 0.5f);
+    std::vector<float> kernel(2 * radius + 1);
+    float sum = 0;
+    for (int i = -radius; i <= radius; i++)
+    {
+        kernel[i + radius] = std::exp(-0.5f * i * i / (sigma * sigma));
+        sum += kernel[i + radius];
+    }
+    for (auto &k : kernel)
+        k /= sum;
+
+    std::vector<float> tmp(static_cast<size_t>(h) * w * c);
+
+    // horizontal into tmp
+    for (int y = 0; y < h; y++)
+    {
+        const float *row = image + static_cast<size_t>(y) * w * c;
+        float *out = tmp.data() + static_cast<size_t>(y) * w * c;
+        for (int x = 0; x < w; x++)
+        {
+            for (int ch = 0; ch < c; ch++)
+            {
+                float acc = 0;
+                for (int k = -radius; k <= radius; k++)
+                    acc += kernel[k + radius] * row[_reflect(x + k, w) * c + ch];
+                out[x * c + ch] = acc;
+            }
+        }
+    }
+
+    // vertical back into image
+    const size_t stride = static_cast<size_t>(w) * c;
+    for (int y = 0; y < h; y++)
+    {
+        float *out = image + y * stride;
+        std::fill(out, out + stride, 0.0f);
+        for (int k = -radius; k <= radius; k++)
+        {
+            const float weight = kernel[k + radius];
+            const float *src = tmp.data() + _reflect(y + k, h) * stride;
+            for (size_t i = 0; i < stride; i++)
+                out[i] += weight * src[i];
+        }
+    }
+}
+
+void Native::rgbToLab(float *image, size_t pixels)
+{
+    for (size_t p = 0; p < pixels; p++)
+    {
+        float *px = image + p * 3;
+        const float r = _linear(px[0]), g = _linear(px[1]), b = _linear(px[2]);
+
+        const float x = (0.412453f * r + 0.357580f * g + 0.180423f * b) / 0.95047f;
+        const float y = 0.212671f * r + 0.715160f * g + 0.072169f * b;
+        const float z = (0.019334f * r + 0.119193f * g + 0.950227f * b) / 1.08883f;
+
+        const float fx = _labF(x), fy = _labF(y), fz = _labF(z);
+        px[0] = y > 0.008856f ? 116.0f * fy - 16.0f : 903.3f * y;
+        px[1] = 500.0f * (fx - fy);
+        px[2] = 200.0f * (fy - fz);
+    }
+}
+
+int Native::slic(const float *image, int h, int w, int c, const SlicConfig &config, int32_t *labels)
+{
+    if (h <= 0 || w <= 0 || c <= 0)
+        throw std::invalid_argument("slic: empty image");
+
+    const size_t pixels = static_cast<size_t>(h) * w;
+    std::vector<float> work(image, image + pixels * c);
+    gaussianBlur(work.data(), h, w, c, config.sigma);
+    if (config.convert_lab && c == 3)
+    {
+        rgbToLab(work.data(), pixels);
+    }
+    else if (config.convert_lab && c == 1)
+    {
+        // a gray frame is gray2rgb'd by skimage, its Lab a/b are 0 so only L matters
+        for (auto &v : work)
+        {
+            const float y = _linear(v);
+            v = y > 0.008856f ? 116.0f * std::cbrt(y) - 16.0f : 903.3f * y;
+        }
+    }
+
+    // grid seeded centers: y, x, colour...
+    const float step = std::sqrt(static_cast<float>(pixels) / std::max(1, config.segments));
+    const int ny = std::max(1, static_cast<int>(std::lround(h / step)));
+    const int nx = std::max(1, static_cast<int>(std::lround(w / step)));
+    const int k_count = ny * nx;
+    const int dims = 2 + c;
+
+    std::vector<float> centers(static_cast<size_t>(k_count) * dims);
+    for (int i = 0; i < ny; i++)
+    {
+        for (int j = 0; j < nx; j++)
+        {
+            float *center = centers.data() + static_cast<size_t>(i * nx + j) * dims;
+            const int cy = std::min(h - 1, static_cast<int>((i + 0.5f) * h / ny));
+            const int cx = std::min(w - 1, static_cast<int>((j + 0.5f) * w / nx));
+            center[0] = static_cast<float>(cy);
+            center[1] = static_cast<float>(cx);
+            std::copy_n(work.data() + (static_cast<size_t>(cy) * w + cx) * c, c, center + 2);
+        }
+    }
+
+    // D = |colour|^2 + |xy|^2 (compactness / S)^2, searched in a 2S window around each center
+    const float spatial = (config.compactness / step) * (config.compactness / step);
+    const int window = static_cast<int>(std::ceil(2 * step));
+
+    std::vector<float> distance(pixels);
+    std::vector<int32_t> assigned(pixels, -1);
+    std::vector<double> sums(static_cast<size_t>(k_count) * dims);
+    std::vector<size_t> counts(k_count);
+
+    for (int iter = 0; iter < config.max_iter; iter++)
+    {
+        std::fill(distance.begin(), distance.end(), std::numeric_limits<float>::max());
+        bool changed = false;
+
+        for (int k = 0; k < k_count; k++)
+        {
+            const float *center = centers.data() + static_cast<size_t>(k) * dims;
+            const int cy = static_cast<int>(center[0]), cx = static_cast<int>(center[1]);
+            const int y0 = std::max(0, cy - window), y1 = std::min(h, cy + window + 1);
+            const int x0 = std::max(0, cx - window), x1 = std::min(w, cx + window + 1);
+
+            for (int y = y0; y < y1; y++)
+            {
+                const float dy = y - center[0];
+                for (int x = x0; x < x1; x++)
+                {
+                    const size_t p = static_cast<size_t>(y) * w + x;
+                    const float dx = x - center[1];
+                    float d = (dy * dy + dx * dx) * spatial;
+
+                    const float *px = work.data() + p * c;
+                    for (int ch = 0; ch < c; ch++)
+                    {
+                        const float diff = px[ch] - center[2 + ch];
+                        d += diff * diff;
+                    }
+
+                    if (d < distance[p])
+                    {
+                        distance[p] = d;
+                        if (assigned[p] != k)
+                        {
+                            assigned[p] = k;
+                            changed = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (!changed)
+            break;
+
+        // move the centers to the mean of their pixels
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (int y = 0; y < h; y++)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                const size_t p = static_cast<size_t>(y) * w + x;
+                const int k = assigned[p];
+                if (k < 0)
+                    continue;
+                double *s = sums.data() + static_cast<size_t>(k) * dims;
+                s[0] += y;
+                s[1] += x;
+                for (int ch = 0; ch < c; ch++)
+                    s[2 + ch] += work[p * c + ch];
+                counts[k]++;
+            }
+        }
+
+        for (int k = 0; k < k_count; k++)
+        {
+            if (counts[k] == 0)
+                continue;
+            float *center = centers.data() + static_cast<size_t>(k) * dims;
+            for (int d = 0; d < dims; d++)
+                center[d] = static_cast<float>(sums[static_cast<size_t>(k) * dims + d] / counts[k]);
+        }
+    }
+
+    // relabel connected components, fragments below half the expected size join the
+    // neighbour visited before them (skimage's _enforce_label_connectivity_cython)
+    const size_t min_size = config.enforce_connectivity ? static_cast<size_t>(0.5 * pixels / k_count) : 0;
+    std::fill(labels, labels + pixels, -1);
+    std::vector<size_t> queue;
+    queue.reserve(pixels);
+    int32_t next = 0;
+
+    for (size_t start = 0; start < pixels; start++)
+    {
+        if (labels[start] >= 0)
+            continue;
+
+        const int32_t source = assigned[start];
+        const int sy = static_cast<int>(start / w), sx = static_cast<int>(start % w);
+
+        // label of an already visited neighbour, where a small fragment goes
+        int32_t adjacent = -1;
+        if (sx > 0)
+            adjacent = labels[start - 1];
+        else if (sy > 0)
+            adjacent = labels[start - w];
+
+        queue.clear();
+        queue.push_back(start);
+        labels[start] = next;
+
+        for (size_t q = 0; q < queue.size(); q++)
+        {
+            const size_t p = queue[q];
+            const int y = static_cast<int>(p / w), x = static_cast<int>(p % w);
+            const size_t neighbours[4] = {p - 1, p + 1, p - w, p + w};
+            const bool valid[4] = {x > 0, x < w - 1, y > 0, y < h - 1};
+
+            for (int n = 0; n < 4; n++)
+            {
+                if (!valid[n])
+                    continue;
+                const size_t np = neighbours[n];
+                if (labels[np] < 0 && assigned[np] == source)
+                {
+                    labels[np] = next;
+                    queue.push_back(np);
+                }
+            }
+        }
+
+        if (queue.size() < min_size && adjacent >= 0)
+        {
+            for (size_t p : queue)
+                labels[p] = adjacent;
+        }
+        else
+        {
+            next++;
+        }
+    }
+
+    return next;
+}
@@ -0,0 +1,34 @@
+#ifndef NATIVE_SLIC_HPP
+#define NATIVE_SLIC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Native
+{
+    struct SlicConfig
+    {
+        int segments = 100;       // approximate number of superpixels
+        float compactness = 10.f; // colour vs space trade off, higher = squarer segments
+        float sigma = 1.f;        // gaussian pre smoothing (pixels), 0 = off
+        int max_iter = 10;
+        bool convert_lab = true;  // cluster in CIELAB like skimage (1 channel = gray, L only)
+        bool enforce_connectivity = true;
+    };
+
+    // Separable gaussian blur of an interleaved (h, w, c) float image, reflect borders
+    // (scipy.ndimage.gaussian_filter with truncate=4)
+    void gaussianBlur(float *image, int h, int w, int c, float sigma);
+
+    // sRGB in [0, 1] to CIELAB (D65), in place on interleaved (pixels, 3)
+    void rgbToLab(float *image, size_t pixels);
+
+    // SLIC superpixels (Achanta et al. 2012), following skimage.segmentation.slic:
+    // grid seeded centers, k-means restricted to 2S windows, then small fragments are merged
+    // into a neighbour. image is interleaved (h, w, c) float in [0, 1], labels (h, w) get
+    // contiguous ids from 0. Returns the number of segments.
+    int slic(const float *image, int h, int w, int c, const SlicConfig &config, int32_t *labels);
+}
+
+#endif // NATIVE_SLIC_HPP
@@ -0,0 +1,98 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+Native::ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (size_t i = 1; i < threads; i++)
+    {
+        workers_.emplace_back(&ThreadPool::_run, this, i);
+    }
+}
+
+Native::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+Native::ThreadPool &Native::ThreadPool::global()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void Native::ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t, size_t)> &fn)
+{
+    if (count == 0)
+        return;
+
+    const size_t chunks = std::min(count, size());
+    if (chunks == 1)
+    {
+        fn(0, count, 0);
+        return;
+    }
+
+    // one job at a time, concurrent callers queue up here
+    std::lock_guard<std::mutex> submit(submit_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        count_ = count;
+        chunks_ = chunks;
+        pending_ = chunks - 1;
+        generation_++;
+    }
+    wake_.notify_all();
+
+    // caller takes chunk 0
+    fn(0, count / chunks, 0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]
+               { return pending_ == 0; });
+    job_ = nullptr;
+}
+
+void Native::ThreadPool::_run(size_t worker)
+{
+    size_t seen = 0;
+    while (true)
+    {
+        const std::function<void(size_t, size_t, size_t)> *job;
+        size_t begin, end;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&]
+                       { return stop_ || generation_ != seen; });
+            if (stop_)
+                return;
+
+            seen = generation_;
+            if (worker >= chunks_)
+                continue;
+
+            job = job_;
+            begin = count_ * worker / chunks_;
+            end = count_ * (worker + 1) / chunks_;
+        }
+
+        (*job)(begin, end, worker);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pending_ == 0)
+            done_.notify_one();
+    }
+}
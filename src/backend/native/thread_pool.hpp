@@ -0,0 +1,53 @@
+#ifndef NATIVE_THREAD_POOL_HPP
+#define NATIVE_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Native
+{
+    // Fixed set of worker threads for the native kernels. Only does fork/join style
+    // parallelFor, the calling thread takes a share of the work too.
+    // Callbacks must not touch python (they run without the GIL).
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(size_t threads = 0); // 0 = hardware concurrency
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // splits [0, count) into at most size() contiguous chunks and calls fn(begin, end, worker)
+        // for each, worker is in [0, size()) and can index per thread scratch. Blocks until done.
+        void parallelFor(size_t count, const std::function<void(size_t, size_t, size_t)> &fn);
+
+        // threads taking part in a parallelFor, including the caller
+        size_t size() const { return workers_.size() + 1; }
+
+        // process wide pool shared by the native modules
+        static ThreadPool &global();
+
+    private:
+        void _run(size_t worker);
+
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;
+        std::mutex submit_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+
+        const std::function<void(size_t, size_t, size_t)> *job_ = nullptr;
+        size_t count_ = 0;
+        size_t chunks_ = 0;
+        size_t pending_ = 0;
+        size_t generation_ = 0;
+        bool stop_ = false;
+    };
+}
+
+#endif // NATIVE_THREAD_POOL_HPP
@@ -1,8 +1,53 @@
 #include "py_agent.hpp"
+#include "../ui/modules/logger.hpp"
+
+bool PyAgent::loadNative()
+{
+    native_model.reset();
+    if (!py::hasattr(object, "native_model_path"))
+        return false;
+
+    py::object path = object.attr("native_model_path");
+    if (path.is_none())
+        return false;
+
+    try
+    {
+        native_model = std::make_shared<Native::Model>(py::str(path).cast<std::string>());
+    }
+    catch (const std::exception &e)
+    {
+        Logger::warning(std::string(e.what()) + ", falling back to the python predict.");
+        return false;
+    }
+
+    return true;
+}
 
 py::object PyAgent::predict(const py::object &observation) const
 {
-    return object.attr("predict")(observation);
+    if (!native_model)
+        return object.attr("predict")(observation);
+
+    auto input = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(observation);
+    if (!input || input.size() == 0 || static_cast<size_t>(input.size()) % native_model->inputSize() != 0)
+        return object.attr("predict")(observation);
+
+    // same contract as the python agents: (actions,) for a single observation, (batch, actions) otherwise
+    const size_t batch = static_cast<size_t>(input.size()) / native_model->inputSize();
+    const size_t actions = native_model->outputSize();
+
+    std::vector<ssize_t> shape = {static_cast<ssize_t>(actions)};
+    if (batch > 1)
+        shape.insert(shape.begin(), static_cast<ssize_t>(batch));
+    py::array_t<float> result(shape);
+
+    {
+        py::gil_scoped_release release;
+        const float *out = native_model->forward(input.data(), batch);
+        std::copy(out, out + batch * actions, result.mutable_data());
+    }
+    return result;
 }
 
 py::object PyAgent::get_q_net() const
@@ -5,14 +5,22 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
+#include <memory>
 #include <optional>
 
 #include "py_object.hpp"
+#include "native/model.hpp"
 
 namespace py = pybind11;
 
 struct PyAgent : public PyLiveObject
 {
+    // exported copy of the agent's network (agent.native_model_path), predict() runs it instead of python
+    std::shared_ptr<Native::Model> native_model;
+
+    // Loads the native model if the agent exposes one, returns true if it will be used
+    bool loadNative();
+
     // Predict method: returns np.ndarray (action probabilities)
     py::object predict(const py::object &observation) const;
 
@@ -77,3 +77,9 @@ std::optional<py::object> PyEnv::unwrapped() const
         return std::nullopt;
     return object.attr("unwrapped");
 }
+
+bool PyEnv::detectReleasesGil()
+{
+    releases_gil = py::getattr(object, "releases_gil", py::bool_(false)).cast<bool>();
+    return releases_gil;
+}
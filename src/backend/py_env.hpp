@@ -13,6 +13,11 @@ namespace py = pybind11;
 
 struct PyEnv : public PyVisualizable
 {
+    // env.releases_gil, its step() can run on a worker thread next to other envs
+    bool releases_gil = false;
+
+    // Reads: env.releases_gil (missing = false)
+    bool detectReleasesGil();
 
     // Call: env.reset(seed=..., options=...)
     std::pair<py::object, py::dict> reset(std::optional<int> seed = std::nullopt,
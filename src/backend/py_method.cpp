@@ -1,5 +1,8 @@
 #include "py_method.hpp"
 
+#include <stdexcept>
+#include <string>
+
 void PyMethod::set(const py::object &env) const
 {
     object.attr("set")(env);
@@ -29,3 +32,33 @@ double PyMethod::value(const py::object &obs) const
 {
     return object.attr("value")(obs).cast<double>();
 }
+
+bool PyMethod::detectBatched()
+{
+    batched = false;
+    const py::object cls = py::getattr(object, "__class__");
+    if (!py::hasattr(cls, "explain_batch"))
+        return false;
+
+    // the base class implementation only loops over value(), not worth grouping for
+    const py::object base = py::module_::import("pearl.method").attr("ExplainabilityMethod");
+    const py::object impl = cls.attr("explain_batch");
+    const py::object base_impl = base.attr("explain_batch");
+    batched = !(py::hasattr(impl, "__func__") && py::hasattr(base_impl, "__func__") &&
+                impl.attr("__func__").is(base_impl.attr("__func__")));
+    return batched;
+}
+
+std::vector<double> PyMethod::explainBatch(const py::list &methods, const py::list &observations) const
+{
+    const py::object result = py::getattr(object, "__class__").attr("explain_batch")(methods, observations);
+
+    std::vector<double> values;
+    for (const auto &v : result)
+        values.push_back(v.cast<double>());
+
+    if (values.size() != methods.size())
+        throw std::runtime_error("explain_batch returned " + std::to_string(values.size()) + " values for " +
+                                 std::to_string(methods.size()) + " methods");
+    return values;
+}
@@ -6,6 +6,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 #include <optional>
+#include <vector>
 
 #include "py_visualizable.hpp"
 
@@ -13,6 +14,12 @@ namespace py = pybind11;
 
 struct PyMethod : public PyVisualizable
 {
+    // the class overrides ExplainabilityMethod.explain_batch, the pipeline then scores all
+    // agents' instances of this method with one call per tick
+    bool batched = false;
+
+    // Checks for an explain_batch override, returns true if the method will be batched
+    bool detectBatched();
 
     // Calls: self.set(env)
     void set(const py::object &env) const;
@@ -31,6 +38,9 @@ struct PyMethod : public PyVisualizable
 
     // Calls: self.value(obs)
     double value(const py::object &obs) const;
+
+    // Calls: type(self).explain_batch(methods, observations) -> one value per (method, observation)
+    std::vector<double> explainBatch(const py::list &methods, const py::list &observations) const;
 };
 
 #endif // PY_METHOD_HPP
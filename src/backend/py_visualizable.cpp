@@ -23,6 +23,21 @@ std::optional<py::object> PyVisualizable::getVisualization(VisualizationMethod m
     return result;
 }
 
+std::optional<std::vector<std::string>> PyVisualizable::getVisualizationNames(VisualizationMethod m) const
+{
+    if (!py::hasattr(object, "getVisualizationNames"))
+        return std::nullopt;
+
+    py::object result = object.attr("getVisualizationNames")(static_cast<int>(m));
+    if (result.is_none())
+        return std::nullopt;
+
+    std::vector<std::string> names;
+    for (const auto name : result)
+        names.emplace_back(py::str(name));
+    return names;
+}
+
 std::vector<VisualizationMethod> PyVisualizable::getSupportedMethods() const
 {
     std::vector<VisualizationMethod> methods;
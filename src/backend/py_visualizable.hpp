@@ -3,6 +3,8 @@
 
 #include <pybind11/pybind11.h>
 #include <optional>
+#include <string>
+#include <vector>
 
 #include "py_object.hpp"
 #include "visualization_method.hpp"
@@ -21,6 +23,11 @@ struct PyVisualizable : public PyLiveObject
     // Optional: self.getVisualization(method, params) -> np.ndarray | None
     [[nodiscard]] std::optional<py::object> getVisualization(VisualizationMethod m, const py::object &params = py::none()) const;
 
+    // Optional: self.getVisualizationNames(method) -> list[str] | None
+    // names of the values a FEATURES / BAR_CHART array holds, asked once. Without them those
+    // visualizations come as {name: value} dicts
+    [[nodiscard]] std::optional<std::vector<std::string>> getVisualizationNames(VisualizationMethod m) const;
+
     std::vector<VisualizationMethod> getSupportedMethods() const;
 };
 
@@ -13,6 +13,8 @@
 #include "modules/pipeline_graph.hpp"
 #include "modules/preview.hpp"
 #include "modules/py_module_window.hpp"
+#include "modules/serving.hpp"
+#include "modules/exporter.hpp"
 #include "utility/image_store.hpp"
 
 namespace LabLayout
@@ -55,6 +57,8 @@ void LabLayout::init(const std::string &project_path)
     ObjectsPanel::init();
     Pipeline::init();
     Preview::init();
+    Serving::init();
+    Exporter::init();
 }
 
 void LabLayout::render()
@@ -215,6 +219,8 @@ void LabLayout::render()
         ImGui::DockBuilderDockWindow("Preview", center_top);
         ImGui::DockBuilderDockWindow("Pipeline Graph", center_top);
         ImGui::DockBuilderDockWindow("Event Log", center_bot);
+        ImGui::DockBuilderDockWindow("Serving", center_bot);
+        ImGui::DockBuilderDockWindow("Export", center_bot);
 
         ImGui::DockBuilderDockWindow("Inspector", right);
         ImGui::DockBuilderFinish(dockspace_id);
@@ -228,6 +234,7 @@ void LabLayout::render()
 
     // before we render any content
     Pipeline::update();
+    Serving::update();
 
     // Render individual windows
     renderParamsModule();
@@ -242,6 +249,8 @@ void LabLayout::render()
     ObjectsPanel::render();
     Pipeline::render();
     Preview::render();
+    Serving::render();
+    Exporter::render();
 }
 
 void LabLayout::destroy()
@@ -250,6 +259,8 @@ void LabLayout::destroy()
     PipelineGraph::destroy();
     SharedUi::destroy();
     ObjectsPanel::destroy();
+    Serving::destroy();
+    Exporter::destroy();
     Pipeline::destroy();
     Preview::destroy();
     PyScope::clearInstance();
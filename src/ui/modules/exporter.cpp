@@ -0,0 +1,329 @@
+#include "exporter.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "logger.hpp"
+#include "pipeline.hpp"
+#include "preview.hpp"
+#include "../utility/colormap.hpp"
+#include "../utility/frame_convert.hpp"
+#include "../utility/py_image.hpp"
+#include "../../backend/frame_exporter.hpp"
+#include "../../backend/py_safe_wrapper.hpp"
+
+namespace Exporter
+{
+    static std::unique_ptr<FrameExporter> exporter;
+    static ExportConfig config;
+    static char directory[512] = "exports";
+    static int queue_mb = 256;
+
+    static bool capturing = false;
+    static std::vector<char> selected; // per active agent
+    static std::vector<int64_t> exported_steps; // per active agent, the last step handed over
+    static bool captions = true;
+
+    // a method's heat map composited over the frame, -1 = plain frames
+    static int overlay_method = -1;
+    static float overlay_alpha = 0.5f;
+    static float overlay_threshold = 0.0f;
+    static int overlay_map = Colormap::VIRIDIS;
+
+    static std::string capture_error; // last one, logged once
+    static std::vector<float> heat;
+
+    void init()
+    {
+        exporter = std::make_unique<FrameExporter>();
+    }
+
+    // the preview's params for the object if it has a card, so the export shows what's on screen
+    static py::object _params(const PyVisualizable *visualizable, VisualizationMethod method)
+    {
+        for (const auto *preview : Preview::previews)
+        {
+            const Preview::VisualizedObject *obj = nullptr;
+            if (preview->env_visualization && preview->env_visualization->visualizable == visualizable)
+                obj = preview->env_visualization;
+            for (const auto *candidate : preview->method_visualizations)
+            {
+                if (candidate->visualizable == visualizable)
+                    obj = candidate;
+            }
+            if (obj && obj->params(method))
+                return obj->params(method)->object;
+        }
+        return py::none();
+    }
+
+    // file names only get letters, digits, '-' and '_'
+    static std::string _stream(int index, const char *name)
+    {
+        char prefix[16];
+        std::snprintf(prefix, sizeof(prefix), "%02d_", index);
+        std::string stream = prefix;
+        for (const char *c = name; *c; c++)
+            stream += std::isalnum(static_cast<unsigned char>(*c)) || *c == '-' || *c == '_' ? *c : '_';
+        return stream;
+    }
+
+    static std::string _caption(const Pipeline::ActiveAgent &agent)
+    {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%s | step %lld | episode %lld | reward %.2f (%.2f total)", agent.name,
+                      static_cast<long long>(agent.total_steps), static_cast<long long>(agent.total_episodes), agent.reward_ep,
+                      agent.reward_total);
+        std::string caption = line;
+
+        const auto &methods = Pipeline::PipelineConfig::pipelineMethods;
+        std::string scores;
+        for (size_t i = 0; i < agent.scores_ep.size() && i < methods.size(); i++)
+        {
+            if (!methods[i].active)
+                continue;
+            std::snprintf(line, sizeof(line), "%s%s: %.2f", scores.empty() ? "" : " | ", methods[i].name, agent.scores_ep[i]);
+            scores += line;
+        }
+        if (!scores.empty())
+            caption += "\n" + scores;
+        return caption;
+    }
+
+    // env frame -> packed rgb, with the overlay blended in. Throws through SafeWrapper
+    static bool _capture(const Pipeline::ActiveAgent &agent, std::vector<uint8_t> &rgb, int &width, int &height)
+    {
+        auto data = agent.env->getVisualization(VisualizationMethod::RGB_ARRAY, _params(agent.env, VisualizationMethod::RGB_ARRAY));
+        if (!data.has_value())
+        {
+            capture_error = "No RGB Array visualization available for object: " + std::string(agent.env->moduleName);
+            return false;
+        }
+
+        py::array arr;
+        FrameConvert::ImageView view;
+        if (!PyImage::ingest(*data, arr, view, capture_error))
+            return false;
+
+        width = view.width;
+        height = view.height;
+        rgb.resize(static_cast<size_t>(width) * height * 3);
+        if (view.channels == 1)
+        {
+            FrameConvert::grayToRgb(view, rgb.data());
+        }
+        else
+        {
+            view.channels = 3; // rgba: the strides still step over alpha
+            FrameConvert::toU8(view, rgb.data());
+        }
+
+        if (overlay_method < 0 || overlay_method >= static_cast<int>(agent.methods.size()))
+            return true;
+
+        PyMethod *method = agent.methods[overlay_method];
+        auto heat_data = method->getVisualization(VisualizationMethod::HEAT_MAP, _params(method, VisualizationMethod::HEAT_MAP));
+        if (!heat_data.has_value())
+            return true; // nothing to overlay this step, the frame still goes out
+
+        py::array heat_arr;
+        FrameConvert::ImageView heat_view;
+        if (!PyImage::ingest(*heat_data, heat_arr, heat_view, capture_error))
+            return true;
+
+        heat.resize(static_cast<size_t>(heat_view.width) * heat_view.height);
+        FrameConvert::toFloat(heat_view, heat.data());
+        float min, max;
+        FrameConvert::minMax(heat.data(), heat.size(), min, max);
+        if (min <= max) // per step range, like the preview's default
+            Colormap::overlayRgb(rgb.data(), width, height, heat.data(), heat_view.width, heat_view.height,
+                                 static_cast<Colormap::Map>(overlay_map), min, max, overlay_alpha, overlay_threshold);
+        return true;
+    }
+
+    void onStep()
+    {
+        if (!capturing || !exporter || !exporter->running())
+            return;
+
+        auto &agents = Pipeline::PipelineState::activeAgents;
+        selected.resize(agents.size(), 1);
+        exported_steps.resize(agents.size(), -1);
+        for (int i = 0; i < static_cast<int>(agents.size()); i++)
+        {
+            // done or paused agents don't step every tick, their frame is already on disk
+            if (!selected[i] || !agents[i].env || agents[i].total_steps == exported_steps[i])
+                continue;
+            exported_steps[i] = agents[i].total_steps;
+
+            const std::string previous_error = capture_error;
+            std::vector<uint8_t> rgb;
+            int width = 0, height = 0;
+            bool captured = false;
+            SafeWrapper::execute([&]
+                                 { captured = _capture(agents[i], rgb, width, height); });
+
+            if (capture_error != previous_error && !capture_error.empty())
+                Logger::error("Export: " + capture_error);
+            if (!captured)
+                continue;
+
+            exporter->submit(_stream(i, agents[i].name), agents[i].total_steps, std::move(rgb), width, height,
+                             captions ? _caption(agents[i]) : std::string());
+        }
+    }
+
+    void onStop()
+    {
+        if (!capturing)
+            return;
+
+        capturing = false;
+        exported_steps.clear();
+        const ExportStats stats = exporter->stats();
+        if (stats.queued_frames > 0)
+            Logger::info("Export: writing the last " + std::to_string(stats.queued_frames) + " frames.");
+    }
+
+    static void _start()
+    {
+        config.directory = directory;
+        config.max_queued_bytes = static_cast<size_t>(queue_mb) << 20;
+        capture_error.clear();
+        exported_steps.clear();
+        try
+        {
+            exporter->start(config);
+            capturing = true;
+            Logger::info("Export: writing to " + config.directory);
+        }
+        catch (const std::exception &e)
+        {
+            Logger::error(e.what());
+        }
+    }
+
+    static void _render_stats()
+    {
+        const ExportStats stats = exporter->stats();
+        ImGui::Text("Written: %llu frames", static_cast<unsigned long long>(stats.written));
+        ImGui::Text("Dropped: %llu frames", static_cast<unsigned long long>(stats.dropped));
+        ImGui::Text("Queued: %zu frames, %.1f MB", stats.queued_frames, stats.queued_bytes / (1024.0 * 1024.0));
+        if (!stats.error.empty())
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", stats.error.c_str());
+
+        // stopped capturing, the queue ran dry and the last frame is on disk: the worker is only
+        // waiting, so stop() closes the files without blocking on an encode
+        if (!capturing && stats.queued_frames == 0 && !stats.writing)
+        {
+            exporter->stop();
+            Logger::info("Export: done, " + std::to_string(stats.written) + " frames in " + config.directory);
+        }
+    }
+
+    void render()
+    {
+        ImGui::Begin("Export");
+
+        auto &agents = Pipeline::PipelineState::activeAgents;
+        const bool running = exporter && exporter->running();
+
+        if (capturing)
+        {
+            if (ImGui::Button("Stop Export"))
+                capturing = false;
+        }
+        else if (running)
+        {
+            ImGui::TextDisabled("Finishing...");
+        }
+        else if (agents.empty())
+        {
+            ImGui::TextDisabled("Start an experiment to export its agents.");
+        }
+        else if (ImGui::Button("Start Export"))
+        {
+            _start();
+        }
+
+        if (running)
+            ImGui::BeginDisabled();
+
+        ImGui::TextDisabled("Output");
+        ImGui::InputText("Directory", directory, sizeof(directory));
+        int format = static_cast<int>(config.format);
+        ImGui::Combo("Format", &format, "Y4M video\0PNG sequence\0");
+        config.format = static_cast<ExportFormat>(format);
+        ImGui::InputInt("FPS", &config.fps);
+        ImGui::InputInt("Queue (MB)", &queue_mb, 16, 128);
+        config.fps = std::max(config.fps, 1);
+        queue_mb = std::max(queue_mb, 16);
+
+        if (running)
+            ImGui::EndDisabled();
+
+        ImGui::Separator();
+        ImGui::TextDisabled("Agents");
+        selected.resize(agents.size(), 1);
+        for (int i = 0; i < static_cast<int>(agents.size()); i++)
+        {
+            ImGui::PushID(i);
+            bool on = selected[i];
+            if (ImGui::Checkbox(agents[i].name, &on))
+                selected[i] = on;
+            ImGui::PopID();
+        }
+
+        ImGui::Separator();
+        ImGui::TextDisabled("Frames");
+        ImGui::Checkbox("Captions (.srt)", &captions);
+
+        const auto &methods = Pipeline::PipelineConfig::pipelineMethods;
+        if (overlay_method >= static_cast<int>(methods.size()))
+            overlay_method = -1;
+        if (ImGui::BeginCombo("Overlay", overlay_method < 0 ? "None" : methods[overlay_method].name))
+        {
+            if (ImGui::Selectable("None", overlay_method < 0))
+                overlay_method = -1;
+            for (int i = 0; i < static_cast<int>(methods.size()); i++)
+            {
+                ImGui::PushID(i);
+                if (ImGui::Selectable(methods[i].name, i == overlay_method))
+                    overlay_method = i;
+                ImGui::PopID();
+            }
+            ImGui::EndCombo();
+        }
+        if (overlay_method >= 0)
+        {
+            ImGui::Combo("Colormap", &overlay_map, Colormap::mapNames, Colormap::MAP_COUNT);
+            ImGui::SliderFloat("Alpha", &overlay_alpha, 0.0f, 1.0f);
+            ImGui::SliderFloat("Threshold", &overlay_threshold, 0.0f, 1.0f);
+        }
+
+        if (running)
+        {
+            ImGui::Separator();
+            ImGui::TextDisabled("Stats");
+            _render_stats();
+        }
+
+        ImGui::End();
+    }
+
+    void destroy()
+    {
+        // whatever is still queued gets written before the files close
+        capturing = false;
+        if (exporter)
+            exporter->stop();
+        exporter.reset();
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef EXPORTER_HPP
+#define EXPORTER_HPP
+
+namespace Exporter
+{
+    // the export window: selected agents' env frames, optionally with a method's heat map over
+    // them and the scores as captions, written to disk by a FrameExporter on its own thread
+
+    void init();
+    void render();
+
+    // after every simulation tick, GIL held. Fetches and converts the frames and hands them
+    // over, nothing here draws or waits on the encoder
+    void onStep();
+    // the experiment went away: capturing stops, what's queued still gets written
+    void onStop();
+
+    void destroy();
+}
+
+#endif // EXPORTER_HPP
@@ -1,10 +1,14 @@
 #include "pipeline.hpp"
 
+#include "exporter.hpp"
 #include "logger.hpp"
 #include "../font_manager.hpp"
 #include "imgui_internal.h"
 #include "preview.hpp"
 #include "../../backend/py_safe_wrapper.hpp"
+#include "../../backend/native/thread_pool.hpp"
+
+#include <exception>
 
 namespace Pipeline
 {
@@ -20,6 +24,8 @@ namespace Pipeline
         int maxEpisodes = 4000; // default max episodes for an agent
         int activeEnv = 0;      // the index of the current active env
 
+        char preprocessSpec[256] = "";
+
         std::vector<PipelineAgent> pipelineAgents{};
         std::vector<PipelineMethod> pipelineMethods{};
 
@@ -104,14 +110,25 @@ namespace Pipeline
                     py::getattr(activeAgent.agent->object, "__class__"), *activeAgent.agent
                 );
 
+                if (activeAgent.agent->loadNative()) {
+                    Logger::info(std::string(activeAgent.name) + ": using native model " + activeAgent.agent->native_model->path());
+                }
+
                 activeAgent.env               = new PyEnv();
                 activeAgent.env->object       = envs[PipelineConfig::activeEnv].create();
                 if (activeAgent.env->object.is_none()) {
                     throw std::runtime_error("Failed to create environment for agent: " + std::string(activeAgent.name));
                 }
+
+                // agents, methods and the preview all see the chain's output
+                if (PipelineConfig::preprocessSpec[0] != '\0') {
+                    activeAgent.env->object = py::module_::import("pearl.enviroments.PreprocessedEnv")
+                        .attr("PreprocessedEnv")(activeAgent.env->object, std::string(PipelineConfig::preprocessSpec));
+                }
                 PyScope::parseLoadedModule(
                     py::getattr(activeAgent.agent->object, "__class__"), *activeAgent.env
                 );
+                activeAgent.env->detectReleasesGil();
 
                 activeAgent.reward_total = 0;
                 activeAgent.reward_ep    = 0;
@@ -135,6 +152,7 @@ namespace Pipeline
                     PyScope::parseLoadedModule(
                         py::getattr(methodPtr->object, "__class__"), *methodPtr
                     );
+                    methodPtr->detectBatched();
 
                     activeAgent.methods      .push_back(methodPtr);
                     activeAgent.scores_total .push_back(0);
@@ -182,6 +200,7 @@ namespace Pipeline
         _clearActiveAgents();
         Logger::info("Experiment stopped.");
         Preview::onStop();
+        Exporter::onStop();
     }
 
     bool isSimRunning()
@@ -237,41 +256,74 @@ namespace Pipeline
         }
     }
 
-    static void _do_one_step(int action = -1, int agent = -1)
+    // an agent that stepped this tick and the observation its action was chosen on
+    struct SteppedAgent
     {
-        if (!isExperimenting())
-        {
-            Logger::info("Unable to step, Experiment is not running.");
-            return;
-        }
+        int agent;
+        py::object observation;
+    };
 
-        if (agent == -1)
-        {
-            for (int i = 0; i < PipelineState::activeAgents.size(); ++i)
-            {
-                _do_one_step(action, i);
-            }
+    // scores the methods of every agent that stepped. Instances of the same method (same
+    // pipeline method index) whose class implements explain_batch get one call for all agents.
+    static void _score_agents(const std::vector<SteppedAgent> &stepped)
+    {
+        if (stepped.empty())
             return;
-        }
 
-        if (agent < 0 || agent >= PipelineState::activeAgents.size())
+        const size_t method_count = PipelineState::activeAgents[stepped.front().agent].methods.size();
+        for (size_t i = 0; i < method_count; ++i)
         {
-            Logger::error("Invalid agent index, tried to update state for agent[" + std::to_string(agent) + "] which doesn't exist.");
-            return;
+            SafeWrapper::execute([&]
+                                 {
+                const PyMethod *first = PipelineState::activeAgents[stepped.front().agent].methods[i];
+                std::vector<double> values;
+
+                if (stepped.size() > 1 && first->batched) {
+                    py::list instances, observations;
+                    for (const auto& s: stepped) {
+                        instances.append(PipelineState::activeAgents[s.agent].methods[i]->object);
+                        observations.append(s.observation);
+                    }
+                    values = first->explainBatch(instances, observations);
+                } else {
+                    for (const auto& s: stepped) {
+                        values.push_back(PipelineState::activeAgents[s.agent].methods[i]->value(s.observation));
+                    }
+                }
+
+                for (size_t k = 0; k < stepped.size(); ++k) {
+                    auto& target_agent = PipelineState::activeAgents[stepped[k].agent];
+                    target_agent.scores_total[i] += values[k];
+                    target_agent.scores_ep   [i] += values[k];
+                } });
         }
+    }
 
+    // one agent's step split in phases, so the env steps of a tick can run concurrently
+    struct PendingStep
+    {
+        int agent;
+        int action;
+        py::object observation; // pre step observation
+        std::tuple<py::object, py::dict, bool, bool, py::dict> result;
+        std::exception_ptr error; // raised by env.step on a worker thread
+    };
+
+    // picks the action of one agent, -1 if it doesn't step
+    static int _choose_action(int action, int agent)
+    {
         auto &target_agent = PipelineState::activeAgents[agent];
 
         if (target_agent.env_terminated || target_agent.env_truncated)
         {
-            return;
+            return -1;
         } // nothing to do
 
         auto actions = target_agent.env->get_available_actions();
         if (!actions)
         {
             Logger::error("Unable to retrieve actions, agent[" + std::to_string(agent) + "] environment didn't provide actions, unable to step.");
-            return;
+            return -1;
         }
 
         if (action == -1)
@@ -353,37 +405,177 @@ namespace Pipeline
             }
         }
 
-        if (action != -1)
+        return action;
+    }
+
+    // reads the observation and notifies the methods, false if the agent doesn't step
+    static bool _begin_step(PendingStep &step)
+    {
+        step.action = _choose_action(step.action, step.agent);
+        if (step.action == -1)
+            return false;
+
+        auto &target_agent = PipelineState::activeAgents[step.agent];
+        return SafeWrapper::execute([&]
+                                    {
+            // get the observations
+            step.observation = target_agent.env->get_observations();
+
+            // notify all explainability methods
+            for (auto& method: target_agent.methods) {
+                method->onStep(py::int_(step.action));
+            } });
+    }
+
+    // do the action, needs the GIL
+    static void _env_step(PendingStep &step)
+    {
+        step.result = PipelineState::activeAgents[step.agent].env->step(py::int_(step.action));
+    }
+
+    static void _finish_step(PendingStep &step)
+    {
+        auto &target_agent = PipelineState::activeAgents[step.agent];
+        const auto &result = step.result;
+
+        for (auto &method : target_agent.methods)
+        {
+            method->onStepAfter(py::int_(step.action), std::get<1>(result), std::get<2>(result) || std::get<3>(result), std::get<4>(result));
+        }
+
+        // update agent analytics
+        target_agent.total_steps += 1;
+        target_agent.steps_current_episode += 1;
+        target_agent.env_terminated = std::get<2>(result);
+        target_agent.env_truncated = std::get<3>(result);
+    }
+
+    // picks and applies the action of one agent, returns the pre step observation or None if it didn't step
+    static py::object _step_agent(int action, int agent)
+    {
+        PendingStep step{agent, action};
+        if (!_begin_step(step))
+            return py::none();
+
+        py::object ops = py::none();
+        SafeWrapper::execute([&]
+                             {
+            _env_step(step);
+            _finish_step(step);
+
+            // only scored once the step went through
+            ops = step.observation; });
+        return ops;
+    }
+
+    // own pool: env steps may call into native kernels that use the global one
+    static Native::ThreadPool &_env_pool()
+    {
+        static Native::ThreadPool pool;
+        return pool;
+    }
+
+    // every agent's env.step of the tick on the pool, results applied in agent order afterwards
+    // so the outcome doesn't depend on thread timing. Only for envs that declare releases_gil,
+    // an opt in no bundled env makes (GymRLEnv(releases_gil=True) is the only way in)
+    static std::vector<SteppedAgent> _step_agents_concurrently(int action)
+    {
+        std::vector<PendingStep> pending;
+        for (int i = 0; i < PipelineState::activeAgents.size(); ++i)
+        {
+            PendingStep step{i, action};
+            if (_begin_step(step))
+                pending.push_back(std::move(step));
+        }
+
+        {
+            // the workers take the GIL around env.step, which releases it again while emulating
+            py::gil_scoped_release release;
+            _env_pool().parallelFor(pending.size(), [&](size_t begin, size_t end, size_t)
+                                    {
+                for (size_t k = begin; k < end; ++k)
+                {
+                    py::gil_scoped_acquire gil;
+                    try
+                    {
+                        _env_step(pending[k]);
+                    }
+                    catch (...)
+                    {
+                        pending[k].error = std::current_exception();
+                    }
+                } });
+        }
+
+        std::vector<SteppedAgent> stepped;
+        for (auto &step : pending)
         {
             SafeWrapper::execute([&]
                                  {
-                // get the observations
-                auto ops = target_agent.env->get_observations();
+                if (step.error)
+                    std::rethrow_exception(step.error);
+                _finish_step(step);
+                stepped.push_back({step.agent, step.observation}); });
+            step.error = nullptr; // the python error must go away with the GIL held
+        }
+        return stepped;
+    }
 
-                // notify all explainability methods
-                for (auto& method: target_agent.methods) {
-                    method->onStep(py::int_(action));
-                }
+    static bool _all_envs_release_gil()
+    {
+        if (PipelineState::activeAgents.size() < 2)
+            return false;
+        for (const auto &active : PipelineState::activeAgents)
+        {
+            if (!active.env->releases_gil)
+                return false;
+        }
+        return true;
+    }
 
-                // do the action
-                auto result = target_agent.env->step(py::int_(action));
+    static void _do_one_step(int action = -1, int agent = -1)
+    {
+        if (!isExperimenting())
+        {
+            Logger::info("Unable to step, Experiment is not running.");
+            return;
+        }
 
-                for (auto& method: target_agent.methods) {
-                    method->onStepAfter(py::int_(action), std::get<1>(result), std::get<2>(result) || std::get<3>(result), std::get<4>(result));
+        if (agent == -1)
+        {
+            // every agent steps first, then the methods score them all at once so batched
+            // methods see the whole tick
+            std::vector<SteppedAgent> stepped;
+            if (_all_envs_release_gil())
+            {
+                stepped = _step_agents_concurrently(action);
+            }
+            else
+            {
+                for (int i = 0; i < PipelineState::activeAgents.size(); ++i)
+                {
+                    auto ops = _step_agent(action, i);
+                    if (!ops.is_none())
+                        stepped.push_back({i, std::move(ops)});
                 }
+            }
+            _score_agents(stepped);
+            Preview::onStep();
+            Exporter::onStep();
+            return;
+        }
 
-                // update agent analytics
-                target_agent.total_steps           += 1;
-                target_agent.steps_current_episode += 1;
-                target_agent.env_terminated = std::get<2>(result);
-                target_agent.env_truncated  = std::get<3>(result);
-
-                for (int i = 0; i < target_agent.methods.size(); ++i) {
-                    auto value = target_agent.methods[i]->value(ops);
-                    target_agent.scores_total[i] += value;
-                    target_agent.scores_ep   [i] += value;
-                } });
+        if (agent < 0 || agent >= PipelineState::activeAgents.size())
+        {
+            Logger::error("Invalid agent index, tried to update state for agent[" + std::to_string(agent) + "] which doesn't exist.");
+            return;
         }
+
+        auto ops = _step_agent(action, agent);
+        if (!ops.is_none())
+            _score_agents({{agent, std::move(ops)}});
+        Preview::onStep();
+        Exporter::onStep();
     }
 
     void stepSim(int action_index)
@@ -575,6 +767,14 @@ namespace Pipeline
         ImGui::SameLine();
         ImGui::Text("Environment");
 
+        ImGui::InputTextWithHint("Preprocess", "gray,resize=84x84,normalize,stack=4", PipelineConfig::preprocessSpec,
+                                 IM_ARRAYSIZE(PipelineConfig::preprocessSpec));
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Native per step chain run on the environment's frames:\n"
+                              "maxpool, gray, crop=top:left:h:w, resize=HxW, normalize[=mean:std], stack=N");
+        }
+
         ImGui::InputInt("Max Steps", &PipelineConfig::maxSteps);
         ImGui::InputInt("Max Episodes", &PipelineConfig::maxEpisodes);
 
@@ -67,6 +67,9 @@ namespace Pipeline
         extern int maxEpisodes; // default max episodes for an agent
         extern int activeEnv;   // the index of the current active env
 
+        // native preprocessing chain applied to every env (pearl.preprocess spec), empty = none
+        extern char preprocessSpec[256];
+
         extern std::vector<PipelineAgent> pipelineAgents;
         extern std::vector<PipelineMethod> pipelineMethods;
     }
@@ -1,86 +1,307 @@
 #include "preview.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <imgui.h>
 
 #include "logger.hpp"
 #include "pipeline.hpp"
 #include "../font_manager.hpp"
 #include "../../backend/py_safe_wrapper.hpp"
+#include "../utility/colormap.hpp"
+#include "../utility/frame_convert.hpp"
+#include "../utility/frame_history.hpp"
 #include "../utility/gl_texture.hpp"
 #include "../utility/image_store.hpp"
+#include "../utility/py_image.hpp"
+#include "../utility/texture_atlas.hpp"
 
-void Preview::VisualizedObject::init(PyVisualizable *obj)
+namespace
 {
-    this->visualizable = obj;
+    // converts straight into the texture's upload buffer, no per frame allocation.
+    // The texture gets (re)allocated on the first frame and whenever the size changes
+    template <typename Convert>
+    void _upload(GLTexture *texture, int width, int height, int channels, Convert &&convert)
+    {
+        if (texture->width() != width || texture->height() != height || texture->channels() != channels)
+            texture->set(static_cast<const unsigned char *>(nullptr), width, height, channels);
+
+        convert(texture->stage());
+        texture->commit();
+    }
+
+    // env frames and heat maps kept for the scrub bar. Off until asked for, then onStep()
+    // records every step of every agent, whether its preview is drawn, collapsed or hidden
+    bool _history_record = false;
+    int _history_mb = 64; // per view
+    int64_t _scrub_step = -1; // -1 = live
 
-    if (visualizable->supports(VisualizationMethod::RGB_ARRAY))
+    void _record(FrameHistory &history, int64_t step, const void *data, int width, int height, int channels, bool is_float)
     {
-        _init_rgb_array();
+        if (!_history_record)
+            return;
+        history.setCapacity(static_cast<size_t>(_history_mb) << 20);
+        history.push(step, data, width, height, channels, is_float);
     }
 
-    if (visualizable->supports(VisualizationMethod::GRAY_SCALE))
+    std::vector<uint8_t> _record_rgb;
+    std::vector<float> _record_heat;
+
+    // every agent's env frame as a thumbnail in one texture, the mosaic tab draws them all
+    // with one bind
+    TextureAtlas _mosaic;
+    int _mosaic_cell = 96; // texels
+    std::vector<uint8_t> _thumbnail_scratch;
+
+    void _upload_thumbnail(int cell, FrameConvert::ImageView view)
     {
-        _init_gray();
+        view.channels = std::min(view.channels, 3); // alpha dropped, the strides stay
+        _thumbnail_scratch.resize(static_cast<size_t>(view.width) * view.height * 3);
+        if (view.channels == 1)
+            FrameConvert::grayToRgb(view, _thumbnail_scratch.data());
+        else
+            FrameConvert::toU8(view, _thumbnail_scratch.data());
+        _mosaic.put(cell, _thumbnail_scratch.data(), view.width, view.height);
     }
 
-    if (visualizable->supports(VisualizationMethod::HEAT_MAP))
+    // RGB / RGBA as they are, a single channel is spread to gray. Into the mosaic for cell >= 0
+    void _upload_rgb(GLTexture *texture, const FrameConvert::ImageView &view, int cell)
     {
-        _init_heat_map();
+        if (cell >= 0)
+        {
+            _upload_thumbnail(cell, view);
+            return;
+        }
+
+        const int channels = view.channels == 1 ? 3 : view.channels;
+        _upload(texture, view.width, view.height, channels, [&](unsigned char *texels)
+                {
+            if (view.channels == 1)
+                FrameConvert::grayToRgb(view, texels);
+            else
+                FrameConvert::toU8(view, texels); });
+    }
+
+    void _declare_names(const PyVisualizable *visualizable, VisualizationMethod method, Preview::NamedValues &out)
+    {
+        auto names = visualizable->getVisualizationNames(method);
+        out.declared = names.has_value();
+        out.names = names ? std::move(*names) : std::vector<std::string>{};
+        out.values.assign(out.names.size(), 0.0f);
     }
 
-    if (visualizable->supports(VisualizationMethod::FEATURES))
+    // a float array in the declared order, no string crosses over per step. Objects that
+    // declare nothing hand out {name: value} dicts, those are rebuilt each time
+    void _read_named_values(const py::object &data, Preview::NamedValues &out)
     {
-        _init_features();
+        if (out.declared)
+        {
+            auto values = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(data);
+            if (!values || static_cast<size_t>(values.size()) != out.names.size())
+            {
+                Logger::error("Expected an array of " + std::to_string(out.names.size()) + " values");
+                return;
+            }
+            std::copy_n(values.data(), out.values.size(), out.values.begin());
+            return;
+        }
+
+        out.names.clear();
+        out.values.clear();
+        for (const auto item : data.cast<py::dict>())
+        {
+            try
+            {
+                const float value = py::cast<float>(item.second);
+                out.names.emplace_back(py::str(item.first));
+                out.values.push_back(value);
+            }
+            catch (...)
+            {
+                Logger::error("Failed to process entry: " + std::string(py::str(item.first)));
+            }
+        }
     }
 
-    if (visualizable->supports(VisualizationMethod::BAR_CHART))
+    // heat map display, one setting for every view so the colors compare across agents
+    int _heat_map = Colormap::BLUE_RED;
+    int _heat_normalization = Colormap::PER_STEP;
+    float _heat_fixed[2] = {0.0f, 1.0f};
+    int _heat_window = 100; // steps
+    bool _heat_shared = false;
+    Colormap::RollingRange _heat_shared_range;
+
+    std::vector<float> _heat_scratch; // maps that aren't packed float32 get packed here
+
+    // values stay float on the GPU, the shader does the mapping. Packed float32 maps are
+    // uploaded straight from the python buffer
+    void _upload_heat(GLTexture *texture, const FrameConvert::ImageView &view, Colormap::RollingRange &range, int64_t step)
     {
-        _init_bar_chart();
+        const float *values = static_cast<const float *>(view.data);
+        const size_t size = static_cast<size_t>(view.width) * view.height;
+        if (view.dtype != FrameConvert::Dtype::F32 || !view.packed())
+        {
+            _heat_scratch.resize(size);
+            FrameConvert::toFloat(view, _heat_scratch.data());
+            values = _heat_scratch.data();
+        }
+
+        if (texture->width() != view.width || texture->height() != view.height || texture->channels() != 1)
+            texture->set(values, view.width, view.height, 1);
+        else
+            texture->update(values);
+
+        float min, max;
+        FrameConvert::minMax(values, size, min, max);
+        range.push(step, min, max);
+        _heat_shared_range.push(step, min, max);
     }
 }
 
+void Preview::VisualizedObject::init(PyVisualizable *obj)
+{
+    this->visualizable = obj;
+
+    // what an object supports doesn't change over its life, ask python once. Nothing is
+    // fetched here, update() picks the modalities up once they get drawn
+    SafeWrapper::execute([&]
+                         {
+        for (int m = 0; m < METHOD_COUNT; m++)
+            capable_[m] = visualizable->supports(static_cast<VisualizationMethod>(m)); });
+}
+
 bool Preview::VisualizedObject::supports(VisualizationMethod method) const
+{
+    const int m = static_cast<int>(method);
+    return m >= 0 && m < METHOD_COUNT && capable_[m];
+}
+
+void Preview::VisualizedObject::markDrawn(VisualizationMethod method)
+{
+    drawn_ |= 1u << static_cast<int>(method);
+}
+
+void Preview::VisualizedObject::markThumbnail(int cell)
+{
+    markDrawn(VisualizationMethod::RGB_ARRAY);
+    thumbnail_drawn_ = cell;
+}
+
+bool Preview::VisualizedObject::_shown(VisualizationMethod method) const
+{
+    return supports(method) && (shown_ >> static_cast<int>(method) & 1u);
+}
+
+PyLiveObject *Preview::VisualizedObject::params(VisualizationMethod method) const
 {
     switch (method)
     {
     case VisualizationMethod::RGB_ARRAY:
-        return rgb_array != nullptr;
+        return rgb_array_params;
     case VisualizationMethod::GRAY_SCALE:
-        return gray != nullptr;
+        return gray_params;
     case VisualizationMethod::HEAT_MAP:
-        return heat_map != nullptr;
+        return heat_map_params;
     case VisualizationMethod::FEATURES:
-        return features_params != nullptr;
+        return features_params;
     case VisualizationMethod::BAR_CHART:
-        return bar_chart_params != nullptr;
+        return bar_chart_params;
     default:
-        return false;
+        return nullptr;
     }
 }
 
-void Preview::VisualizedObject::update()
+void Preview::VisualizedObject::paramsChanged(VisualizationMethod method)
+{
+    params_version_[static_cast<int>(method)]++;
+    if (method == VisualizationMethod::HEAT_MAP)
+        heat_range.clear(); // the old values don't describe the new map
+}
+
+void Preview::VisualizedObject::update(int64_t step, int64_t episode)
 {
-    if (rgb_array)
-        _update_rgb_array();
-    if (gray)
-        _update_gray();
-    if (heat_map)
-        _update_heat_map();
-    if (features_params)
-        _update_features();
-    if (bar_chart_params)
-        _update_bar_chart();
+    // only what was on screen last frame, hidden tabs and scrolled out agents cost no python call
+    shown_ = drawn_;
+    drawn_ = 0;
+    thumbnail_ = thumbnail_drawn_;
+    thumbnail_drawn_ = -1;
 
-    if (rgb_array == nullptr && visualizable->supports(VisualizationMethod::RGB_ARRAY))
-        _init_rgb_array();
-    if (gray == nullptr && visualizable->supports(VisualizationMethod::GRAY_SCALE))
-        _init_gray();
-    if (heat_map == nullptr && visualizable->supports(VisualizationMethod::HEAT_MAP))
-        _init_heat_map();
-    if (features_params == nullptr && visualizable->supports(VisualizationMethod::FEATURES))
-        _init_features();
-    if (bar_chart_params == nullptr && visualizable->supports(VisualizationMethod::BAR_CHART))
-        _init_bar_chart();
+    for (int m = 0; m < METHOD_COUNT; m++)
+    {
+        const auto method = static_cast<VisualizationMethod>(m);
+        if (!_shown(method))
+            continue;
+
+        // and only once per step / episode / params edit, a paused lab makes no call at all.
+        // Failed fetches aren't retried before the next change either
+        fetching_ = {step, episode, params_version_[m], method == VisualizationMethod::RGB_ARRAY ? thumbnail_ : -1};
+        if (fetched_[m] == fetching_)
+            continue;
+        fetched_[m] = fetching_;
+
+        switch (method)
+        {
+        case VisualizationMethod::RGB_ARRAY:
+            rgb_array ? _update_rgb_array() : _init_rgb_array();
+            break;
+        case VisualizationMethod::GRAY_SCALE:
+            gray ? _update_gray() : _init_gray();
+            break;
+        case VisualizationMethod::HEAT_MAP:
+            heat_map ? _update_heat_map() : _init_heat_map();
+            break;
+        case VisualizationMethod::FEATURES:
+            features_params ? _update_features() : _init_features();
+            break;
+        case VisualizationMethod::BAR_CHART:
+            bar_chart_params ? _update_bar_chart() : _init_bar_chart();
+            break;
+        }
+    }
+}
+
+void Preview::VisualizedObject::record(int64_t step)
+{
+    // a step that's already kept means the agent didn't move this tick, no python call then.
+    // Fetch errors are left to update(), which logs them when the view is drawn
+    if (supports(VisualizationMethod::RGB_ARRAY) && rgb_history.newest() < step)
+    {
+        SafeWrapper::execute([&]
+                             {
+            auto data = visualizable->getVisualization(VisualizationMethod::RGB_ARRAY,
+                                                       rgb_array_params ? rgb_array_params->object : py::none());
+            py::array arr;
+            FrameConvert::ImageView view;
+            std::string error;
+            if (!data.has_value() || !PyImage::ingest(*data, arr, view, error))
+                return;
+            view.channels = std::min(view.channels, 3); // alpha dropped, the strides stay
+            _record_rgb.resize(static_cast<size_t>(view.width) * view.height * 3);
+            if (view.channels == 1)
+                FrameConvert::grayToRgb(view, _record_rgb.data());
+            else
+                FrameConvert::toU8(view, _record_rgb.data());
+            _record(rgb_history, step, _record_rgb.data(), view.width, view.height, 3, false); });
+    }
+
+    if (supports(VisualizationMethod::HEAT_MAP) && heat_history.newest() < step)
+    {
+        SafeWrapper::execute([&]
+                             {
+            auto data = visualizable->getVisualization(VisualizationMethod::HEAT_MAP,
+                                                       heat_map_params ? heat_map_params->object : py::none());
+            py::array arr;
+            FrameConvert::ImageView view;
+            std::string error;
+            if (!data.has_value() || !PyImage::ingest(*data, arr, view, error) || view.channels != 1)
+                return;
+            _record_heat.resize(static_cast<size_t>(view.width) * view.height);
+            FrameConvert::toFloat(view, _record_heat.data());
+            _record(heat_history, step, _record_heat.data(), view.width, view.height, 1, true); });
+    }
 }
 
 Preview::VisualizedObject::~VisualizedObject()
@@ -133,33 +354,18 @@ void Preview::VisualizedObject::_init_rgb_array()
     if (!SafeWrapper::execute([&]
                               {
         rgb_array = new GLTexture();
+        rgb_array->setChangeTracking(true); // env frames mostly change in small regions
 
         auto data = visualizable->getVisualization(VisualizationMethod::RGB_ARRAY, rgb_array_params->object);
         if (data.has_value()) {
-            py::array_t<float> arr = data->cast<py::array>();
-            if (arr.ndim() == 3 || arr.ndim() == 4) { // assuming RGB image / RGBA image
-                int width = arr.shape(1);
-                int height = arr.shape(0);
-                int channels = arr.shape(2);
-                //Logger::info(std::format("RGB Array Size: <{}, {}>", width, height));
-                Logger::info("RGB Array Size: <" + std::to_string(width) + ", " + std::to_string(height) + ">");
-                if (channels == 3 || channels == 4) {
-                    std::vector<unsigned char> rgbData(width * height * channels);
-                    auto data_ptr = arr.data();
-                    for (int i = 0; i < width * height; i++) {
-                        rgbData[i * channels + 0]     = static_cast<unsigned char>(data_ptr[i * channels + 0] * 255.0f);
-                        rgbData[i * channels + 1]     = static_cast<unsigned char>(data_ptr[i * channels + 1] * 255.0f);
-                        rgbData[i * channels + 2]     = static_cast<unsigned char>(data_ptr[i * channels + 2] * 255.0f);
-
-                        if (channels == 4)
-                            rgbData[i * channels + 3] = static_cast<unsigned char>(data_ptr[i * channels + 3] * 255.0f);
-                    }
-                    rgb_array->set(rgbData, width, height, channels);
-                } else {
-                    Logger::error("Unsupported number of channels: " + std::to_string(channels));
-                }
+            py::array arr; // keeps the buffer alive while the view is read
+            FrameConvert::ImageView view;
+            std::string error;
+            if (PyImage::ingest(*data, arr, view, error)) {
+                Logger::info("RGB Array Size: <" + std::to_string(view.width) + ", " + std::to_string(view.height) + ">");
+                _upload_rgb(rgb_array, view, fetching_.cell);
             } else {
-                Logger::error("Unsupported visualization shape: " + std::to_string(arr.ndim()) + "D");
+                Logger::error(error);
             }
         } else {
             Logger::warning("No RGB Array visualization available for object: " + std::string(visualizable->moduleName));
@@ -174,35 +380,19 @@ void Preview::VisualizedObject::_init_rgb_array()
     }
 }
 
-void Preview::VisualizedObject::_update_rgb_array() const
+void Preview::VisualizedObject::_update_rgb_array()
 {
     SafeWrapper::execute([&]
                          {
         auto data = visualizable->getVisualization(VisualizationMethod::RGB_ARRAY, rgb_array_params->object);
         if (data.has_value()) {
-            py::array_t<float> arr = data->cast<py::array>();
-            if (arr.ndim() == 3 || arr.ndim() == 4) { // assuming RGB image / RGBA image
-                int width = arr.shape(1);
-                int height = arr.shape(0);
-                int channels = arr.shape(2);
-                if (channels == 3 || channels == 4) {
-                    std::vector<unsigned char> rgbData(width * height * channels);
-                    auto data_ptr = arr.data();
-                    for (int i = 0; i < width * height; i++) {
-                        rgbData[i * channels + 0]     = static_cast<unsigned char>(data_ptr[i * channels + 0] * 255.0f);
-                        rgbData[i * channels + 1]     = static_cast<unsigned char>(data_ptr[i * channels + 1] * 255.0f);
-                        rgbData[i * channels + 2]     = static_cast<unsigned char>(data_ptr[i * channels + 2] * 255.0f);
-
-                        if (channels == 4)
-                            rgbData[i * channels + 3] = static_cast<unsigned char>(data_ptr[i * channels + 3] * 255.0f);
-                    }
-                    rgb_array->update(rgbData);
-                } else {
-                    Logger::error("Unsupported number of channels: " + std::to_string(channels));
-                }
-            } else {
-                Logger::error("Unsupported visualization shape: " + std::to_string(arr.ndim()) + "D");
-            }
+            py::array arr;
+            FrameConvert::ImageView view;
+            std::string error;
+            if (PyImage::ingest(*data, arr, view, error))
+                _upload_rgb(rgb_array, view, fetching_.cell);
+            else
+                Logger::error(error);
         } else {
             Logger::warning("No RGB Array visualization available for object: " + std::string(visualizable->moduleName));
         } });
@@ -231,27 +421,21 @@ void Preview::VisualizedObject::_init_gray()
     if (!SafeWrapper::execute([&]
                               {
         gray = new GLTexture();
+        gray->setChangeTracking(true); // env frames mostly change in small regions
 
         auto data = visualizable->getVisualization(VisualizationMethod::GRAY_SCALE, gray_params->object);
         if (data.has_value()) {
-            py::array_t<float> arr = data->cast<py::array>();
-            if (arr.ndim() == 2) { // assuming Gray image
-                int width = arr.shape(1);
-                int height = arr.shape(0);
-                int channels = 1;
-                //Logger::info(std::format("Gray Size: <{}, {}>", width, height));
-                Logger::info("Gray Size: <" + std::to_string(width) + ", " + std::to_string(height) + ">");
-
-                std::vector<unsigned char> rgbData(width * height * 3);
-                auto data_ptr = arr.data();
-                for (int i = 0; i < width * height; i++) { // convert to RGB
-                    rgbData[i * 3 + 0]     = static_cast<unsigned char>(data_ptr[i * channels + 0] * 255.0f);
-                    rgbData[i * 3 + 1]     = static_cast<unsigned char>(data_ptr[i * channels + 0] * 255.0f);
-                    rgbData[i * 3 + 2]     = static_cast<unsigned char>(data_ptr[i * channels + 0] * 255.0f);
-                }
-                gray->set(rgbData, width, height, 3);
+            py::array arr; // keeps the buffer alive while the view is read
+            FrameConvert::ImageView view;
+            std::string error;
+            if (!PyImage::ingest(*data, arr, view, error)) {
+                Logger::error(error);
+            } else if (view.channels != 1) {
+                Logger::error("Unsupported number of channels: " + std::to_string(view.channels));
             } else {
-                Logger::error("Unsupported visualization shape: " + std::to_string(arr.ndim()) + "D");
+                Logger::info("Gray Size: <" + std::to_string(view.width) + ", " + std::to_string(view.height) + ">");
+                _upload(gray, view.width, view.height, 3, [&](unsigned char *texels) // expanded to RGB
+                        { FrameConvert::grayToRgb(view, texels); });
             }
         } else {
             Logger::warning("No Gray Scale visualization available for object: " + std::string(visualizable->moduleName));
@@ -272,23 +456,16 @@ void Preview::VisualizedObject::_update_gray() const
                          {
         auto data = visualizable->getVisualization(VisualizationMethod::GRAY_SCALE, gray_params->object);
         if (data.has_value()) {
-            py::array_t<float> arr = data->cast<py::array>();
-            if (arr.ndim() == 2) { // assuming Gray image
-                int width = arr.shape(1);
-                int height = arr.shape(0);
-                int channels = 1;
-
-                std::vector<unsigned char> rgbData(width * height * 3);
-                auto data_ptr = arr.data();
-                for (int i = 0; i < width * height; i++) { // convert to RGB
-                    rgbData[i * 3 + 0]     = static_cast<unsigned char>(data_ptr[i * channels + 0] * 255.0f);
-                    rgbData[i * 3 + 1]     = static_cast<unsigned char>(data_ptr[i * channels + 0] * 255.0f);
-                    rgbData[i * 3 + 2]     = static_cast<unsigned char>(data_ptr[i * channels + 0] * 255.0f);
-                }
-                gray->update(rgbData);
-            } else {
-                Logger::error("Unsupported visualization shape: " + std::to_string(arr.ndim()) + "D");
-            }
+            py::array arr;
+            FrameConvert::ImageView view;
+            std::string error;
+            if (!PyImage::ingest(*data, arr, view, error))
+                Logger::error(error);
+            else if (view.channels != 1)
+                Logger::error("Unsupported number of channels: " + std::to_string(view.channels));
+            else
+                _upload(gray, view.width, view.height, 3, [&](unsigned char *texels) // expanded to RGB
+                        { FrameConvert::grayToRgb(view, texels); });
         } else {
             Logger::warning("No Gray Scale visualization available for object: " + std::string(visualizable->moduleName));
         } });
@@ -320,28 +497,16 @@ void Preview::VisualizedObject::_init_heat_map()
 
         auto data = visualizable->getVisualization(VisualizationMethod::HEAT_MAP, heat_map_params->object);
         if (data.has_value()) {
-            py::array_t<float> arr = data->cast<py::array>();
-            if (arr.ndim() == 2) { // assuming Gray image
-                int width = arr.shape(1);
-                int height = arr.shape(0);
-                int channels = 1;
-                //Logger::info(std::format("Heat map Size: <{}, {}>", width, height));
-                Logger::info("Heat map Size: <" + std::to_string(width) + ", " + std::to_string(height) + ">");
-
-                std::vector<unsigned char> rgbData(width * height * 3);
-                auto data_ptr = arr.data();
-                auto max = *std::max_element(data_ptr, data_ptr + width * height);
-                auto min = *std::min_element(data_ptr, data_ptr + width * height);
-
-                for (int i = 0; i < width * height; i++) { // convert to RGB
-                    auto weight = (data_ptr[i * channels + 0] - min) / (max - min);
-                    rgbData[i * 3 + 0]     = static_cast<unsigned char>(weight       * 255.0f);
-                    rgbData[i * 3 + 1]     = static_cast<unsigned char>(0);
-                    rgbData[i * 3 + 2]     = static_cast<unsigned char>((1 - weight) * 255.0f);
-                }
-                heat_map->set(rgbData, width, height, 3);
+            py::array arr; // keeps the buffer alive while the view is read
+            FrameConvert::ImageView view;
+            std::string error;
+            if (!PyImage::ingest(*data, arr, view, error)) {
+                Logger::error(error);
+            } else if (view.channels != 1) {
+                Logger::error("Unsupported number of channels: " + std::to_string(view.channels));
             } else {
-                Logger::error("Unsupported visualization shape: " + std::to_string(arr.ndim()) + "D");
+                Logger::info("Heat map Size: <" + std::to_string(view.width) + ", " + std::to_string(view.height) + ">");
+                _upload_heat(heat_map, view, heat_range, fetching_.step);
             }
         } else {
             Logger::warning("No Heat map visualization available for object: " + std::string(visualizable->moduleName));
@@ -356,33 +521,21 @@ void Preview::VisualizedObject::_init_heat_map()
     }
 }
 
-void Preview::VisualizedObject::_update_heat_map() const
+void Preview::VisualizedObject::_update_heat_map()
 {
     SafeWrapper::execute([&]
                          {
         auto data = visualizable->getVisualization(VisualizationMethod::HEAT_MAP, heat_map_params->object);
         if (data.has_value()) {
-            py::array_t<float> arr = data->cast<py::array>();
-            if (arr.ndim() == 2) { // assuming Gray image
-                int width = arr.shape(1);
-                int height = arr.shape(0);
-                int channels = 1;
-
-                std::vector<unsigned char> rgbData(width * height * 3);
-                auto data_ptr = arr.data();
-                auto max = *std::max_element(data_ptr, data_ptr + width * height);
-                auto min = *std::min_element(data_ptr, data_ptr + width * height);
-
-                for (int i = 0; i < width * height; i++) { // convert to RGB
-                    auto weight = (data_ptr[i * channels + 0] - min) / (max - min);
-                    rgbData[i * 3 + 0]     = static_cast<unsigned char>(weight       * 255.0f);
-                    rgbData[i * 3 + 1]     = static_cast<unsigned char>(0);
-                    rgbData[i * 3 + 2]     = static_cast<unsigned char>((1 - weight) * 255.0f);
-                }
-                heat_map->update(rgbData);
-            } else {
-                Logger::error("Unsupported visualization shape: " + std::to_string(arr.ndim()) + "D");
-            }
+            py::array arr;
+            FrameConvert::ImageView view;
+            std::string error;
+            if (!PyImage::ingest(*data, arr, view, error))
+                Logger::error(error);
+            else if (view.channels != 1)
+                Logger::error("Unsupported number of channels: " + std::to_string(view.channels));
+            else
+                _upload_heat(heat_map, view, heat_range, fetching_.step);
         } else {
             Logger::warning("No Heat map visualization available for object: " + std::string(visualizable->moduleName));
         } });
@@ -400,7 +553,8 @@ void Preview::VisualizedObject::_init_features()
             PyScope::parseLoadedModule(py::getattr(features_params->object, "__class__"), *features_params);
         } else {
             features_params->object = py::none();
-        } }))
+        }
+        _declare_names(visualizable, VisualizationMethod::FEATURES, features); }))
     {
         Logger::error("Failed to initialize Features visualization (params) for object: " + std::string(visualizable->moduleName));
         delete features_params;
@@ -417,15 +571,7 @@ void Preview::VisualizedObject::_update_features()
                          {
         auto data = visualizable->getVisualization(VisualizationMethod::FEATURES, features_params->object);
         if (data.has_value()) {
-            features.clear();
-
-            py::dict dict = data->cast<py::dict>();
-            for (const auto item : dict) {
-                py::str key = py::str(item.first);
-                py::str value = py::str(item.second);
-                features[key] = value;
-            }
-
+            _read_named_values(*data, features);
         } else {
             Logger::warning("No Features visualization available for object: " + std::string(visualizable->moduleName));
         } });
@@ -443,7 +589,8 @@ void Preview::VisualizedObject::_init_bar_chart()
             PyScope::parseLoadedModule(py::getattr(bar_chart_params->object, "__class__"), *bar_chart_params);
         } else {
             bar_chart_params->object = py::none();
-        } }))
+        }
+        _declare_names(visualizable, VisualizationMethod::BAR_CHART, bar_chart); }))
     {
         Logger::error("Failed to initialize Bar Chart visualization (params) for object: " + std::string(visualizable->moduleName));
         delete bar_chart_params;
@@ -460,18 +607,7 @@ void Preview::VisualizedObject::_update_bar_chart()
                          {
         auto data = visualizable->getVisualization(VisualizationMethod::BAR_CHART, bar_chart_params->object);
         if (data.has_value()) {
-            bar_chart.clear();
-            py::dict dict = data->cast<py::dict>();
-
-            for (const auto item : dict) {
-                py::str key = py::str(item.first);
-                try {
-                    float value = py::cast<float>(item.second);
-                    bar_chart[key] = value;
-                } catch (...) {
-                    Logger::error("Failed to process bar chart entry: " + std::string(key));
-                }
-            }
+            _read_named_values(*data, bar_chart);
         } else {
             Logger::warning("No Bar Chart visualization available");
         } });
@@ -500,17 +636,28 @@ void Preview::VisualizedAgent::init(Pipeline::ActiveAgent *agent)
 
 void Preview::VisualizedAgent::update() const
 {
+    const int64_t step = agent->total_steps;
+    const int64_t episode = agent->total_episodes;
+
     if (env_visualization)
     {
-        env_visualization->update();
+        env_visualization->update(step, episode);
     }
 
     for (auto &method_vis : method_visualizations)
     {
-        method_vis->update();
+        method_vis->update(step, episode);
     }
 }
 
+void Preview::VisualizedAgent::record() const
+{
+    if (env_visualization)
+        env_visualization->record(agent->total_steps);
+    for (auto &method_vis : method_visualizations)
+        method_vis->record(agent->total_steps);
+}
+
 Preview::VisualizedAgent::~VisualizedAgent()
 {
     delete env_visualization;
@@ -525,34 +672,330 @@ Preview::VisualizedAgent::~VisualizedAgent()
 
 void Preview::init() {}
 
-static void _render_visualizable(Preview::VisualizedObject *obj, const std::string &message)
+static void _heat_range(const Preview::VisualizedObject *obj, float &min, float &max)
+{
+    if (_heat_normalization == Colormap::FIXED)
+    {
+        min = _heat_fixed[0];
+        max = _heat_fixed[1];
+        return;
+    }
+
+    const int window = _heat_normalization == Colormap::PER_STEP ? 1 : _heat_window;
+    const auto &range = _heat_shared ? _heat_shared_range : obj->heat_range;
+    if (!range.range(window, min, max))
+    {
+        min = 0.0f;
+        max = 1.0f;
+    }
+}
+
+static void _render_heat_controls()
+{
+    ImGui::SetNextItemWidth(100);
+    ImGui::Combo("##colormap", &_heat_map, Colormap::mapNames, Colormap::MAP_COUNT);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(100);
+    ImGui::Combo("##normalization", &_heat_normalization, Colormap::normalizationNames, Colormap::NORMALIZATION_COUNT);
+
+    if (_heat_normalization == Colormap::FIXED)
+    {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(140);
+        ImGui::DragFloatRange2("##range", &_heat_fixed[0], &_heat_fixed[1], 0.01f, 0.0f, 0.0f, "%.3g", "%.3g");
+    }
+    else
+    {
+        if (_heat_normalization == Colormap::ROLLING)
+        {
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(100);
+            ImGui::SliderInt("##window", &_heat_window, 2, Colormap::RollingRange::MAX_WINDOW, "%d steps");
+        }
+        ImGui::SameLine();
+        ImGui::Checkbox("Shared", &_heat_shared);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("One range over the heat maps of every agent and method");
+    }
+}
+
+// heat map over the env frame, the map's colors and range come from the heat map controls
+static float _overlay_alpha = 0.5f;
+static float _overlay_threshold = 0.0f; // of the normalized range, below it the frame shows through
+
+static void _render_overlay_controls()
 {
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderFloat("Alpha", &_overlay_alpha, 0.0f, 1.0f, "%.2f");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderFloat("Threshold", &_overlay_threshold, 0.0f, 1.0f, "%.2f");
+}
+
+static bool _parse_bound(const std::string &text, double &value)
+{
+    if (text.empty() || text == "None")
+        return false;
+    try
+    {
+        value = std::stod(text);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// one widget per editable annotated attribute of the params object, true if one changed
+static bool _edit_param(py::object &object, const Param &param)
+{
+    const char *name = param.attrName.c_str();
+    if (!param.editable || !py::hasattr(object, name))
+        return false;
+
+    auto &python = PyScope::getInstance();
+    py::object value = object.attr(name);
+    double lo = 0, hi = 0;
+    const bool bounded = _parse_bound(param.rangeStart, lo) && _parse_bound(param.rangeEnd, hi);
+
+    ImGui::SetNextItemWidth(120);
+    if (param.hasChoices && !param.choices.empty())
+    {
+        const std::string current = py::str(value);
+        if (ImGui::BeginCombo(name, current.c_str()))
+        {
+            bool changed = false;
+            for (const auto &choice : param.choices)
+            {
+                if (ImGui::Selectable(choice.c_str(), choice == current))
+                {
+                    object.attr(name) = param.type.is_none() ? py::str(choice) : param.type(choice);
+                    changed = true;
+                }
+            }
+            ImGui::EndCombo();
+            return changed;
+        }
+        return false;
+    }
+
+    if (py::isinstance<py::bool_>(value))
+    {
+        bool v = value.cast<bool>();
+        if (!ImGui::Checkbox(name, &v))
+            return false;
+        object.attr(name) = py::bool_(v);
+        return true;
+    }
+
+    if (PyScope::isSubclassOrInstance(value, python.int_type))
+    {
+        int v = value.cast<int>();
+        if (!ImGui::InputInt(name, &v))
+            return false;
+        if (bounded)
+            v = std::clamp(v, static_cast<int>(lo), static_cast<int>(hi));
+        object.attr(name) = py::int_(v);
+        return true;
+    }
+
+    if (PyScope::isSubclassOrInstance(value, python.float_type))
+    {
+        float v = value.cast<float>();
+        if (!ImGui::InputFloat(name, &v))
+            return false;
+        if (bounded)
+            v = std::clamp(v, static_cast<float>(lo), static_cast<float>(hi));
+        object.attr(name) = py::float_(v);
+        return true;
+    }
+
+    if (PyScope::isSubclassOrInstance(value, python.str_type))
+    {
+        char buffer[256];
+        snprintf(buffer, sizeof(buffer), "%s", value.cast<std::string>().c_str());
+        if (!ImGui::InputText(name, buffer, sizeof(buffer), ImGuiInputTextFlags_EnterReturnsTrue))
+            return false;
+        object.attr(name) = py::str(buffer);
+        return true;
+    }
+
+    ImGui::TextDisabled("%s: %s", name, std::string(py::repr(value)).c_str());
+    return false;
+}
+
+static void _render_params(Preview::VisualizedObject *obj, VisualizationMethod method)
+{
+    auto *params = obj->params(method);
+    if (!params || params->object.is_none() || params->annotations.empty())
+        return;
+
+    if (!ImGui::TreeNode("Params"))
+        return;
+
+    bool changed = false;
+    SafeWrapper::execute([&]
+                         {
+        for (const auto &param : params->annotations)
+            changed |= _edit_param(params->object, param); });
+    if (changed)
+        obj->paramsChanged(method); // refetched next frame, paused or not
+
+    ImGui::TreePop();
+}
+
+// a modality counts as drawn if any of its area is inside the clip rect at the cursor
+static void _mark_if_visible(Preview::VisualizedObject *obj, VisualizationMethod method, const ImVec2 &size)
+{
+    if (ImGui::IsRectVisible(ImVec2(std::max(size.x, 1.0f), std::max(size.y, 1.0f))))
+        obj->markDrawn(method);
+}
+
+static ImVec2 _texture_size(const GLTexture *texture)
+{
+    return texture ? ImVec2(texture->width(), texture->height()) : ImVec2(0, 0);
+}
+
+static const std::string _NOT_RECORDED = "Nothing recorded up to this step.";
+
+// the recorded frame that was current at the scrubbed step, decoded once per step change
+static GLTexture *_replay(const FrameHistory &history, Preview::Replay &replay)
+{
+    if (replay.texture && replay.step == _scrub_step)
+        return replay.texture;
+
+    static FrameHistory::Frame frame;
+    if (!history.decode(_scrub_step, frame))
+        return nullptr;
+
+    if (!replay.texture)
+        replay.texture = new GLTexture();
+    if (frame.is_float)
+    {
+        const auto *values = reinterpret_cast<const float *>(frame.data.data());
+        replay.texture->set(values, frame.width, frame.height, frame.channels);
+        FrameConvert::minMax(values, frame.data.size() / sizeof(float), replay.min, replay.max);
+    }
+    else
+    {
+        replay.texture->set(frame.data.data(), frame.width, frame.height, frame.channels);
+    }
+    replay.step = _scrub_step;
+    return replay.texture;
+}
+
+// live or, while scrubbing, what was recorded. Heat ranges of a recorded map are its own
+// unless fixed, the rolling ones only describe the live steps
+static GLTexture *_shown_rgb(Preview::VisualizedObject *obj)
+{
+    return _scrub_step < 0 ? obj->rgb_array : _replay(obj->rgb_history, obj->rgb_replay);
+}
+
+static GLTexture *_shown_heat(Preview::VisualizedObject *obj, float &min, float &max)
+{
+    _heat_range(obj, min, max);
+    if (_scrub_step < 0)
+        return obj->heat_map;
+
+    GLTexture *texture = _replay(obj->heat_history, obj->heat_replay);
+    if (texture && _heat_normalization != Colormap::FIXED)
+    {
+        min = obj->heat_replay.min;
+        max = obj->heat_replay.max;
+    }
+    return texture;
+}
+
+// env: the agent's env, when given a method's heat map can also be shown over its frames
+static void _render_visualizable(Preview::VisualizedObject *obj, const std::string &live_message, Preview::VisualizedObject *env = nullptr)
+{
+    const std::string &message = _scrub_step < 0 ? live_message : _NOT_RECORDED;
     if (ImGui::BeginTabBar("##vis"))
     {
         if (obj->supports(VisualizationMethod::RGB_ARRAY) && ImGui::BeginTabItem("RGB"))
         {
-            auto obs = obj->rgb_array;
-            ImGui::Image(obs->id(), ImVec2(obs->width(), obs->height()));
+            auto obs = _shown_rgb(obj);
+            _render_params(obj, VisualizationMethod::RGB_ARRAY);
+            _mark_if_visible(obj, VisualizationMethod::RGB_ARRAY, _texture_size(obs));
+            if (obs && obs->width() > 0)
+                ImGui::Image(obs->id(), ImVec2(obs->width(), obs->height()));
+            else
+                ImGui::TextDisabled("%s", message.c_str());
             ImGui::EndTabItem();
         }
 
         if (obj->supports(VisualizationMethod::GRAY_SCALE) && ImGui::BeginTabItem("Gray"))
         {
             auto obs = obj->gray;
-            ImGui::Image(obs->id(), ImVec2(obs->width(), obs->height()));
+            _render_params(obj, VisualizationMethod::GRAY_SCALE);
+            _mark_if_visible(obj, VisualizationMethod::GRAY_SCALE, _texture_size(obs));
+            if (obs && obs->width() > 0)
+                ImGui::Image(obs->id(), ImVec2(obs->width(), obs->height()));
+            else
+                ImGui::TextDisabled("%s", message.c_str());
             ImGui::EndTabItem();
         }
 
         if (obj->supports(VisualizationMethod::HEAT_MAP) && ImGui::BeginTabItem("Heat Map"))
         {
-            auto obs = obj->heat_map;
-            ImGui::Image(obs->id(), ImVec2(obs->width(), obs->height()));
+            float min, max;
+            auto obs = _shown_heat(obj, min, max);
+            _render_params(obj, VisualizationMethod::HEAT_MAP);
+            _render_heat_controls();
+            _mark_if_visible(obj, VisualizationMethod::HEAT_MAP, _texture_size(obs));
+            if (obs && obs->width() > 0)
+            {
+                const auto map = static_cast<Colormap::Map>(_heat_map);
+                Colormap::image(obs->id(), ImVec2(obs->width(), obs->height()), map, min, max);
+
+                // legend
+                const float legend_width = std::max(static_cast<float>(obs->width()), 64.0f);
+                const float x = ImGui::GetCursorPosX();
+                ImGui::Image(Colormap::lut(map), ImVec2(legend_width, 8));
+
+                char max_text[32];
+                snprintf(max_text, sizeof(max_text), "%.4g", max);
+                ImGui::Text("%.4g", min);
+                ImGui::SameLine(x + legend_width - ImGui::CalcTextSize(max_text).x);
+                ImGui::TextUnformatted(max_text);
+            }
+            else
+            {
+                ImGui::TextDisabled("%s", message.c_str());
+            }
+            ImGui::EndTabItem();
+        }
+
+        if (env && obj->supports(VisualizationMethod::HEAT_MAP) && env->supports(VisualizationMethod::RGB_ARRAY) && ImGui::BeginTabItem("Overlay"))
+        {
+            float min, max;
+            auto base = _shown_rgb(env);
+            auto heat = _shown_heat(obj, min, max);
+            _render_params(obj, VisualizationMethod::HEAT_MAP);
+            _render_heat_controls();
+            _render_overlay_controls();
+            _mark_if_visible(env, VisualizationMethod::RGB_ARRAY, _texture_size(base));
+            _mark_if_visible(obj, VisualizationMethod::HEAT_MAP, _texture_size(base));
+            if (base && base->width() > 0 && heat && heat->width() > 0)
+            {
+                Colormap::overlay(base->id(), heat->id(), ImVec2(base->width(), base->height()),
+                                  static_cast<Colormap::Map>(_heat_map), min, max, _overlay_alpha, _overlay_threshold);
+            }
+            else
+            {
+                ImGui::TextDisabled("%s", message.c_str());
+            }
             ImGui::EndTabItem();
         }
 
         if (obj->supports(VisualizationMethod::FEATURES) && ImGui::BeginTabItem("Features"))
         {
-            auto obs = obj->features;
+            const auto &obs = obj->features;
+            _render_params(obj, VisualizationMethod::FEATURES);
+            const float rows = static_cast<float>(std::max<size_t>(obs.names.size(), 1) + 1);
+            _mark_if_visible(obj, VisualizationMethod::FEATURES,
+                             ImVec2(ImGui::GetContentRegionAvail().x, rows * ImGui::GetFrameHeightWithSpacing()));
 
             if (ImGui::BeginTable("StringFloatTable", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
             {
@@ -560,15 +1003,21 @@ static void _render_visualizable(Preview::VisualizedObject *obj, const std::stri
                 ImGui::TableSetupColumn("Value");
                 ImGui::TableHeadersRow();
 
-                for (const auto &[name, value] : obs)
+                // rows out of view aren't submitted, long feature lists cost what is on screen
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(obs.names.size()));
+                while (clipper.Step())
                 {
-                    ImGui::TableNextRow();
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                    {
+                        ImGui::TableNextRow();
 
-                    ImGui::TableSetColumnIndex(0);
-                    ImGui::TextUnformatted(name.c_str());
+                        ImGui::TableSetColumnIndex(0);
+                        ImGui::TextUnformatted(obs.names[i].c_str());
 
-                    ImGui::TableSetColumnIndex(1);
-                    ImGui::Text(value.c_str());
+                        ImGui::TableSetColumnIndex(1);
+                        ImGui::Text("%.4g", obs.values[i]);
+                    }
                 }
 
                 ImGui::EndTable();
@@ -578,10 +1027,12 @@ static void _render_visualizable(Preview::VisualizedObject *obj, const std::stri
 
         if (obj->supports(VisualizationMethod::BAR_CHART) && ImGui::BeginTabItem("Bar Chart"))
         {
+            _render_params(obj, VisualizationMethod::BAR_CHART);
+
             // min/max values for scaling
             float min_value = 0.0f;
             float max_value = 0.0f;
-            for (const auto &[key, value] : obj->bar_chart)
+            for (const float value : obj->bar_chart.values)
             {
                 min_value = std::min(min_value, value);
                 max_value = std::max(max_value, value);
@@ -603,7 +1054,9 @@ static void _render_visualizable(Preview::VisualizedObject *obj, const std::stri
             const float zero_line_y = graph_height * (max_value / (max_value - min_value));
             const float value_range = max_value - min_value;
 
-            const float graph_width = (bar_width + bar_spacing) * obj->bar_chart.size() + bar_spacing;
+            const auto &chart = obj->bar_chart;
+            const float graph_width = (bar_width + bar_spacing) * chart.values.size() + bar_spacing;
+            _mark_if_visible(obj, VisualizationMethod::BAR_CHART, ImVec2(ImGui::GetContentRegionAvail().x, graph_height + 50));
 
             if (ImGui::BeginChild("BarChartView", ImVec2(0, graph_height + 50), false,
                                   ImGuiWindowFlags_HorizontalScrollbar))
@@ -621,10 +1074,17 @@ static void _render_visualizable(Preview::VisualizedObject *obj, const std::stri
                     ImVec2(cursor_pos.x + graph_width, cursor_pos.y + zero_line_y),
                     axis_color, 2.0f);
 
-                float x_offset = bar_spacing;
+                // only the bars in view, a chart of a thousand features costs a screen's worth
+                const float pitch = bar_width + bar_spacing;
+                const float scroll = ImGui::GetScrollX();
+                const size_t first = static_cast<size_t>(std::max(0.0f, (scroll - bar_spacing) / pitch));
+                const size_t last = std::min(chart.values.size(), static_cast<size_t>((scroll + ImGui::GetWindowWidth()) / pitch) + 1);
 
-                for (const auto &[key, value] : obj->bar_chart)
+                for (size_t i = first; i < last; i++)
                 {
+                    const float value = chart.values[i];
+                    const char *key = chart.names[i].c_str();
+                    const float x_offset = bar_spacing + i * pitch;
                     const bool is_positive = value >= 0;
                     const float bar_height = (std::abs(value) / value_range) * graph_height;
 
@@ -666,12 +1126,12 @@ static void _render_visualizable(Preview::VisualizedObject *obj, const std::stri
 
                     // feature names
                     const ImVec2 name_pos = ImVec2(
-                        bar_min.x + (bar_width - ImGui::CalcTextSize(key.c_str()).x) * 0.5f,
+                        bar_min.x + (bar_width - ImGui::CalcTextSize(key).x) * 0.5f,
                         cursor_pos.y + graph_height + 5.0f);
-                    draw_list->AddText(name_pos, text_color, key.c_str());
-
-                    x_offset += bar_width + bar_spacing;
+                    draw_list->AddText(name_pos, text_color, key);
                 }
+
+                ImGui::Dummy(ImVec2(graph_width, graph_height + 25.0f)); // the scroll extent
             }
             ImGui::EndChild();
             ImGui::EndTabItem();
@@ -736,33 +1196,149 @@ static void _render_agent_basic(const Pipeline::ActiveAgent &agent, float width,
 
 typedef std::function<void(Pipeline::ActiveAgent &, float, int)> _agent_render_function;
 
+// the mosaic and the compact cards share the thumbnail atlas, one cell per agent.
+// Once per frame before drawing from it
+static void _layout_thumbnails()
+{
+    const int count = static_cast<int>(Pipeline::PipelineState::activeAgents.size());
+    if (_mosaic.layout(count, _mosaic_cell))
+    {
+        // thumbnails of the old layout are gone, fetch them again even while paused
+        for (auto *preview : Preview::previews)
+            if (preview->env_visualization)
+                preview->env_visualization->paramsChanged(VisualizationMethod::RGB_ARRAY);
+    }
+    _mosaic.upload(); // what this frame's update() put in
+}
+
+enum _CardDetail
+{
+    _DETAIL_AUTO = 0,
+    _DETAIL_FULL,
+    _DETAIL_COMPACT
+};
+static const char *_card_detail_names[] = {"Auto", "Full", "Compact"};
+
 static int agents_per_row = 2;
-static void tab_wrapper(const _agent_render_function &_f)
+static int _card_detail = _DETAIL_AUTO;
+static constexpr float _FULL_CARD_WIDTH = 320.0f; // narrower and auto goes compact
+static constexpr float _CARD_SPACING = 10.0f;
+
+static float _compact_card_height()
+{
+    const auto &style = ImGui::GetStyle();
+    return static_cast<float>(_mosaic_cell) + 2 * ImGui::GetTextLineHeightWithSpacing() + 2 * style.WindowPadding.y + style.ItemSpacing.y;
+}
+
+// low detail card: the env frame out of the thumbnail atlas and one headline number,
+// the score of `method` or the episode reward for -1
+static void _render_agent_compact(const Pipeline::ActiveAgent &agent, float width, int index, int method)
 {
+    ImGui::BeginChild(agent.name, ImVec2(width, _compact_card_height()), true, ImGuiWindowFlags_NoScrollbar);
+    FontManager::pushFont("Bold");
+    ImGui::TextUnformatted(agent.name);
+    FontManager::popFont();
+
+    const ImVec2 box(ImGui::GetContentRegionAvail().x, static_cast<float>(_mosaic_cell));
+    const ImVec2 pos = ImGui::GetCursorPos();
+    auto *obj = Preview::previews[index]->env_visualization;
+    if (obj && obj->supports(VisualizationMethod::RGB_ARRAY) && ImGui::IsRectVisible(box))
+        obj->markThumbnail(index);
+
+    ImVec2 uv0, uv1, size;
+    if (_mosaic.cell(index, uv0, uv1, size))
+    {
+        const float scale = std::min(box.x / size.x, box.y / size.y);
+        const ImVec2 shown(size.x * scale, size.y * scale);
+        ImGui::SetCursorPos(ImVec2(pos.x + (box.x - shown.x) / 2, pos.y + (box.y - shown.y) / 2));
+        ImGui::Image(static_cast<ImTextureID>(_mosaic.id()), shown, uv0, uv1);
+    }
+    else
+    {
+        ImGui::TextDisabled("%s", agent.env ? "No frame yet." : "No environment.");
+    }
+    ImGui::SetCursorPos(ImVec2(pos.x, pos.y + box.y + ImGui::GetStyle().ItemSpacing.y));
+
+    if (method >= 0)
+        ImGui::Text("%s: %.2f", Pipeline::PipelineConfig::pipelineMethods[method].name, agent.scores_ep[method]);
+    else
+        ImGui::Text("Reward: %.2f", agent.reward_ep);
+    if (agent.env_terminated || agent.env_truncated)
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(done)");
+    }
+
+    ImGui::EndChild();
+}
+
+// row heights as last measured, per grid. Rows never drawn yet use an estimate
+struct _GridRows
+{
+    int columns = 0;
+    bool compact = false;
+    std::vector<float> heights;
+};
+static std::unordered_map<ImGuiID, _GridRows> _grid_rows;
+static constexpr float _ESTIMATED_ROW_HEIGHT = 400.0f;
+
+// Only the rows overlapping the scroll region are laid out and rendered, the others just
+// advance the cursor by their last known height. Cards have different heights (tables,
+// params, tabs), so this walks measured heights instead of using ImGuiListClipper's fixed
+// item height; the cost per frame is the rows on screen, whatever the agent count
+static void tab_wrapper(const _agent_render_function &_f, int method = -1)
+{
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderInt("Per row", &agents_per_row, 1, 12);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(100);
+    ImGui::Combo("Detail", &_card_detail, _card_detail_names, IM_ARRAYSIZE(_card_detail_names));
+
     ImGui::BeginChild("AgentsScrollArea", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
     
     { // agents previews (env)
+        const auto &agents = Pipeline::PipelineState::activeAgents;
         auto available_width = ImGui::GetContentRegionAvail().x;
-        auto child_width = (available_width - (agents_per_row + 1) * 10) / agents_per_row;
-        child_width = std::max(child_width, 320.0f);
-
-        int num_rows = (Pipeline::PipelineState::activeAgents.size() + agents_per_row - 1) / agents_per_row;
+        auto child_width = (available_width - (agents_per_row + 1) * _CARD_SPACING) / agents_per_row;
+        const bool compact = _card_detail == _DETAIL_COMPACT || (_card_detail == _DETAIL_AUTO && child_width < _FULL_CARD_WIDTH);
+        if (!compact)
+            child_width = std::max(child_width, _FULL_CARD_WIDTH);
+        else
+            _layout_thumbnails();
+
+        int num_rows = (agents.size() + agents_per_row - 1) / agents_per_row;
+        auto &rows = _grid_rows[ImGui::GetID("rows")];
+        if (rows.columns != agents_per_row || rows.compact != compact)
+            rows = {agents_per_row, compact, {}};
+        rows.heights.resize(num_rows, compact ? _compact_card_height() : _ESTIMATED_ROW_HEIGHT);
+
+        const float visible_top = ImGui::GetScrollY();
+        const float visible_bottom = visible_top + ImGui::GetWindowHeight();
         float total_height = 0;
         
         for (int row = 0; row < num_rows; row++) {
+            const float row_top = total_height + _CARD_SPACING;
+            if (row_top + rows.heights[row] < visible_top || row_top > visible_bottom) {
+                total_height += rows.heights[row] + _CARD_SPACING; // off screen, costs nothing
+                continue;
+            }
+
             float max_height_in_row = 0;
             
             for (int col = 0; col < agents_per_row; col++) {
                 int agent_index = row * agents_per_row + col;
-                if (agent_index >= Pipeline::PipelineState::activeAgents.size())
+                if (agent_index >= agents.size())
                     break;
                 
                 auto &agent = Pipeline::PipelineState::activeAgents[agent_index];
                 ImGui::PushID(agent_index);
                 
-                ImGui::SetCursorPos(ImVec2(col * (child_width + 10) + 10, total_height + 10));
+                ImGui::SetCursorPos(ImVec2(col * (child_width + _CARD_SPACING) + _CARD_SPACING, row_top));
                 ImGui::BeginGroup();
-                _f(agent, child_width, agent_index);
+                if (compact)
+                    _render_agent_compact(agent, child_width, agent_index, method);
+                else
+                    _f(agent, child_width, agent_index);
                 ImGui::EndGroup();
                 
                 ImGui::PopID();
@@ -770,7 +1346,8 @@ static void tab_wrapper(const _agent_render_function &_f)
                 max_height_in_row = std::max(max_height_in_row, size.y);
             }
             
-            total_height += max_height_in_row + 10; // spacing after each row
+            rows.heights[row] = max_height_in_row;
+            total_height += max_height_in_row + _CARD_SPACING; // spacing after each row
         }
         
         // dummy item to ensure proper scrolling
@@ -781,6 +1358,314 @@ static void tab_wrapper(const _agent_render_function &_f)
     ImGui::EndChild();
 }
 
+// the env frame of every agent as a thumbnail, for populations too large for the cards.
+// All cells sample the one atlas texture, so the grid is a single draw call
+static void _render_mosaic()
+{
+    const int count = static_cast<int>(Pipeline::PipelineState::activeAgents.size());
+
+    ImGui::SetNextItemWidth(140);
+    ImGui::SliderInt("Thumbnail", &_mosaic_cell, 32, 256, "%d px");
+    _layout_thumbnails();
+
+    ImGui::BeginChild("MosaicScrollArea", ImVec2(0, 0), false);
+    const float spacing = ImGui::GetStyle().ItemSpacing.x;
+    const float cell = static_cast<float>(_mosaic_cell);
+    const int columns = std::max(1, static_cast<int>((ImGui::GetContentRegionAvail().x + spacing) / (cell + spacing)));
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+
+    ImDrawList *draw_list = ImGui::GetWindowDrawList();
+    draw_list->ChannelsSplit(2); // frames below, labels above: the frames stay one batch
+    for (int i = 0; i < count; i++)
+    {
+        const auto &agent = Pipeline::PipelineState::activeAgents[i];
+        const ImVec2 p0(origin.x + (i % columns) * (cell + spacing), origin.y + (i / columns) * (cell + spacing));
+        const ImVec2 p1(p0.x + cell, p0.y + cell);
+
+        auto *obj = Preview::previews[i]->env_visualization;
+        if (obj && obj->supports(VisualizationMethod::RGB_ARRAY) && ImGui::IsRectVisible(p0, p1))
+            obj->markThumbnail(i);
+
+        ImVec2 uv0, uv1, size;
+        draw_list->ChannelsSetCurrent(0);
+        if (_mosaic.cell(i, uv0, uv1, size))
+        {
+            const ImVec2 a(p0.x + (cell - size.x) / 2, p0.y + (cell - size.y) / 2); // centered, aspect kept
+            draw_list->AddImage(static_cast<ImTextureID>(_mosaic.id()), a, ImVec2(a.x + size.x, a.y + size.y), uv0, uv1);
+        }
+
+        draw_list->ChannelsSetCurrent(1);
+        draw_list->AddRect(p0, p1, ImGui::GetColorU32(ImGuiCol_Border));
+        draw_list->AddText(ImVec2(p0.x + 3, p0.y + 2), ImGui::GetColorU32(ImGuiCol_Text), agent.name);
+        if (agent.env_terminated || agent.env_truncated)
+            draw_list->AddText(ImVec2(p0.x + 3, p1.y - ImGui::GetTextLineHeight() - 2), ImGui::GetColorU32(ImGuiCol_TextDisabled), "done");
+
+        if (ImGui::IsMouseHoveringRect(p0, p1) && ImGui::IsWindowHovered())
+            ImGui::SetTooltip("%s\nsteps: %lld\nepisode reward: %.2f", agent.name, static_cast<long long>(agent.total_steps), agent.reward_ep);
+    }
+    draw_list->ChannelsMerge();
+
+    const int rows = (count + columns - 1) / columns;
+    ImGui::Dummy(ImVec2(columns * (cell + spacing), rows * (cell + spacing)));
+    ImGui::EndChild();
+}
+
+// record toggle, memory cap and the scrub bar over the steps any view still has
+static void _render_history_controls()
+{
+    ImGui::Checkbox("Record", &_history_record);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Keep the env frames and heat maps of every agent to scrub back through.\nRecorded on every simulation step, also while this window is collapsed or hidden");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(90);
+    ImGui::SliderInt("##history_mb", &_history_mb, 8, 1024, "%d MB");
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Compressed history per view, the oldest steps go first");
+
+    int64_t oldest = INT64_MAX, newest = -1;
+    auto extend = [&](const Preview::VisualizedObject *obj)
+    {
+        for (const FrameHistory *history : {&obj->rgb_history, &obj->heat_history})
+        {
+            if (!history->empty())
+            {
+                oldest = std::min(oldest, history->oldest());
+                newest = std::max(newest, history->newest());
+            }
+        }
+    };
+    for (const auto *preview : Preview::previews)
+    {
+        if (preview->env_visualization)
+            extend(preview->env_visualization);
+        for (const auto *method : preview->method_visualizations)
+            extend(method);
+    }
+
+    if (newest < 0)
+    {
+        _scrub_step = -1;
+        return;
+    }
+
+    ImGui::SameLine();
+    bool live = _scrub_step < 0;
+    if (ImGui::Checkbox("Live", &live))
+        _scrub_step = live ? -1 : newest;
+
+    ImGui::SameLine();
+    int64_t step = live ? newest : std::clamp(_scrub_step, oldest, newest);
+    ImGui::SetNextItemWidth(-1);
+    if (ImGui::SliderScalar("##scrub", ImGuiDataType_S64, &step, &oldest, &newest, "step %lld"))
+        _scrub_step = step;
+    else if (!live)
+        _scrub_step = step; // the oldest steps may have been dropped meanwhile
+}
+
+// two agents' env frames side by side with their difference. Read from the copies the rgb
+// textures keep for change tracking, so it costs no python call on top of drawing them
+struct _Comparison
+{
+    int a = 0, b = 1; // active agents
+    float threshold = 0.02f; // on the mean |a - b| of a step, 1 = every byte fully apart
+    int64_t steps[2] = {-1, -1}; // the agents' steps the diff is of
+    int64_t diverged = -1; // first step over the threshold
+    float score = 0.0f;
+    float peak = 0.0f; // strongest pixel of the diff, the heat map's top
+    std::vector<float> values;
+    std::vector<float> scores; // newest last, for the plot
+    GLTexture *diff = nullptr;
+    bool shown = false; // the tab was drawn last frame
+};
+static _Comparison _compare;
+static constexpr size_t _COMPARE_PLOT = 512;
+
+static void _reset_comparison()
+{
+    _compare.steps[0] = _compare.steps[1] = -1;
+    _compare.diverged = -1;
+    _compare.score = 0.0f;
+    _compare.peak = 0.0f;
+    _compare.scores.clear();
+}
+
+// after the previews updated: a new step of either agent gets differenced once
+static void _update_comparison()
+{
+    const auto &agents = Pipeline::PipelineState::activeAgents;
+    const int count = static_cast<int>(agents.size());
+    if (!_compare.shown || _compare.a == _compare.b || std::max(_compare.a, _compare.b) >= count)
+        return;
+
+    const auto *env_a = Preview::previews[_compare.a]->env_visualization;
+    const auto *env_b = Preview::previews[_compare.b]->env_visualization;
+    if (!env_a || !env_b || !env_a->rgb_array || !env_b->rgb_array)
+        return;
+
+    const GLTexture *a = env_a->rgb_array, *b = env_b->rgb_array;
+    const unsigned char *pixels_a = a->pixels(), *pixels_b = b->pixels();
+    if (!pixels_a || !pixels_b || a->width() != b->width() || a->height() != b->height() || a->channels() != b->channels())
+        return;
+
+    const int64_t step_a = agents[_compare.a].total_steps, step_b = agents[_compare.b].total_steps;
+    if (step_a == _compare.steps[0] && step_b == _compare.steps[1])
+        return;
+    _compare.steps[0] = step_a;
+    _compare.steps[1] = step_b;
+
+    const size_t size = static_cast<size_t>(a->width()) * a->height();
+    _compare.values.resize(size);
+    _compare.score = FrameConvert::absDiff(pixels_a, pixels_b, size, a->channels(), _compare.values.data());
+    float min;
+    FrameConvert::minMax(_compare.values.data(), size, min, _compare.peak);
+
+    if (!_compare.diff)
+        _compare.diff = new GLTexture();
+    if (_compare.diff->width() != a->width() || _compare.diff->height() != a->height())
+        _compare.diff->set(_compare.values.data(), a->width(), a->height(), 1);
+    else
+        _compare.diff->update(_compare.values.data());
+
+    _compare.scores.push_back(_compare.score);
+    if (_compare.scores.size() > _COMPARE_PLOT)
+        _compare.scores.erase(_compare.scores.begin());
+
+    if (_compare.diverged < 0 && _compare.score > _compare.threshold)
+    {
+        _compare.diverged = std::min(step_a, step_b);
+        Logger::info(std::string(agents[_compare.a].name) + " and " + agents[_compare.b].name + " diverge at step " +
+                     std::to_string(_compare.diverged) + ".");
+    }
+}
+
+static bool _agent_combo(const char *label, int &index)
+{
+    const auto &agents = Pipeline::PipelineState::activeAgents;
+    bool changed = false;
+    ImGui::SetNextItemWidth(160);
+    if (ImGui::BeginCombo(label, agents[index].name))
+    {
+        for (int i = 0; i < static_cast<int>(agents.size()); i++)
+        {
+            ImGui::PushID(i);
+            if (ImGui::Selectable(agents[i].name, i == index))
+            {
+                changed = i != index;
+                index = i;
+            }
+            ImGui::PopID();
+        }
+        ImGui::EndCombo();
+    }
+    return changed;
+}
+
+static void _render_compare()
+{
+    const auto &agents = Pipeline::PipelineState::activeAgents;
+    const int count = static_cast<int>(agents.size());
+    if (count < 2)
+    {
+        ImGui::TextDisabled("Comparing needs two agents in the experiment.");
+        return;
+    }
+    _compare.shown = true;
+    _compare.a = std::clamp(_compare.a, 0, count - 1);
+    _compare.b = std::clamp(_compare.b, 0, count - 1);
+
+    bool changed = _agent_combo("##compare_a", _compare.a);
+    ImGui::SameLine();
+    ImGui::TextUnformatted("vs");
+    ImGui::SameLine();
+    changed |= _agent_combo("##compare_b", _compare.b);
+    if (changed)
+        _reset_comparison();
+
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(140);
+    ImGui::SliderFloat("Threshold", &_compare.threshold, 0.001f, 0.5f, "%.3f", ImGuiSliderFlags_Logarithmic);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Mean absolute difference of a step, over every pixel and channel, above which\nthe agents count as diverged");
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+        _reset_comparison();
+
+    if (_compare.a == _compare.b)
+    {
+        ImGui::TextDisabled("Pick two different agents.");
+        return;
+    }
+
+    if (_compare.diverged >= 0)
+        ImGui::TextColored(ImVec4(1.0f, 0.45f, 0.35f, 1.0f), "Diverged at step %lld", static_cast<long long>(_compare.diverged));
+    else
+        ImGui::TextDisabled("No divergence so far");
+    ImGui::SameLine();
+    ImGui::Text("| change %.4f", _compare.score);
+    if (_scrub_step >= 0)
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(live steps only)");
+    }
+
+    if (!_compare.scores.empty())
+        ImGui::PlotLines("##compare_scores", _compare.scores.data(), static_cast<int>(_compare.scores.size()), 0, nullptr, 0.0f,
+                         std::max(_compare.threshold * 2.0f, *std::max_element(_compare.scores.begin(), _compare.scores.end())),
+                         ImVec2(-1, 50));
+
+    auto *env_a = Preview::previews[_compare.a]->env_visualization;
+    auto *env_b = Preview::previews[_compare.b]->env_visualization;
+    if (!env_a || !env_b || !env_a->supports(VisualizationMethod::RGB_ARRAY) || !env_b->supports(VisualizationMethod::RGB_ARRAY))
+    {
+        ImGui::TextDisabled("Both envs need RGB frames to be compared.");
+        return;
+    }
+
+    // three columns, each frame scaled to fit with its aspect kept
+    const float spacing = ImGui::GetStyle().ItemSpacing.x;
+    const float column = std::max(32.0f, (ImGui::GetContentRegionAvail().x - 2 * spacing) / 3);
+    auto fit = [&](const GLTexture *texture)
+    {
+        const ImVec2 size = _texture_size(texture);
+        return size.x > 0 ? ImVec2(column, column * size.y / size.x) : ImVec2(column, column);
+    };
+
+    const GLTexture *frames[2] = {env_a->rgb_array, env_b->rgb_array};
+    Preview::VisualizedObject *envs[2] = {env_a, env_b};
+    const int indices[2] = {_compare.a, _compare.b};
+    for (int k = 0; k < 2; k++)
+    {
+        ImGui::BeginGroup();
+        ImGui::TextUnformatted(agents[indices[k]].name);
+        const ImVec2 size = fit(frames[k]);
+        _mark_if_visible(envs[k], VisualizationMethod::RGB_ARRAY, size);
+        if (frames[k] && frames[k]->width() > 0)
+            ImGui::Image(static_cast<ImTextureID>(frames[k]->id()), size);
+        else
+            ImGui::Dummy(size);
+        ImGui::EndGroup();
+        ImGui::SameLine();
+    }
+
+    ImGui::BeginGroup();
+    ImGui::TextUnformatted("|a - b|");
+    const bool same_size = frames[0] && frames[1] && frames[0]->width() == frames[1]->width() &&
+                           frames[0]->height() == frames[1]->height() && frames[0]->channels() == frames[1]->channels();
+    if (_compare.diff && same_size)
+    {
+        const ImVec2 size = fit(_compare.diff);
+        const ImVec2 p0 = ImGui::GetCursorScreenPos();
+        Colormap::image(_compare.diff->id(), size, static_cast<Colormap::Map>(_heat_map), 0.0f, std::max(_compare.peak, 1.0f / 255.0f));
+        if (_compare.score > _compare.threshold)
+            ImGui::GetWindowDrawList()->AddRect(p0, ImVec2(p0.x + size.x, p0.y + size.y), IM_COL32(255, 115, 90, 255), 0.0f, 0, 2.0f);
+    }
+    else
+    {
+        ImGui::TextDisabled(same_size || !frames[0] || !frames[1] ? "Waiting for frames." : "The frames differ in size.");
+    }
+    ImGui::EndGroup();
+}
+
 static void _render_preview()
 {
 
@@ -788,6 +1673,8 @@ static void _render_preview()
     {
         Preview::previews[i]->update(); // update the visualizations (textures, features, etc ..)
     }
+    _update_comparison();
+    _compare.shown = false;
 
     { // control zone
         auto playing = Pipeline::isSimRunning();
@@ -817,6 +1704,8 @@ static void _render_preview()
         ImGui::PopStyleVar();
     }
 
+    _render_history_controls();
+
     if (ImGui::BeginTabBar("Tabs"))
     {
         if (ImGui::BeginTabItem("Basic"))
@@ -825,6 +1714,18 @@ static void _render_preview()
             ImGui::EndTabItem();
         }
 
+        if (ImGui::BeginTabItem("Mosaic"))
+        {
+            _render_mosaic();
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem("Compare"))
+        {
+            _render_compare();
+            ImGui::EndTabItem();
+        }
+
         for (int i = 0; i < Pipeline::PipelineConfig::pipelineMethods.size(); i++)
         {
             ImGui::PushID(i);
@@ -838,7 +1739,8 @@ static void _render_preview()
                     FontManager::popFont();
 
                     if (agent.methods[i]) {
-                        _render_visualizable(Preview::previews[index]->method_visualizations[i], "No observations available.");
+                        _render_visualizable(Preview::previews[index]->method_visualizations[i], "No observations available.",
+                                             Preview::previews[index]->env_visualization);
                     } else {
                         ImGui::Text("No method visualization available.");
                     }
@@ -848,7 +1750,7 @@ static void _render_preview()
                         ImGui::Text("<Episode completed>");
                     }
 
-                    ImGui::EndChild(); });
+                    ImGui::EndChild(); }, i);
                 ImGui::EndTabItem();
             }
             ImGui::PopID();
@@ -860,7 +1762,12 @@ static void _render_preview()
 
 void Preview::render()
 {
-    ImGui::Begin("Preview");
+    // collapsed or behind another dock tab: nothing gets drawn, so nothing gets fetched either
+    if (!ImGui::Begin("Preview"))
+    {
+        ImGui::End();
+        return;
+    }
 
     if (!Pipeline::isExperimenting())
     {
@@ -886,6 +1793,10 @@ std::vector<Preview::VisualizedAgent *> Preview::previews;
 
 void Preview::onStart()
 {
+    _heat_shared_range.clear();
+    _scrub_step = -1;
+    _mosaic.clear();
+    _reset_comparison();
     for (auto &agent : Pipeline::PipelineState::activeAgents)
     {
         previews.push_back(new Preview::VisualizedAgent());
@@ -893,6 +1804,14 @@ void Preview::onStart()
     }
 }
 
+void Preview::onStep()
+{
+    if (!_history_record)
+        return;
+    for (const auto *preview : previews)
+        preview->record();
+}
+
 void Preview::onStop()
 {
     for (auto prev : previews)
@@ -911,4 +1830,8 @@ void Preview::destroy()
     }
 
     previews.clear();
+    Colormap::destroy();
+    _mosaic.destroy();
+    delete _compare.diff;
+    _compare.diff = nullptr;
 }
@@ -1,21 +1,48 @@
 #ifndef PREVIEW_HPP
 #define PREVIEW_HPP
-#include <map>
+#include <string>
+#include <vector>
 
 #include "pipeline.hpp"
+#include "../utility/colormap.hpp"
+#include "../utility/frame_history.hpp"
 #include "../utility/gl_texture.hpp"
 
 namespace Preview
 {
+    // FEATURES / BAR_CHART. Names declared by the object stay fixed and only the values are
+    // refreshed per step, otherwise (dicts) both are rebuilt on every fetch
+    struct NamedValues
+    {
+        std::vector<std::string> names;
+        std::vector<float> values;
+        bool declared = false;
+    };
+
+    // a recorded frame decoded for the scrub bar
+    struct Replay
+    {
+        GLTexture *texture = nullptr;
+        int64_t step = -1; // what the texture holds
+        float min = 0.0f, max = 1.0f; // of a heat map
+
+        ~Replay() { delete texture; }
+    };
+
     struct VisualizedObject
     {
         PyVisualizable *visualizable;
 
         GLTexture *rgb_array = nullptr;
         GLTexture *gray = nullptr;
-        GLTexture *heat_map = nullptr;
-        std::map<std::string, float> bar_chart;
-        std::map<std::string, std::string> features;
+        GLTexture *heat_map = nullptr; // single channel float, colored when drawn
+        Colormap::RollingRange heat_range;
+        FrameHistory rgb_history;
+        FrameHistory heat_history;
+        Replay rgb_replay;
+        Replay heat_replay;
+        NamedValues bar_chart;
+        NamedValues features;
 
         PyLiveObject *rgb_array_params = nullptr;
         PyLiveObject *gray_params = nullptr;
@@ -24,20 +51,52 @@ namespace Preview
         PyLiveObject *bar_chart_params = nullptr;
 
         void init(PyVisualizable *);
-        [[nodiscard]] bool supports(VisualizationMethod method) const;
-        void update();
+        [[nodiscard]] bool supports(VisualizationMethod method) const; // cached at init
+        [[nodiscard]] PyLiveObject *params(VisualizationMethod method) const;
+        // called while rendering, update() only fetches what was drawn the frame before
+        void markDrawn(VisualizationMethod method);
+        // drawn as a mosaic cell instead: the RGB frame goes into that cell of the shared atlas
+        void markThumbnail(int cell);
+        // after editing params(method), refetches it without waiting for a step
+        void paramsChanged(VisualizationMethod method);
+        void update(int64_t step, int64_t episode);
+        // env frame / heat map of this step into the histories, drawn or not
+        void record(int64_t step);
 
         ~VisualizedObject();
 
     private:
+        static constexpr int METHOD_COUNT = static_cast<int>(VisualizationMethod::BAR_CHART) + 1;
+        bool capable_[METHOD_COUNT] = {};
+        unsigned drawn_ = 0; // bit per method, this frame
+        unsigned shown_ = 0; // last frame
+        int thumbnail_drawn_ = -1; // mosaic cell, this frame
+        int thumbnail_ = -1; // last frame
+
+        // what a modality was last fetched for
+        struct Version
+        {
+            int64_t step = -1;
+            int64_t episode = -1;
+            unsigned params = 0;
+            int cell = -1; // where it went, own texture or a mosaic cell
+
+            bool operator==(const Version &) const = default;
+        };
+        Version fetched_[METHOD_COUNT];
+        Version fetching_;
+        unsigned params_version_[METHOD_COUNT] = {};
+
+        [[nodiscard]] bool _shown(VisualizationMethod method) const;
+
         void _init_rgb_array();
-        void _update_rgb_array() const;
+        void _update_rgb_array();
 
         void _init_gray();
         void _update_gray() const;
 
         void _init_heat_map();
-        void _update_heat_map() const;
+        void _update_heat_map();
 
         void _init_features();
         void _update_features();
@@ -55,6 +114,7 @@ namespace Preview
 
         void init(Pipeline::ActiveAgent *agent);
         void update() const;
+        void record() const;
 
         ~VisualizedAgent();
     };
@@ -64,6 +124,9 @@ namespace Preview
     void init();
     void render();
     void onStart();
+    // after every simulation tick, GIL held. Records the tick into the scrub history while
+    // recording is on, the window doesn't have to be visible
+    void onStep();
     void onStop();
     void destroy();
 };
@@ -0,0 +1,171 @@
+#include "serving.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "logger.hpp"
+#include "pipeline.hpp"
+#include "../../backend/inference_server.hpp"
+#include "../../backend/py_safe_wrapper.hpp"
+
+namespace Serving
+{
+    static std::unique_ptr<InferenceServer> server;
+    static InferenceServerConfig config;
+    static int served_agent = 0;
+
+    // requests per second, one sample per stats refresh
+    static std::vector<float> throughput;
+    static double last_rate = -1;
+
+    void init()
+    {
+        server = std::make_unique<InferenceServer>();
+    }
+
+    void update()
+    {
+        if (!server || !server->running())
+            return;
+
+        if (!SafeWrapper::execute([&]
+                                  { server->poll(); }))
+        {
+            Logger::error("Inference server failed, stopping it.");
+            SafeWrapper::execute([&]
+                                 { server->stop(); });
+        }
+    }
+
+    static void _start()
+    {
+        auto &agents = Pipeline::PipelineState::activeAgents;
+        if (served_agent < 0 || served_agent >= static_cast<int>(agents.size()))
+        {
+            Logger::error("Select an agent of the running experiment to serve.");
+            return;
+        }
+
+        const auto &active = agents[served_agent];
+        throughput.clear();
+        last_rate = -1;
+        SafeWrapper::execute([&]
+                             { server->start(*active.agent, active.env->object, config); });
+    }
+
+    static void _render_stats()
+    {
+        const InferenceStats stats = server->stats();
+
+        if (stats.requests_per_second != last_rate)
+        {
+            last_rate = stats.requests_per_second;
+            throughput.push_back(static_cast<float>(stats.requests_per_second));
+            if (throughput.size() > 120)
+                throughput.erase(throughput.begin());
+        }
+
+        ImGui::Text("Mode: %s", stats.native ? "native model, server thread" : "python predict, UI thread");
+        ImGui::Text("Envs alive: %d", stats.live_envs);
+        ImGui::Text("Requests: %llu in %llu batches (%.1f / batch)", static_cast<unsigned long long>(stats.requests),
+                    static_cast<unsigned long long>(stats.batches), stats.mean_batch);
+        ImGui::Text("Throughput: %.0f actions/s", stats.requests_per_second);
+        ImGui::Text("Latency: %.0f us mean, %.0f us max", stats.mean_latency_us, stats.max_latency_us);
+        ImGui::Text("Env steps: %llu, episodes: %llu", static_cast<unsigned long long>(stats.env_steps),
+                    static_cast<unsigned long long>(stats.episodes));
+        ImGui::Text("Mean return (last episode per env): %.2f", stats.mean_return);
+
+        if (!throughput.empty())
+        {
+            const float top = *std::max_element(throughput.begin(), throughput.end());
+            ImGui::PlotLines("##throughput", throughput.data(), static_cast<int>(throughput.size()), 0, "actions/s", 0.0f,
+                             std::max(top * 1.1f, 1.0f), ImVec2(-1, 60));
+        }
+    }
+
+    void render()
+    {
+        ImGui::Begin("Serving");
+
+        const bool running = server && server->running();
+        auto &agents = Pipeline::PipelineState::activeAgents;
+
+        if (running)
+        {
+            if (ImGui::Button("Stop Server"))
+            {
+                SafeWrapper::execute([&]
+                                     { server->stop(); });
+            }
+        }
+        else
+        {
+            if (agents.empty())
+            {
+                ImGui::TextDisabled("Start an experiment to serve one of its agents.");
+            }
+            else
+            {
+                served_agent = std::clamp(served_agent, 0, static_cast<int>(agents.size()) - 1);
+                if (ImGui::BeginCombo("Agent", agents[served_agent].name))
+                {
+                    for (int i = 0; i < static_cast<int>(agents.size()); ++i)
+                    {
+                        ImGui::PushID(i);
+                        if (ImGui::Selectable(agents[i].name, i == served_agent))
+                            served_agent = i;
+                        ImGui::PopID();
+                    }
+                    ImGui::EndCombo();
+                }
+
+                if (ImGui::Button("Start Server"))
+                {
+                    _start();
+                }
+            }
+        }
+
+        if (running)
+        {
+            ImGui::BeginDisabled();
+        }
+
+        ImGui::TextDisabled("Configuration");
+        ImGui::InputInt("Workers", &config.workers);
+        ImGui::InputInt("Envs / Worker", &config.envs_per_worker);
+        ImGui::InputInt("Batch Window (us)", &config.window_us, 100, 1000);
+        ImGui::InputInt("Max Batch", &config.max_batch);
+        config.workers = std::max(config.workers, 1);
+        config.envs_per_worker = std::max(config.envs_per_worker, 1);
+        config.window_us = std::max(config.window_us, 0);
+        config.max_batch = std::max(config.max_batch, 1);
+
+        if (running)
+        {
+            ImGui::EndDisabled();
+        }
+
+        if (running)
+        {
+            ImGui::Separator();
+            ImGui::TextDisabled("Stats");
+            _render_stats();
+        }
+
+        ImGui::End();
+    }
+
+    void destroy()
+    {
+        // workers and the shared memory go away with the server, while python is still up
+        if (server)
+            SafeWrapper::execute([&]
+                                 { server->stop(); });
+        server.reset();
+    }
+}
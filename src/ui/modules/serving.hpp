@@ -0,0 +1,17 @@
+#ifndef SERVING_HPP
+#define SERVING_HPP
+
+namespace Serving
+{
+    // the inference server window: one of the experiment's agents serves env worker processes
+
+    void init();
+    void render();
+
+    // called before render, serves python agents and pulls the stats
+    void update();
+
+    void destroy();
+}
+
+#endif // SERVING_HPP
@@ -0,0 +1,358 @@
+#include <glad/glad.h>
+
+#include "colormap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "../modules/logger.hpp"
+
+const char *Colormap::mapNames[MAP_COUNT] = {"Viridis", "Magma", "Inferno", "Coolwarm", "Blue-Red", "Gray"};
+const char *Colormap::normalizationNames[NORMALIZATION_COUNT] = {"Fixed", "Per step", "Rolling"};
+
+namespace
+{
+    struct _Stop
+    {
+        float t;
+        uint8_t r, g, b;
+    };
+
+    // matplotlib's maps at a few stops, linear in between is close enough at 256 texels
+    const std::vector<_Stop> _STOPS[Colormap::MAP_COUNT] = {
+        {{0.000f, 68, 1, 84}, {0.125f, 71, 44, 122}, {0.250f, 59, 81, 139}, {0.375f, 44, 113, 142}, {0.500f, 33, 144, 141}, {0.625f, 39, 173, 129}, {0.750f, 92, 200, 99}, {0.875f, 170, 220, 50}, {1.000f, 253, 231, 37}},
+        {{0.000f, 0, 0, 4}, {0.125f, 28, 16, 68}, {0.250f, 79, 18, 123}, {0.375f, 129, 37, 129}, {0.500f, 181, 54, 122}, {0.625f, 229, 80, 100}, {0.750f, 251, 135, 97}, {0.875f, 254, 194, 135}, {1.000f, 252, 253, 191}},
+        {{0.000f, 0, 0, 4}, {0.125f, 31, 12, 72}, {0.250f, 85, 15, 109}, {0.375f, 136, 34, 106}, {0.500f, 186, 54, 85}, {0.625f, 227, 89, 51}, {0.750f, 249, 140, 10}, {0.875f, 249, 201, 50}, {1.000f, 252, 255, 164}},
+        {{0.000f, 59, 76, 192}, {0.250f, 124, 159, 249}, {0.500f, 221, 221, 221}, {0.750f, 246, 154, 123}, {1.000f, 180, 4, 38}},
+        {{0.000f, 0, 0, 255}, {1.000f, 255, 0, 0}}, // the preview's original ramp
+        {{0.000f, 0, 0, 0}, {1.000f, 255, 255, 255}},
+    };
+
+    GLuint _luts[Colormap::MAP_COUNT] = {};
+
+    GLuint _program = 0;
+    bool _failed = false;
+    GLint _u_proj = -1, _u_texture = -1, _u_lut = -1, _u_min = -1, _u_scale = -1;
+    GLint _u_heat = -1, _u_overlay = -1, _u_alpha = -1, _u_threshold = -1;
+
+    // same interface as the imgui backend's GLSL 130 shader, only the fragment differs
+    const char *_VERTEX = R"(#version 130
+uniform mat4 ProjMtx;
+in vec2 Position;
+in vec2 UV;
+in vec4 Color;
+out vec2 Frag_UV;
+out vec4 Frag_Color;
+void main()
+{
+    Frag_UV = UV;
+    Frag_Color = Color;
+    gl_Position = ProjMtx * vec4(Position.xy, 0, 1);
+}
+)";
+
+    const char *_FRAGMENT = R"(#version 130
+uniform sampler2D Texture;
+uniform sampler2D Lut;
+uniform sampler2D Heat;
+uniform bool Overlay;
+uniform float RangeMin;
+uniform float RangeScale;
+uniform float Alpha;
+uniform float Threshold;
+in vec2 Frag_UV;
+in vec4 Frag_Color;
+out vec4 Out_Color;
+vec3 colormap(float value, out float t)
+{
+    t = clamp((value - RangeMin) * RangeScale, 0.0, 1.0);
+    // texel centers, so 0 and 1 hit the ends of the map exactly
+    return texture(Lut, vec2(t * (255.0 / 256.0) + 0.5 / 256.0, 0.5)).rgb;
+}
+void main()
+{
+    float t;
+    if (!Overlay)
+    {
+        Out_Color = Frag_Color * vec4(colormap(texture(Texture, Frag_UV).r, t), 1.0);
+        return;
+    }
+    // Texture is the image below, the heat map is sampled at the same uv whatever its size
+    vec4 base = texture(Texture, Frag_UV);
+    vec3 rgb = colormap(texture(Heat, Frag_UV).r, t);
+    Out_Color = Frag_Color * vec4(mix(base.rgb, rgb, t >= Threshold ? Alpha : 0.0), base.a);
+}
+)";
+
+    struct _Draw
+    {
+        GLuint lut;
+        float min;
+        float scale;
+        GLuint heat; // 0 unless overlaying
+        float alpha;
+        float threshold;
+    };
+
+    GLuint _compile(GLenum type, const char *source)
+    {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint ok = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (!ok)
+        {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            Logger::error("Colormap shader: " + std::string(log));
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    // built on the first draw, the attribute locations have to match the imgui program's
+    // since the vertex array set up by the backend is reused as is
+    bool _build(GLuint imgui_program)
+    {
+        if (_program || _failed)
+            return _program != 0;
+
+        GLuint vs = _compile(GL_VERTEX_SHADER, _VERTEX);
+        GLuint fs = _compile(GL_FRAGMENT_SHADER, _FRAGMENT);
+        if (!vs || !fs)
+        {
+            glDeleteShader(vs);
+            glDeleteShader(fs);
+            _failed = true;
+            return false;
+        }
+
+        _program = glCreateProgram();
+        glAttachShader(_program, vs);
+        glAttachShader(_program, fs);
+        for (const char *attribute : {"Position", "UV", "Color"})
+        {
+            const GLint location = glGetAttribLocation(imgui_program, attribute);
+            if (location >= 0)
+                glBindAttribLocation(_program, static_cast<GLuint>(location), attribute);
+        }
+        glLinkProgram(_program);
+        glDetachShader(_program, vs);
+        glDetachShader(_program, fs);
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+
+        GLint ok = GL_FALSE;
+        glGetProgramiv(_program, GL_LINK_STATUS, &ok);
+        if (!ok)
+        {
+            char log[1024];
+            glGetProgramInfoLog(_program, sizeof(log), nullptr, log);
+            Logger::error("Colormap shader: " + std::string(log));
+            glDeleteProgram(_program);
+            _program = 0;
+            _failed = true;
+            return false;
+        }
+
+        _u_proj = glGetUniformLocation(_program, "ProjMtx");
+        _u_texture = glGetUniformLocation(_program, "Texture");
+        _u_lut = glGetUniformLocation(_program, "Lut");
+        _u_min = glGetUniformLocation(_program, "RangeMin");
+        _u_scale = glGetUniformLocation(_program, "RangeScale");
+        _u_heat = glGetUniformLocation(_program, "Heat");
+        _u_overlay = glGetUniformLocation(_program, "Overlay");
+        _u_alpha = glGetUniformLocation(_program, "Alpha");
+        _u_threshold = glGetUniformLocation(_program, "Threshold");
+        return true;
+    }
+
+    // runs in the middle of the imgui backend's draw loop, the image command that follows
+    // binds the value texture to unit 0 and draws with whatever program is current
+    void _begin(const ImDrawList *, const ImDrawCmd *cmd)
+    {
+        const auto *draw = static_cast<const _Draw *>(cmd->UserCallbackData);
+
+        GLint imgui_program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &imgui_program);
+        if (!imgui_program || !_build(static_cast<GLuint>(imgui_program)))
+            return; // plain image then
+
+        GLfloat projection[16];
+        glGetUniformfv(static_cast<GLuint>(imgui_program), glGetUniformLocation(imgui_program, "ProjMtx"), projection);
+
+        glUseProgram(_program);
+        glUniformMatrix4fv(_u_proj, 1, GL_FALSE, projection);
+        glUniform1i(_u_texture, 0);
+        glUniform1i(_u_lut, 1);
+        glUniform1f(_u_min, draw->min);
+        glUniform1f(_u_scale, draw->scale);
+        glUniform1i(_u_heat, 2);
+        glUniform1i(_u_overlay, draw->heat != 0);
+        glUniform1f(_u_alpha, draw->alpha);
+        glUniform1f(_u_threshold, draw->threshold);
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, draw->lut);
+        if (draw->heat)
+        {
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, draw->heat);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void _draw(GLuint texture, const ImVec2 &size, const _Draw &draw)
+    {
+        const ImVec2 pos = ImGui::GetCursorScreenPos();
+        ImDrawList *draw_list = ImGui::GetWindowDrawList();
+        draw_list->AddCallback(_begin, const_cast<_Draw *>(&draw), sizeof(draw)); // copied into the draw list
+        draw_list->AddImage(static_cast<ImTextureID>(texture), pos, ImVec2(pos.x + size.x, pos.y + size.y));
+        draw_list->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+        ImGui::Dummy(size);
+    }
+}
+
+void Colormap::RollingRange::push(int64_t step, float min, float max)
+{
+    if (!(min <= max)) // nothing finite in the map
+        return;
+
+    // a lagging agent's step folds into the newest one
+    if (!entries_.empty() && step <= entries_.back().step)
+    {
+        entries_.back().min = std::min(entries_.back().min, min);
+        entries_.back().max = std::max(entries_.back().max, max);
+        return;
+    }
+
+    entries_.push_back({step, min, max});
+    while (entries_.size() > MAX_WINDOW)
+        entries_.pop_front();
+}
+
+bool Colormap::RollingRange::range(int window, float &min, float &max) const
+{
+    if (entries_.empty())
+        return false;
+
+    const int64_t newest = entries_.back().step;
+    min = entries_.back().min;
+    max = entries_.back().max;
+    for (auto it = entries_.rbegin(); it != entries_.rend() && it->step > newest - window; ++it)
+    {
+        min = std::min(min, it->min);
+        max = std::max(max, it->max);
+    }
+    return true;
+}
+
+void Colormap::table(Map map, uint8_t *out)
+{
+    if (map < 0 || map >= MAP_COUNT)
+        map = VIRIDIS;
+
+    const auto &stops = _STOPS[map];
+    size_t s = 0;
+    for (int i = 0; i < 256; i++)
+    {
+        const float t = i / 255.0f;
+        while (s + 2 < stops.size() && t > stops[s + 1].t)
+            s++;
+
+        const _Stop &a = stops[s], &b = stops[s + 1];
+        const float w = std::clamp((t - a.t) / (b.t - a.t), 0.0f, 1.0f);
+        out[3 * i + 0] = static_cast<uint8_t>(std::lround(a.r + (b.r - a.r) * w));
+        out[3 * i + 1] = static_cast<uint8_t>(std::lround(a.g + (b.g - a.g) * w));
+        out[3 * i + 2] = static_cast<uint8_t>(std::lround(a.b + (b.b - a.b) * w));
+    }
+}
+
+GLuint Colormap::lut(Map map)
+{
+    if (map < 0 || map >= MAP_COUNT)
+        map = VIRIDIS;
+    if (_luts[map])
+        return _luts[map];
+
+    std::array<uint8_t, 256 * 3> texels{};
+    table(map, texels.data());
+
+    glGenTextures(1, &_luts[map]);
+    glBindTexture(GL_TEXTURE_2D, _luts[map]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 256, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, texels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return _luts[map];
+}
+
+void Colormap::image(GLuint texture, const ImVec2 &size, Map map, float min, float max)
+{
+    const float range = max - min;
+    _draw(texture, size, {lut(map), min, range > 0 ? 1.0f / range : 0.0f, 0, 0.0f, 0.0f}); // flat range -> start of the map
+}
+
+void Colormap::overlay(GLuint base, GLuint heat, const ImVec2 &size, Map map, float min, float max, float alpha, float threshold)
+{
+    const float range = max - min;
+    _draw(base, size, {lut(map), min, range > 0 ? 1.0f / range : 0.0f, heat, alpha, threshold});
+}
+
+void Colormap::overlayRgb(uint8_t *rgb, int width, int height, const float *heat, int heat_width, int heat_height,
+                          Map map, float min, float max, float alpha, float threshold)
+{
+    uint8_t colors[256 * 3];
+    table(map, colors);
+
+    const float range = max - min;
+    const float scale = range > 0 ? 1.0f / range : 0.0f;
+    const int a = static_cast<int>(std::lround(std::clamp(alpha, 0.0f, 1.0f) * 256));
+
+    // nearest heat texel per pixel, same uv mapping as the shader
+    std::vector<int> columns(width);
+    for (int x = 0; x < width; x++)
+        columns[x] = std::min(heat_width - 1, static_cast<int>((x + 0.5f) * heat_width / width));
+
+    for (int y = 0; y < height; y++)
+    {
+        const float *heat_row = heat + static_cast<size_t>(std::min(heat_height - 1, static_cast<int>((y + 0.5f) * heat_height / height))) * heat_width;
+        uint8_t *row = rgb + static_cast<size_t>(y) * width * 3;
+        for (int x = 0; x < width; x++)
+        {
+            const float value = heat_row[columns[x]];
+            const float t = value == value ? std::clamp((value - min) * scale, 0.0f, 1.0f) : 0.0f; // nan -> start
+            if (t < threshold)
+                continue;
+
+            const uint8_t *color = colors + 3 * static_cast<int>(t * 255.0f + 0.5f);
+            uint8_t *pixel = row + 3 * x;
+            for (int c = 0; c < 3; c++)
+                pixel[c] = static_cast<uint8_t>(pixel[c] + (((color[c] - pixel[c]) * a) >> 8));
+        }
+    }
+}
+
+void Colormap::destroy()
+{
+    for (GLuint &lut : _luts)
+    {
+        if (lut)
+            glDeleteTextures(1, &lut);
+        lut = 0;
+    }
+
+    if (_program)
+        glDeleteProgram(_program);
+    _program = 0;
+    _failed = false;
+}
@@ -0,0 +1,78 @@
+#ifndef COLORMAP_HPP
+#define COLORMAP_HPP
+
+#include <cstdint>
+#include <deque>
+#include <imgui.h>
+#include <GL/gl.h>
+
+// Heat maps stay single channel float textures, the coloring happens in a fragment shader
+// through a 256 texel lookup texture per colormap.
+namespace Colormap
+{
+    enum Map
+    {
+        VIRIDIS = 0,
+        MAGMA,
+        INFERNO,
+        COOLWARM,
+        BLUE_RED,
+        GRAY,
+        MAP_COUNT
+    };
+    extern const char *mapNames[MAP_COUNT];
+
+    enum Normalization
+    {
+        FIXED = 0,
+        PER_STEP,
+        ROLLING,
+        NORMALIZATION_COUNT
+    };
+    extern const char *normalizationNames[NORMALIZATION_COUNT];
+
+    // min / max over the last simulation steps. Pushes for the same step merge, so one range
+    // can be shared by the heat maps of every agent (they step in lockstep)
+    class RollingRange
+    {
+    public:
+        void push(int64_t step, float min, float max);
+
+        // union over the newest `window` steps. false if nothing was pushed yet
+        bool range(int window, float &min, float &max) const;
+        void clear() { entries_.clear(); }
+
+        static constexpr int MAX_WINDOW = 1024;
+
+    private:
+        struct Entry
+        {
+            int64_t step;
+            float min, max;
+        };
+        std::deque<Entry> entries_;
+    };
+
+    // the map at 256 steps, out is 256 * 3 bytes of rgb
+    void table(Map map, uint8_t *out);
+
+    // 256x1 RGB texture of the map, also fine for ImGui::Image (legends)
+    GLuint lut(Map map);
+
+    // draws a float texture (value in red) through the map, min -> start, max -> end of the map
+    void image(GLuint texture, const ImVec2 &size, Map map, float min, float max);
+
+    // the heat map (float, value in red) colored through the map and blended over an image at
+    // alpha, where its normalized value reaches threshold. Both are sampled at the same uv, so
+    // they may differ in size
+    void overlay(GLuint base, GLuint heat, const ImVec2 &size, Map map, float min, float max, float alpha, float threshold);
+
+    // overlay() on the cpu, for frames that never reach the screen: rgb (packed, width x height)
+    // is blended in place, the heat map (packed floats) is sampled nearest at the same uv
+    void overlayRgb(uint8_t *rgb, int width, int height, const float *heat, int heat_width, int heat_height,
+                    Map map, float min, float max, float alpha, float threshold);
+
+    void destroy();
+}
+
+#endif // COLORMAP_HPP
@@ -0,0 +1,378 @@
+#include "frame_convert.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define FRAME_CONVERT_AVX2 1
+#endif
+
+namespace
+{
+    inline uint8_t _toU8(float v)
+    {
+        // same clamp order as the vector path, NaN ends up 0
+        v = v * 255.0f + 0.5f;
+        v = v > 0.0f ? v : 0.0f;
+        v = v < 255.0f ? v : 255.0f;
+        return static_cast<uint8_t>(v);
+    }
+
+#ifdef FRAME_CONVERT_AVX2
+    // 32 floats -> 32 bytes, rounded and clamped
+    inline __m256i _pack32(const float *in, __m256 scale)
+    {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 top = _mm256_set1_ps(255.0f);
+        const __m256 half = _mm256_set1_ps(0.5f);
+
+        __m256i q[4];
+        for (int k = 0; k < 4; k++)
+        {
+            __m256 v = _mm256_fmadd_ps(_mm256_loadu_ps(in + 8 * k), scale, half);
+            v = _mm256_min_ps(_mm256_max_ps(v, zero), top); // max(NaN, 0) is 0
+            q[k] = _mm256_cvttps_epi32(v);
+        }
+
+        // packs work per 128 bit lane, the permute puts the 4 byte groups back in order
+        const __m256i words = _mm256_packus_epi32(q[0], q[1]);
+        const __m256i words2 = _mm256_packus_epi32(q[2], q[3]);
+        const __m256i bytes = _mm256_packus_epi16(words, words2);
+        return _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    }
+
+    // pshufb masks spreading 16 planar bytes over 48 interleaved ones, for component c
+    constexpr std::array<std::array<int8_t, 16>, 3> _spread(int c)
+    {
+        std::array<std::array<int8_t, 16>, 3> mask{};
+        for (int k = 0; k < 3; k++)
+        {
+            for (int j = 0; j < 16; j++)
+            {
+                const int p = 16 * k + j;
+                mask[k][j] = p % 3 == c ? static_cast<int8_t>(p / 3) : static_cast<int8_t>(0x80);
+            }
+        }
+        return mask;
+    }
+
+    constexpr auto SPREAD_R = _spread(0);
+    constexpr auto SPREAD_G = _spread(1);
+    constexpr auto SPREAD_B = _spread(2);
+
+    inline __m128i _mask(const std::array<int8_t, 16> &m)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(m.data()));
+    }
+
+    // 16 pixels of planar r / g / b -> 48 bytes of RGB
+    inline void _interleave16(__m128i r, __m128i g, __m128i b, uint8_t *out)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            __m128i v = _mm_or_si128(_mm_shuffle_epi8(r, _mask(SPREAD_R[k])), _mm_shuffle_epi8(b, _mask(SPREAD_B[k])));
+            v = _mm_or_si128(v, _mm_shuffle_epi8(g, _mask(SPREAD_G[k])));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16 * k), v);
+        }
+    }
+#endif
+
+    // one channel value of a view, floats scaled to bytes
+    inline uint8_t _byteAt(const uint8_t *p, FrameConvert::Dtype dtype)
+    {
+        switch (dtype)
+        {
+        case FrameConvert::Dtype::U8:
+            return *p;
+        case FrameConvert::Dtype::F32:
+            return _toU8(*reinterpret_cast<const float *>(p));
+        default:
+            return _toU8(static_cast<float>(*reinterpret_cast<const double *>(p)));
+        }
+    }
+
+    inline float _floatAt(const uint8_t *p, FrameConvert::Dtype dtype)
+    {
+        switch (dtype)
+        {
+        case FrameConvert::Dtype::U8:
+            return *p;
+        case FrameConvert::Dtype::F32:
+            return *reinterpret_cast<const float *>(p);
+        default:
+            return static_cast<float>(*reinterpret_cast<const double *>(p));
+        }
+    }
+
+    inline const uint8_t *_row(const FrameConvert::ImageView &in, int y)
+    {
+        return static_cast<const uint8_t *>(in.data) + y * in.row_stride;
+    }
+
+    void _u8GrayToRgb(const uint8_t *in, uint8_t *out, size_t pixels)
+    {
+        size_t i = 0;
+#ifdef FRAME_CONVERT_AVX2
+        for (; i + 16 <= pixels; i += 16)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+            _interleave16(v, v, v, out + 3 * i);
+        }
+#endif
+        for (; i < pixels; i++)
+            out[3 * i + 0] = out[3 * i + 1] = out[3 * i + 2] = in[i];
+    }
+
+    // sums[i] += row[i], up to 257 rows fit the 16 bit sums
+    void _accumulate(const uint8_t *row, uint16_t *sums, size_t n)
+    {
+        size_t i = 0;
+#ifdef FRAME_CONVERT_AVX2
+        for (; i + 32 <= n; i += 32)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i));
+            __m256i *s = reinterpret_cast<__m256i *>(sums + i);
+            _mm256_storeu_si256(s, _mm256_add_epi16(_mm256_loadu_si256(s), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v))));
+            _mm256_storeu_si256(s + 1, _mm256_add_epi16(_mm256_loadu_si256(s + 1), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1))));
+        }
+#endif
+        for (; i < n; i++)
+            sums[i] += row[i];
+    }
+}
+
+void FrameConvert::unitFloatToU8(const float *in, uint8_t *out, size_t n)
+{
+    size_t i = 0;
+#ifdef FRAME_CONVERT_AVX2
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    for (; i + 32 <= n; i += 32)
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _pack32(in + i, scale));
+#endif
+    for (; i < n; i++)
+        out[i] = _toU8(in[i]);
+}
+
+void FrameConvert::grayToRgb(const float *in, uint8_t *out, size_t pixels)
+{
+    size_t i = 0;
+#ifdef FRAME_CONVERT_AVX2
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    for (; i + 32 <= pixels; i += 32)
+    {
+        const __m256i gray = _pack32(in + i, scale);
+        const __m128i lo = _mm256_castsi256_si128(gray);
+        const __m128i hi = _mm256_extracti128_si256(gray, 1);
+        _interleave16(lo, lo, lo, out + 3 * i);
+        _interleave16(hi, hi, hi, out + 3 * i + 48);
+    }
+#endif
+    for (; i < pixels; i++)
+    {
+        const uint8_t v = _toU8(in[i]);
+        out[3 * i + 0] = v;
+        out[3 * i + 1] = v;
+        out[3 * i + 2] = v;
+    }
+}
+
+void FrameConvert::minMax(const float *in, size_t n, float &min, float &max)
+{
+    float lo = std::numeric_limits<float>::infinity();
+    float hi = -std::numeric_limits<float>::infinity();
+    size_t i = 0;
+#ifdef FRAME_CONVERT_AVX2
+    if (n >= 8)
+    {
+        __m256 vlo = _mm256_set1_ps(lo), vhi = _mm256_set1_ps(hi);
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256 v = _mm256_loadu_ps(in + i);
+            vlo = _mm256_min_ps(v, vlo); // NaN in v -> keeps vlo, like the scalar tail
+            vhi = _mm256_max_ps(v, vhi);
+        }
+        alignas(32) float l[8], h[8];
+        _mm256_store_ps(l, vlo);
+        _mm256_store_ps(h, vhi);
+        lo = *std::min_element(l, l + 8);
+        hi = *std::max_element(h, h + 8);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        lo = std::min(lo, in[i]);
+        hi = std::max(hi, in[i]);
+    }
+    min = lo;
+    max = hi;
+}
+
+void FrameConvert::toU8(const ImageView &in, uint8_t *out)
+{
+    const size_t row_values = static_cast<size_t>(in.width) * in.channels;
+    const bool packed = in.rowsPacked();
+
+    for (int y = 0; y < in.height; y++, out += row_values)
+    {
+        const uint8_t *row = _row(in, y);
+        if (packed && in.dtype == Dtype::U8)
+        {
+            std::memcpy(out, row, row_values);
+        }
+        else if (packed && in.dtype == Dtype::F32)
+        {
+            unitFloatToU8(reinterpret_cast<const float *>(row), out, row_values);
+        }
+        else
+        {
+            uint8_t *o = out;
+            for (int x = 0; x < in.width; x++)
+                for (int c = 0; c < in.channels; c++)
+                    *o++ = _byteAt(row + x * in.col_stride + c * in.channel_stride, in.dtype);
+        }
+    }
+}
+
+void FrameConvert::grayToRgb(const ImageView &in, uint8_t *out)
+{
+    const size_t row_bytes = static_cast<size_t>(in.width) * 3;
+    const bool packed = in.col_stride == static_cast<ptrdiff_t>(in.itemSize()); // only channel 0 is read
+
+    for (int y = 0; y < in.height; y++, out += row_bytes)
+    {
+        const uint8_t *row = _row(in, y);
+        if (packed && in.dtype == Dtype::U8)
+        {
+            _u8GrayToRgb(row, out, in.width);
+        }
+        else if (packed && in.dtype == Dtype::F32)
+        {
+            grayToRgb(reinterpret_cast<const float *>(row), out, in.width);
+        }
+        else
+        {
+            for (int x = 0; x < in.width; x++)
+                out[3 * x + 0] = out[3 * x + 1] = out[3 * x + 2] = _byteAt(row + x * in.col_stride, in.dtype);
+        }
+    }
+}
+
+void FrameConvert::toFloat(const ImageView &in, float *out)
+{
+    const bool packed = in.col_stride == static_cast<ptrdiff_t>(in.itemSize());
+
+    for (int y = 0; y < in.height; y++, out += in.width)
+    {
+        const uint8_t *row = _row(in, y);
+        if (packed && in.dtype == Dtype::F32)
+        {
+            std::memcpy(out, row, static_cast<size_t>(in.width) * sizeof(float));
+        }
+        else
+        {
+            for (int x = 0; x < in.width; x++)
+                out[x] = _floatAt(row + x * in.col_stride, in.dtype);
+        }
+    }
+}
+
+void FrameConvert::boxDownsample(const uint8_t *in, int width, int height, int channels, int factor, uint8_t *out, ptrdiff_t out_stride)
+{
+    const int out_width = width / factor;
+    const int out_height = height / factor;
+    const size_t row = static_cast<size_t>(width) * channels;
+    const size_t used = static_cast<size_t>(out_width) * factor * channels;
+
+    if (factor == 1)
+    {
+        for (int y = 0; y < out_height; y++)
+            std::memcpy(out + y * out_stride, in + y * row, used);
+        return;
+    }
+
+    // the rows of a box are summed vertically first (the bulk of the work, vectorized),
+    // then each box is one short horizontal sum
+    thread_local std::vector<uint16_t> sums;
+    sums.resize(used);
+    const uint32_t area = static_cast<uint32_t>(factor) * factor;
+
+    for (int oy = 0; oy < out_height; oy++)
+    {
+        std::fill(sums.begin(), sums.end(), 0);
+        for (int k = 0; k < factor; k++)
+            _accumulate(in + static_cast<size_t>(oy * factor + k) * row, sums.data(), used);
+
+        uint8_t *o = out + oy * out_stride;
+        for (int ox = 0; ox < out_width; ox++)
+        {
+            const uint16_t *box = sums.data() + static_cast<size_t>(ox) * factor * channels;
+            for (int c = 0; c < channels; c++)
+            {
+                uint32_t sum = 0;
+                for (int k = 0; k < factor; k++)
+                    sum += box[k * channels + c];
+                *o++ = static_cast<uint8_t>((sum + area / 2) / area);
+            }
+        }
+    }
+}
+
+float FrameConvert::absDiff(const uint8_t *a, const uint8_t *b, size_t pixels, int channels, float *out)
+{
+    constexpr size_t CHUNK = 1024; // pixels per pass, their byte diffs stay in L1
+    uint8_t diff[CHUNK * 4];
+    uint64_t total = 0;
+    const float scale = 1.0f / 255.0f;
+
+    for (size_t p0 = 0; p0 < pixels; p0 += CHUNK)
+    {
+        const size_t count = std::min(CHUNK, pixels - p0);
+        const size_t bytes = count * channels;
+        const uint8_t *pa = a + p0 * channels;
+        const uint8_t *pb = b + p0 * channels;
+        size_t i = 0;
+#ifdef FRAME_CONVERT_AVX2
+        // |a - b| as two saturating subtractions, sad against zero sums it per 8 bytes
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i sum = zero;
+        for (; i + 32 <= bytes; i += 32)
+        {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pa + i));
+            const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pb + i));
+            const __m256i d = _mm256_or_si256(_mm256_subs_epu8(x, y), _mm256_subs_epu8(y, x));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(diff + i), d);
+            sum = _mm256_add_epi64(sum, _mm256_sad_epu8(d, zero));
+        }
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), sum);
+        total += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+        for (; i < bytes; i++)
+        {
+            diff[i] = static_cast<uint8_t>(pa[i] > pb[i] ? pa[i] - pb[i] : pb[i] - pa[i]);
+            total += diff[i];
+        }
+
+        // a pixel counts as much as its most changed channel
+        float *o = out + p0;
+        if (channels == 1)
+        {
+            for (size_t k = 0; k < count; k++)
+                o[k] = diff[k] * scale;
+            continue;
+        }
+        for (size_t k = 0; k < count; k++)
+        {
+            const uint8_t *d = diff + k * channels;
+            uint8_t m = d[0];
+            for (int c = 1; c < channels; c++)
+                m = std::max(m, d[c]);
+            o[k] = m * scale;
+        }
+    }
+    return pixels ? static_cast<float>(total) * scale / static_cast<float>(pixels * channels) : 0.0f;
+}
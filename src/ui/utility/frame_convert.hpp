@@ -0,0 +1,63 @@
+#ifndef FRAME_CONVERT_HPP
+#define FRAME_CONVERT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel conversions of the preview, from the arrays the python side hands out to the
+// uint8 texels that get uploaded. AVX2 when the build allows it, scalar otherwise, same results.
+namespace FrameConvert
+{
+    // out[i] = clamp(round(in[i] * 255), 0, 255), NaN -> 0
+    void unitFloatToU8(const float *in, uint8_t *out, size_t n);
+
+    // gray [0, 1] -> interleaved RGB, out holds 3 * pixels bytes
+    void grayToRgb(const float *in, uint8_t *out, size_t pixels);
+
+    // one pass over the values, NaNs are skipped. min = inf, max = -inf if nothing is left
+    void minMax(const float *in, size_t n, float &min, float &max);
+
+    enum class Dtype
+    {
+        U8,
+        F32,
+        F64
+    };
+
+    // a (height, width, channels) image as it sits in someone else's memory, any strides (bytes)
+    struct ImageView
+    {
+        const void *data = nullptr;
+        Dtype dtype = Dtype::F32;
+        int height = 0, width = 0, channels = 0;
+        ptrdiff_t row_stride = 0, col_stride = 0, channel_stride = 0;
+
+        [[nodiscard]] size_t itemSize() const { return dtype == Dtype::U8 ? 1 : dtype == Dtype::F32 ? 4 : 8; }
+        // pixels and channels packed along a row, rows may still be apart
+        [[nodiscard]] bool rowsPacked() const
+        {
+            return channel_stride == static_cast<ptrdiff_t>(itemSize()) && col_stride == channel_stride * channels;
+        }
+        [[nodiscard]] bool packed() const { return rowsPacked() && row_stride == col_stride * width; }
+    };
+
+    // -> packed uint8, height * width * channels. uint8 is copied as is, floats are taken as [0, 1]
+    void toU8(const ImageView &in, uint8_t *out);
+
+    // channel 0 -> packed RGB uint8, height * width * 3
+    void grayToRgb(const ImageView &in, uint8_t *out);
+
+    // channel 0 -> packed float, height * width, values as they are (no scaling)
+    void toFloat(const ImageView &in, float *out);
+
+    // packed uint8 image -> (width / factor) x (height / factor), each texel the rounded mean of
+    // a factor x factor box (the columns / rows past the last whole box are dropped).
+    // Output rows are out_stride bytes apart. factor <= 256
+    void boxDownsample(const uint8_t *in, int width, int height, int channels, int factor, uint8_t *out, ptrdiff_t out_stride);
+
+    // two packed uint8 images of the same size -> out[pixel] = its largest channel |a - b| / 255.
+    // channels <= 4. Returns the mean |a - b| / 255 over every byte, 0 = identical frames
+    float absDiff(const uint8_t *a, const uint8_t *b, size_t pixels, int channels, float *out);
+}
+
+#endif // FRAME_CONVERT_HPP
@@ -0,0 +1,197 @@
+#include "frame_history.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FRAME_HISTORY_AVX2 1
+#endif
+
+namespace
+{
+    // equal stretches shorter than this stay inside a literal, a new run would cost more
+    constexpr size_t MIN_SKIP = 8;
+
+    // leading bytes where a and b (zeros if null) are equal, or differ
+    template <bool Equal>
+    size_t _run(const uint8_t *a, const uint8_t *b, size_t n)
+    {
+        size_t i = 0;
+#ifdef FRAME_HISTORY_AVX2
+        const __m256i zero = _mm256_setzero_si256();
+        for (; i + 32 <= n; i += 32)
+        {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            const __m256i y = b ? _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)) : zero;
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+            if (Equal)
+                mask = ~mask;
+            if (mask)
+                return i + __builtin_ctz(mask);
+        }
+#endif
+        for (; i < n; i++)
+        {
+            if ((a[i] == (b ? b[i] : 0)) != Equal)
+                return i;
+        }
+        return n;
+    }
+
+    void _varint(std::vector<uint8_t> &out, size_t v)
+    {
+        while (v >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    size_t _readVarint(const uint8_t *&p)
+    {
+        size_t v = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            const uint8_t b = *p++;
+            v |= static_cast<size_t>(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return v;
+        }
+    }
+
+    // (skip, literal count, literal bytes)* of cur against prev (zeros if null)
+    void _encode(const uint8_t *cur, const uint8_t *prev, size_t n, std::vector<uint8_t> &out)
+    {
+        out.clear();
+        size_t pos = 0;
+        while (pos < n)
+        {
+            const size_t skip = _run<true>(cur + pos, prev ? prev + pos : nullptr, n - pos);
+            pos += skip;
+
+            const size_t start = pos;
+            while (pos < n)
+            {
+                pos += _run<false>(cur + pos, prev ? prev + pos : nullptr, n - pos);
+                const size_t same = _run<true>(cur + pos, prev ? prev + pos : nullptr, std::min(MIN_SKIP, n - pos));
+                if (same >= MIN_SKIP || pos + same == n)
+                    break;
+                pos += same;
+            }
+
+            _varint(out, skip);
+            _varint(out, pos - start);
+            out.insert(out.end(), cur + start, cur + pos);
+        }
+    }
+
+    // applies a code onto the frame before it
+    void _decode(const std::vector<uint8_t> &code, uint8_t *frame)
+    {
+        const uint8_t *p = code.data();
+        const uint8_t *end = p + code.size();
+        size_t pos = 0;
+        while (p < end)
+        {
+            pos += _readVarint(p);
+            const size_t literal = _readVarint(p);
+            std::memcpy(frame + pos, p, literal);
+            p += literal;
+            pos += literal;
+        }
+    }
+}
+
+void FrameHistory::push(int64_t step, const void *data, int width, int height, int channels, bool is_float)
+{
+    if (!entries_.empty() && step <= entries_.back().step)
+        return;
+
+    const size_t size = static_cast<size_t>(width) * height * channels * (is_float ? 4 : 1);
+    const auto *frame = static_cast<const uint8_t *>(data);
+
+    const Entry *previous = entries_.empty() ? nullptr : &entries_.back();
+    const bool key = !previous || since_key_ + 1 >= KEYFRAME_INTERVAL || previous->width != width ||
+                     previous->height != height || previous->channels != channels || previous->is_float != is_float;
+
+    Entry entry{step, width, height, channels, is_float, key, {}};
+    _encode(frame, key ? nullptr : last_.data(), size, entry.code);
+    entry.code.shrink_to_fit();
+    bytes_ += entry.code.size();
+    entries_.push_back(std::move(entry));
+
+    since_key_ = key ? 0 : since_key_ + 1;
+    last_.assign(frame, frame + size);
+    _evict();
+}
+
+void FrameHistory::_evict()
+{
+    // whole keyframe groups from the front, the newest group always stays
+    while (bytes_ > capacity_)
+    {
+        auto next_key = std::find_if(entries_.begin() + 1, entries_.end(), [](const Entry &e)
+                                     { return e.key; });
+        if (next_key == entries_.end())
+            break;
+
+        for (auto it = entries_.begin(); it != next_key; ++it)
+            bytes_ -= it->code.size();
+        entries_.erase(entries_.begin(), next_key);
+    }
+
+    if (cache_step_ >= 0 && cache_step_ < oldest())
+        cache_step_ = -1;
+}
+
+bool FrameHistory::decode(int64_t step, Frame &out) const
+{
+    // newest entry at or before step
+    auto it = std::upper_bound(entries_.begin(), entries_.end(), step, [](int64_t s, const Entry &e)
+                               { return s < e.step; });
+    if (it == entries_.begin())
+        return false;
+    const size_t target = static_cast<size_t>(it - entries_.begin()) - 1;
+
+    size_t key = target;
+    while (!entries_[key].key)
+        key--;
+
+    // the cache is usable if it holds an entry of this group at or before the target
+    size_t from = key;
+    bool cached = false;
+    if (cache_step_ >= entries_[key].step && cache_step_ <= entries_[target].step)
+    {
+        auto c = std::lower_bound(entries_.begin() + key, entries_.begin() + target + 1, cache_step_, [](const Entry &e, int64_t s)
+                                  { return e.step < s; });
+        from = static_cast<size_t>(c - entries_.begin()) + 1;
+        cached = true;
+    }
+
+    const Entry &t = entries_[target];
+    const size_t size = static_cast<size_t>(t.width) * t.height * t.channels * (t.is_float ? 4 : 1);
+    if (!cached)
+        cache_.assign(size, 0);
+    for (size_t i = from; i <= target; i++)
+        _decode(entries_[i].code, cache_.data());
+    cache_step_ = t.step;
+
+    out.width = t.width;
+    out.height = t.height;
+    out.channels = t.channels;
+    out.is_float = t.is_float;
+    out.data = cache_;
+    return true;
+}
+
+void FrameHistory::clear()
+{
+    entries_.clear();
+    last_.clear();
+    bytes_ = 0;
+    since_key_ = 0;
+    cache_.clear();
+    cache_step_ = -1;
+}
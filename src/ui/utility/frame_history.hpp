@@ -0,0 +1,63 @@
+#ifndef FRAME_HISTORY_HPP
+#define FRAME_HISTORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Recent frames of one view, compressed, so any past step can be shown again. Each frame is
+// coded against the one before it: runs of unchanged bytes are skipped, the changed bytes are
+// stored as they are. Every KEYFRAME_INTERVAL frames (and on a size change) a frame is coded
+// against zeros instead, decoding a step replays at most that many frames. Past the capacity
+// the oldest keyframe groups are dropped.
+class FrameHistory
+{
+public:
+    struct Frame
+    {
+        int width = 0, height = 0, channels = 0;
+        bool is_float = false; // 4 byte values, else bytes
+        std::vector<uint8_t> data;
+    };
+
+    static constexpr int KEYFRAME_INTERVAL = 32;
+
+    void setCapacity(size_t bytes) { capacity_ = bytes; }
+
+    // steps at or before the newest one are ignored
+    void push(int64_t step, const void *data, int width, int height, int channels, bool is_float);
+
+    // the frame that was current at step (the newest at or before it), false if none is kept
+    bool decode(int64_t step, Frame &out) const;
+
+    [[nodiscard]] bool empty() const { return entries_.empty(); }
+    [[nodiscard]] int64_t oldest() const { return entries_.empty() ? -1 : entries_.front().step; }
+    [[nodiscard]] int64_t newest() const { return entries_.empty() ? -1 : entries_.back().step; }
+    [[nodiscard]] size_t bytes() const { return bytes_; }
+    void clear();
+
+private:
+    struct Entry
+    {
+        int64_t step;
+        int width, height, channels;
+        bool is_float;
+        bool key;
+        std::vector<uint8_t> code;
+    };
+
+    std::deque<Entry> entries_;
+    std::vector<uint8_t> last_; // the newest frame, what the next one is coded against
+    size_t bytes_ = 0;
+    size_t capacity_ = 64u << 20;
+    int since_key_ = 0;
+
+    // decoding forward from the last decoded entry saves replaying from the keyframe
+    mutable std::vector<uint8_t> cache_;
+    mutable int64_t cache_step_ = -1;
+
+    void _evict();
+};
+
+#endif // FRAME_HISTORY_HPP
@@ -1,4 +1,8 @@
+// glad first, it replaces the GL/gl.h the header pulls in (buffer objects need the loader)
+#include <glad/glad.h>
+
 #include "gl_texture.hpp"
+#include <cstring>
 #include <iostream>
 
 namespace py = pybind11;
@@ -15,30 +19,44 @@ GLTexture::~GLTexture()
 
 void GLTexture::set(const py::array_t<float> &data, const int width, const int height, const int channels)
 {
+    set(data.data(), width, height, channels);
+}
+
+void GLTexture::set(const float *data, const int width, const int height, const int channels)
+{
+    previous_.clear();
     width_ = width;
     height_ = height;
     channels_ = channels;
+    type_ = GL_FLOAT;
 
+    // float internal formats, the values reach the shaders unclamped
+    GLint internal_format;
     switch (channels)
     {
     case 1:
         format_ = GL_RED;
+        internal_format = GL_R32F;
         break;
     case 2:
         format_ = GL_RG;
+        internal_format = GL_RG32F;
         break;
     case 3:
         format_ = GL_RGB;
+        internal_format = GL_RGB32F;
         break;
     case 4:
         format_ = GL_RGBA;
+        internal_format = GL_RGBA32F;
         break;
     default:
         throw std::runtime_error("Unsupported channel count");
     }
 
     bind();
-    glTexImage2D(GL_TEXTURE_2D, 0, format_, width_, height_, 0, format_, GL_FLOAT, data.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width_, height_, 0, format_, GL_FLOAT, data);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     unbind();
@@ -51,9 +69,11 @@ void GLTexture::set(const std::vector<unsigned char> &data, const int width, con
 
 void GLTexture::set(const unsigned char *data, const int width, const int height, const int channels)
 {
+    previous_.clear(); // not what the texture holds anymore
     width_ = width;
     height_ = height;
     channels_ = channels;
+    type_ = GL_UNSIGNED_BYTE;
 
     switch (channels)
     {
@@ -74,6 +94,7 @@ void GLTexture::set(const unsigned char *data, const int width, const int height
     }
 
     bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // rows of odd width RGB images aren't 4 byte aligned
     glTexImage2D(GL_TEXTURE_2D, 0, format_, width_, height_, 0, format_, GL_UNSIGNED_BYTE, data);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -81,15 +102,22 @@ void GLTexture::set(const unsigned char *data, const int width, const int height
 }
 
 void GLTexture::update(const py::array_t<float> &data) const
+{
+    update(data.data());
+}
+
+void GLTexture::update(const float *data) const
 {
     bind();
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, format_, GL_FLOAT, data.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, format_, GL_FLOAT, data);
     unbind();
 }
 
 void GLTexture::update(const std::vector<unsigned char> &data) const
 {
     bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, format_, GL_UNSIGNED_BYTE, data.data());
     unbind();
 }
@@ -97,10 +125,139 @@ void GLTexture::update(const std::vector<unsigned char> &data) const
 void GLTexture::update(unsigned char *data) const
 {
     bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, format_, GL_UNSIGNED_BYTE, data);
     unbind();
 }
 
+void GLTexture::setChangeTracking(bool enabled)
+{
+    track_changes_ = enabled;
+    previous_.clear();
+}
+
+unsigned char *GLTexture::_mapPbo()
+{
+    const size_t size = _bytes();
+    if (!pbos_[0])
+        glGenBuffers(2, pbos_);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos_[pbo_index_]);
+    if (pbo_size_ != size)
+    {
+        // (re)allocate both once per size, later uploads only map
+        for (const GLuint pbo : pbos_)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos_[pbo_index_]);
+        pbo_size_ = size;
+    }
+
+    // invalidating tells the driver the old contents are dead, so it doesn't sync on them
+    void *ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size),
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!ptr)
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return static_cast<unsigned char *>(ptr);
+}
+
+void GLTexture::_uploadPbo()
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos_[pbo_index_]);
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) // false = the storage got lost while mapped (mode switch ...), skip this frame
+    {
+        bind();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, format_, type_, nullptr); // from the PBO
+        unbind();
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    pbo_index_ ^= 1;
+}
+
+void GLTexture::_uploadRects(const unsigned char *data, const std::vector<TileDiff::Rect> &rects) const
+{
+    bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, width_);
+    for (const auto &r : rects)
+    {
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, r.x);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, r.y);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, r.x, r.y, r.width, r.height, format_, type_, data);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    unbind();
+}
+
+unsigned char *GLTexture::stage()
+{
+    const size_t size = _bytes();
+    if (size == 0)
+        throw std::runtime_error("GLTexture: set() the texture before staging an upload");
+
+    // tracked frames have to stay readable for the diff, they go through memory we own
+    mapped_ = !_tracking() && (staged_ = _mapPbo()) != nullptr;
+    if (!mapped_)
+    {
+        staging_.resize(size);
+        staged_ = staging_.data();
+    }
+    return staged_;
+}
+
+void GLTexture::commit()
+{
+    if (mapped_)
+    {
+        mapped_ = false;
+        _uploadPbo();
+        return;
+    }
+
+    if (!_tracking())
+    {
+        _uploadRects(staging_.data(), {{0, 0, width_, height_}});
+        return;
+    }
+
+    bool full = previous_.size() != staging_.size();
+    if (!full)
+    {
+        const size_t changed = TileDiff::dirtyTiles(previous_.data(), staging_.data(), width_, height_, channels_, dirty_);
+        if (changed == 0)
+            return; // previous_ still is the texture's content
+
+        // past half the tiles the rectangles cost more than they save
+        full = changed * 2 > dirty_.size();
+        if (!full)
+        {
+            TileDiff::coalesce(dirty_, width_, height_, rects_);
+            _uploadRects(staging_.data(), rects_);
+        }
+    }
+
+    if (full)
+    {
+        if (unsigned char *ptr = _mapPbo())
+        {
+            std::memcpy(ptr, staging_.data(), staging_.size());
+            _uploadPbo();
+        }
+        else
+        {
+            _uploadRects(staging_.data(), {{0, 0, width_, height_}});
+        }
+    }
+
+    previous_.swap(staging_); // the next stage() overwrites all of staging_
+}
+
 void GLTexture::bind(GLenum texture_unit) const
 {
     glActiveTexture(texture_unit);
@@ -114,6 +271,13 @@ void GLTexture::unbind() const
 
 void GLTexture::destroy()
 {
+    if (pbos_[0])
+    {
+        glDeleteBuffers(2, pbos_);
+        pbos_[0] = pbos_[1] = 0;
+        pbo_size_ = 0;
+    }
+
     if (texture_id_)
     {
         glDeleteTextures(1, &texture_id_);
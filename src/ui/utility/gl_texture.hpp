@@ -3,8 +3,11 @@
 
 #include <pybind11/numpy.h>
 #include <stdexcept>
+#include <vector>
 #include <GL/gl.h>
 
+#include "tile_diff.hpp"
+
 class GLTexture
 {
 public:
@@ -12,11 +15,30 @@ public:
     ~GLTexture();
 
     void set(const pybind11::array_t<float> &data, const int width, const int height, const int channels);
+    void set(const float *data, const int width, const int height, const int channels);
     void set(const std::vector<unsigned char> &data, const int width, const int height, const int channels);
     void set(const unsigned char *data, const int width, const int height, const int channels);
     void update(const pybind11::array_t<float> &data) const;
+    void update(const float *data) const;
     void update(const std::vector<unsigned char> &data) const;
     void update(unsigned char *data) const;
+
+    // Asynchronous upload through two pixel buffer objects used in turn: write
+    // width * height * channels texels (bytes, or floats after a float set()) into stage(),
+    // then commit(). The copy into the texture happens on the GPU timeline, the CPU only waits
+    // if the PBO written two uploads ago is still in flight. Falls back to a persistent
+    // staging buffer if mapping fails.
+    unsigned char *stage();
+    void commit();
+
+    // For mostly static frames: stage() hands out memory we own and commit() diffs it against
+    // the previous frame in 16x16 tiles, uploading only the changed rectangles (or the whole
+    // image through the PBOs when most of it changed). Byte textures only
+    void setChangeTracking(bool enabled);
+    // with change tracking, the frame the texture holds (width * height * channels bytes), read
+    // without touching the GPU. nullptr otherwise or before the first commit()
+    const unsigned char *pixels() const { return _tracking() && previous_.size() == _bytes() ? previous_.data() : nullptr; }
+
     void bind(GLenum texture_unit = GL_TEXTURE0) const;
     void unbind() const;
     void destroy();
@@ -24,6 +46,7 @@ public:
     GLuint id() const { return texture_id_; }
     int width() const { return width_; }
     int height() const { return height_; }
+    int channels() const { return channels_; }
 
 private:
     GLuint texture_id_;
@@ -31,6 +54,26 @@ private:
     int height_ = 0;
     int channels_ = 0;
     GLenum format_ = GL_RGB;
+    GLenum type_ = GL_UNSIGNED_BYTE;
+
+    GLuint pbos_[2] = {0, 0};
+    int pbo_index_ = 0;
+    size_t pbo_size_ = 0;
+    bool mapped_ = false;
+    unsigned char *staged_ = nullptr;
+    std::vector<unsigned char> staging_;
+
+    bool track_changes_ = false;
+    std::vector<unsigned char> previous_; // what the texture holds, when tracking
+    std::vector<uint8_t> dirty_;
+    std::vector<TileDiff::Rect> rects_;
+
+    bool _tracking() const { return track_changes_ && type_ == GL_UNSIGNED_BYTE; }
+    unsigned char *_mapPbo(); // nullptr if mapping failed
+    void _uploadPbo();
+    void _uploadRects(const unsigned char *data, const std::vector<TileDiff::Rect> &rects) const;
+
+    size_t _bytes() const { return static_cast<size_t>(width_) * height_ * channels_ * (type_ == GL_FLOAT ? sizeof(float) : 1); }
 
     static void check_array_shape(const pybind11::array_t<float> &arr, bool allow_batch);
 };
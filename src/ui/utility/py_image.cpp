@@ -0,0 +1,100 @@
+#include "py_image.hpp"
+
+#include <string>
+
+bool PyImage::ingest(const py::object &data, py::array &arr, FrameConvert::ImageView &view, std::string &error)
+{
+    arr = py::array::ensure(data);
+    if (!arr)
+    {
+        error = "Visualization is not an array";
+        return false;
+    }
+
+    const char kind = arr.dtype().kind();
+    const auto itemsize = arr.dtype().itemsize();
+    if (kind == 'u' && itemsize == 1)
+        view.dtype = FrameConvert::Dtype::U8;
+    else if (kind == 'f' && itemsize == 4)
+        view.dtype = FrameConvert::Dtype::F32;
+    else if (kind == 'f' && itemsize == 8)
+        view.dtype = FrameConvert::Dtype::F64;
+    else if (kind == 'b' || kind == 'i' || kind == 'u' || kind == 'f')
+    {
+        arr = py::array_t<float, py::array::forcecast>::ensure(arr);
+        if (!arr)
+        {
+            error = "Visualization could not be converted to float";
+            return false;
+        }
+        view.dtype = FrameConvert::Dtype::F32;
+    }
+    else
+    {
+        error = "Unsupported visualization dtype: " + std::string(py::str(arr.dtype()));
+        return false;
+    }
+
+    int ndim = static_cast<int>(arr.ndim());
+    const py::ssize_t *shape = arr.shape();
+    const py::ssize_t *strides = arr.strides();
+    for (int i = 0; i < ndim; i++)
+    {
+        if (shape[i] == 0)
+        {
+            error = "Empty visualization";
+            return false;
+        }
+    }
+
+    auto channels = [](py::ssize_t n)
+    { return n == 1 || n == 3 || n == 4; };
+    const int batch = ndim > 3 ? ndim - 3 : 0;
+    shape += batch;
+    strides += batch;
+    ndim -= batch;
+
+    view.data = arr.data();
+    if (ndim == 3 && !channels(shape[2]))
+    {
+        if (channels(shape[0])) // channel first, torch style
+        {
+            view.height = static_cast<int>(shape[1]);
+            view.width = static_cast<int>(shape[2]);
+            view.channels = static_cast<int>(shape[0]);
+            view.row_stride = strides[1];
+            view.col_stride = strides[2];
+            view.channel_stride = strides[0];
+            return true;
+        }
+        // a batch of gray images
+        shape++;
+        strides++;
+        ndim--;
+    }
+
+    if (ndim == 3)
+    {
+        view.height = static_cast<int>(shape[0]);
+        view.width = static_cast<int>(shape[1]);
+        view.channels = static_cast<int>(shape[2]);
+        view.row_stride = strides[0];
+        view.col_stride = strides[1];
+        view.channel_stride = view.channels == 1 ? static_cast<ptrdiff_t>(view.itemSize()) : strides[2];
+    }
+    else if (ndim == 2)
+    {
+        view.height = static_cast<int>(shape[0]);
+        view.width = static_cast<int>(shape[1]);
+        view.channels = 1;
+        view.row_stride = strides[0];
+        view.col_stride = strides[1];
+        view.channel_stride = static_cast<ptrdiff_t>(view.itemSize());
+    }
+    else
+    {
+        error = "Unsupported visualization shape: " + std::to_string(arr.ndim()) + "D";
+        return false;
+    }
+    return true;
+}
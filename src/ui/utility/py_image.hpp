@@ -0,0 +1,21 @@
+#ifndef PY_IMAGE_HPP
+#define PY_IMAGE_HPP
+
+#include <string>
+#include <pybind11/numpy.h>
+
+#include "frame_convert.hpp"
+
+namespace py = pybind11;
+
+// Images handed over from python, shared by everything that draws or records them.
+namespace PyImage
+{
+    // wraps the array python handed out without copying it: uint8, float32 and float64 are read
+    // in place at whatever strides they come with, other numbers go through one float32 copy.
+    // (H, W), (H, W, C) and (C, H, W) with C in 1 / 3 / 4, leading batch axes show their first item.
+    // arr keeps the data alive as long as view is used
+    bool ingest(const py::object &data, py::array &arr, FrameConvert::ImageView &view, std::string &error);
+}
+
+#endif // PY_IMAGE_HPP
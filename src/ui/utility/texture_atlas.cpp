@@ -0,0 +1,96 @@
+#include <glad/glad.h>
+
+#include "texture_atlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "frame_convert.hpp"
+
+TextureAtlas::~TextureAtlas()
+{
+    destroy();
+}
+
+bool TextureAtlas::layout(int count, int cell_size)
+{
+    if (count == static_cast<int>(cells_.size()) && cell_size == cell_size_)
+        return false;
+
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    max_size = std::max<GLint>(max_size, 1024); // 1024 is the least GL 3.0 guarantees
+
+    // as wide as needed, then more rows. Cells past the texture size limit stay empty
+    cell_size_ = std::clamp(cell_size, 1, static_cast<int>(max_size));
+    columns_ = std::clamp(count, 1, static_cast<int>(max_size) / cell_size_);
+    rows_ = std::min((count + columns_ - 1) / columns_, static_cast<int>(max_size) / cell_size_);
+    cells_.assign(count, Cell{});
+    clear();
+    return true;
+}
+
+void TextureAtlas::clear()
+{
+    for (auto &c : cells_)
+        c = Cell{};
+    pixels_.assign(static_cast<size_t>(_width()) * _height() * 3, 0);
+    dirty_ = true;
+}
+
+void TextureAtlas::put(int index, const uint8_t *rgb, int width, int height)
+{
+    if (index < 0 || index >= columns_ * rows_ || index >= static_cast<int>(cells_.size()) || width <= 0 || height <= 0)
+        return;
+
+    // smallest whole factor that fits the cell, past 256 (frames of 32k texels) it stays empty
+    const int factor = std::max((width + cell_size_ - 1) / cell_size_, (height + cell_size_ - 1) / cell_size_);
+    if (factor > 256)
+        return;
+
+    cells_[index] = {width / factor, height / factor};
+    const ptrdiff_t stride = static_cast<ptrdiff_t>(_width()) * 3;
+    uint8_t *origin = pixels_.data() + (index / columns_) * cell_size_ * stride + (index % columns_) * cell_size_ * 3;
+    FrameConvert::boxDownsample(rgb, width, height, 3, factor, origin, stride);
+    dirty_ = true;
+}
+
+void TextureAtlas::upload()
+{
+    if (!dirty_ || pixels_.empty())
+        return;
+    dirty_ = false;
+
+    if (!texture_)
+    {
+        texture_ = new GLTexture();
+        texture_->setChangeTracking(true); // a step usually changes a few cells, or parts of them
+    }
+    if (texture_->width() != _width() || texture_->height() != _height())
+        texture_->set(static_cast<const unsigned char *>(nullptr), _width(), _height(), 3);
+
+    std::memcpy(texture_->stage(), pixels_.data(), pixels_.size());
+    texture_->commit();
+}
+
+bool TextureAtlas::cell(int index, ImVec2 &uv0, ImVec2 &uv1, ImVec2 &size) const
+{
+    if (!texture_ || index < 0 || index >= static_cast<int>(cells_.size()) || cells_[index].width == 0)
+        return false;
+
+    const float x = static_cast<float>((index % columns_) * cell_size_);
+    const float y = static_cast<float>((index / columns_) * cell_size_);
+    size = ImVec2(cells_[index].width, cells_[index].height);
+    uv0 = ImVec2(x / _width(), y / _height());
+    uv1 = ImVec2((x + size.x) / _width(), (y + size.y) / _height());
+    return true;
+}
+
+void TextureAtlas::destroy()
+{
+    delete texture_;
+    texture_ = nullptr;
+    pixels_.clear();
+    cells_.clear();
+    cell_size_ = columns_ = rows_ = 0;
+}
@@ -0,0 +1,52 @@
+#ifndef TEXTURE_ATLAS_HPP
+#define TEXTURE_ATLAS_HPP
+
+#include <cstdint>
+#include <vector>
+#include <imgui.h>
+
+#include "gl_texture.hpp"
+
+// Many small RGB images in one texture, so a whole population draws with a single bind.
+// Cells are square, each image is box-filtered down to fit its cell. The CPU copy is diffed
+// on upload, only the regions that changed since the last one reach the GPU.
+class TextureAtlas
+{
+public:
+    ~TextureAtlas();
+
+    // count cells of cell_size texels. Returns true (and forgets every image) if that changed
+    bool layout(int count, int cell_size);
+    void clear();
+
+    // packed RGB frame into cell index, shrunk by the smallest whole factor that fits
+    void put(int index, const uint8_t *rgb, int width, int height);
+
+    // the puts since the last upload, call once per frame before drawing
+    void upload();
+
+    // where the image of a cell sits in the texture and its size in texels, false if it has none
+    bool cell(int index, ImVec2 &uv0, ImVec2 &uv1, ImVec2 &size) const;
+
+    [[nodiscard]] GLuint id() const { return texture_ ? texture_->id() : 0; }
+    void destroy();
+
+private:
+    struct Cell
+    {
+        int width = 0, height = 0; // of the image in it
+    };
+
+    GLTexture *texture_ = nullptr; // created on the first upload, there's a GL context by then
+    std::vector<uint8_t> pixels_;
+    std::vector<Cell> cells_;
+    int cell_size_ = 0;
+    int columns_ = 0;
+    int rows_ = 0;
+    bool dirty_ = false;
+
+    [[nodiscard]] int _width() const { return columns_ * cell_size_; }
+    [[nodiscard]] int _height() const { return rows_ * cell_size_; }
+};
+
+#endif // TEXTURE_ATLAS_HPP
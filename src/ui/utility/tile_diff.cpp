@@ -0,0 +1,128 @@
+#include "tile_diff.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TILE_DIFF_AVX2 1
+#endif
+
+size_t TileDiff::dirtyTiles(const uint8_t *a, const uint8_t *b, int width, int height, int channels, std::vector<uint8_t> &dirty)
+{
+    const int tiles_x = tilesAlong(width);
+    const int tiles_y = tilesAlong(height);
+    dirty.assign(static_cast<size_t>(tiles_x) * tiles_y, 0);
+
+    const size_t stride = static_cast<size_t>(width) * channels;
+    const size_t tile_bytes = static_cast<size_t>(TILE) * channels;
+    size_t count = 0;
+
+    for (int ty = 0; ty < tiles_y; ty++)
+    {
+        uint8_t *row_dirty = dirty.data() + static_cast<size_t>(ty) * tiles_x;
+        int clean = tiles_x; // tiles of this row not known dirty yet
+        auto mark = [&](size_t byte) -> size_t // returns the end of the tile, in bytes
+        {
+            const size_t tx = byte / tile_bytes;
+            if (!row_dirty[tx])
+            {
+                row_dirty[tx] = 1;
+                clean--;
+            }
+            return (tx + 1) * tile_bytes;
+        };
+
+        const int y_end = std::min(height, (ty + 1) * TILE);
+        for (int y = ty * TILE; y < y_end && clean > 0; y++)
+        {
+            const uint8_t *ra = a + y * stride;
+            const uint8_t *rb = b + y * stride;
+#ifdef TILE_DIFF_AVX2
+            // whole rows 32 bytes at a time, the mismatch mask says which tiles are hit
+            size_t i = 0;
+            for (; i + 32 <= stride; i += 32)
+            {
+                const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ra + i));
+                const __m256i z = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rb + i));
+                uint32_t diff = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, z)));
+                while (diff)
+                {
+                    const size_t end = mark(i + __builtin_ctz(diff));
+                    if (end >= i + 32)
+                        break;
+                    diff &= ~0u << (end - i); // rest of that tile is covered
+                }
+            }
+            for (; i < stride; i++)
+            {
+                if (ra[i] != rb[i])
+                    i = mark(i) - 1;
+            }
+#else
+            for (int tx = 0; tx < tiles_x; tx++)
+            {
+                const size_t x0 = tx * tile_bytes;
+                if (!row_dirty[tx] && std::memcmp(ra + x0, rb + x0, std::min(stride, x0 + tile_bytes) - x0) != 0)
+                    mark(x0);
+            }
+#endif
+        }
+        count += tiles_x - clean;
+    }
+    return count;
+}
+
+void TileDiff::coalesce(const std::vector<uint8_t> &dirty, int width, int height, std::vector<Rect> &rects)
+{
+    const int tiles_x = tilesAlong(width);
+    const int tiles_y = tilesAlong(height);
+    rects.clear();
+
+    // still growing downwards, in tiles: x = first tile, width = tile count, y / height in tile rows
+    std::vector<Rect> open, next;
+    auto close = [&](const Rect &r)
+    {
+        const int x = r.x * TILE, y = r.y * TILE;
+        rects.push_back({x, y, std::min(width, (r.x + r.width) * TILE) - x, std::min(height, (r.y + r.height) * TILE) - y});
+    };
+
+    for (int ty = 0; ty < tiles_y; ty++)
+    {
+        next.clear();
+        const uint8_t *row = dirty.data() + static_cast<size_t>(ty) * tiles_x;
+        for (int tx = 0; tx < tiles_x;)
+        {
+            if (!row[tx])
+            {
+                tx++;
+                continue;
+            }
+
+            int end = tx;
+            while (end < tiles_x && row[end])
+                end++;
+
+            // same run in the row above -> one taller rectangle
+            auto it = std::find_if(open.begin(), open.end(), [&](const Rect &r)
+                                   { return r.x == tx && r.width == end - tx; });
+            if (it != open.end())
+            {
+                next.push_back({it->x, it->y, it->width, it->height + 1});
+                open.erase(it);
+            }
+            else
+            {
+                next.push_back({tx, ty, end - tx, 1});
+            }
+            tx = end;
+        }
+
+        for (const auto &r : open) // not continued in this row
+            close(r);
+        open.swap(next);
+    }
+
+    for (const auto &r : open)
+        close(r);
+}
@@ -0,0 +1,30 @@
+#ifndef TILE_DIFF_HPP
+#define TILE_DIFF_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Finds what changed between two frames of the same size in 16x16 tiles, so a texture
+// update only has to send those regions.
+namespace TileDiff
+{
+    constexpr int TILE = 16;
+
+    struct Rect
+    {
+        int x, y, width, height; // pixels
+    };
+
+    inline int tilesAlong(int pixels) { return (pixels + TILE - 1) / TILE; }
+
+    // dirty[ty * tiles_x + tx] = 1 where any byte of the tile differs between a and b
+    // (width * height * channels bytes each, rows packed). Returns the number of dirty tiles
+    size_t dirtyTiles(const uint8_t *a, const uint8_t *b, int width, int height, int channels, std::vector<uint8_t> &dirty);
+
+    // dirty tiles merged into few rectangles: runs along a tile row, then equal runs of
+    // consecutive rows stacked. Clipped to the frame
+    void coalesce(const std::vector<uint8_t> &dirty, int width, int height, std::vector<Rect> &rects);
+}
+
+#endif // TILE_DIFF_HPP